@@ -78,6 +78,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/blackoil/blackoillocalresidualtpfa.hh
              opm/models/blackoil/blackoilnewtonmethod.hh
              opm/models/blackoil/blackoilnewtonmethodparameters.hh
+             opm/models/blackoil/blackoilsequentialsolver.hh
              opm/models/blackoil/blackoilonephaseindices.hh
              opm/models/blackoil/blackoilsolventmodules.hh
              opm/models/blackoil/blackoilsolventparams.hh
@@ -86,6 +87,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/blackoil/blackoilproperties.hh
              opm/models/blackoil/blackoilprimaryvariables.hh
              opm/models/blackoil/blackoilproblem.hh
+             opm/models/blackoil/blackoilpvtcache.hh
              opm/models/blackoil/blackoilenergymodules.hh
              opm/models/blackoil/blackoiltwophaseindices.hh
              opm/models/blackoil/blackoilmicpmodules.hh
@@ -172,7 +174,9 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/io/vtkscalarfunction.hh
              opm/models/io/vtkenergymodule.hh
              opm/models/io/restart.hh
+             opm/models/io/binarygridfile.hh
              opm/models/io/cubegridvanguard.hh
+             opm/models/io/distributedcubegridfactory.hh
              opm/models/io/baseoutputwriter.hh
              opm/models/io/vtkmultiwriter.hh
              opm/models/io/vtkmultiphasemodule.hh
@@ -208,10 +212,13 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/models/nonlinear/newtonmethod.hh
              opm/models/nonlinear/newtonmethodparameters.hh
              opm/models/nonlinear/newtonmethodproperties.hh
+             opm/models/parallel/batchedreduction.hh
+             opm/models/parallel/firsttouchallocator.hh
              opm/models/parallel/mpiutil.hh
              opm/models/parallel/tasklets.hh
              opm/models/parallel/threadmanager.hh
              opm/models/parallel/gridcommhandles.hh
+             opm/models/parallel/gridhaloexchange.hh
              opm/models/parallel/mpibuffer.hh
              opm/models/parallel/threadedentityiterator.hh
              opm/models/ptflash/flashintensivequantities.hh
@@ -265,6 +272,7 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/simulators/linalg/istlsparsematrixadapter.hh
              opm/simulators/linalg/istlpreconditionerwrappers.hh
              opm/simulators/linalg/residreductioncriterion.hh
+             opm/simulators/linalg/reorderedblocksolver.hh
              opm/simulators/linalg/overlappingbcrsmatrix.hh
              opm/simulators/linalg/blacklist.hh
              opm/simulators/linalg/parallelbasebackend.hh
@@ -279,11 +287,14 @@ list (APPEND PUBLIC_HEADER_FILES
              opm/simulators/linalg/superlubackend.hh
              opm/simulators/linalg/matrixblock.hh
              opm/simulators/linalg/istlsolverwrappers.hh
+             opm/simulators/linalg/recycledgmressolver.hh
              opm/simulators/linalg/overlaptypes.hh
              opm/simulators/linalg/overlappingpreconditioner.hh
              opm/simulators/linalg/domesticoverlapfrombcrsmatrix.hh
              opm/simulators/linalg/fixpointcriterion.hh
              opm/simulators/linalg/parallelamgbackend.hh
+             opm/simulators/linalg/parallelgmgbackend.hh
+             opm/simulators/linalg/geometricmultigrid.hh
              opm/simulators/linalg/foreignoverlapfrombcrsmatrix.hh
              opm/simulators/linalg/overlappingscalarproduct.hh
              opm/simulators/linalg/convergencecriterion.hh)
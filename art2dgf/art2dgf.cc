@@ -25,13 +25,17 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/fmatrix.hh>
 
+#include <opm/models/io/binarygridfile.hh>
+
 #include <algorithm>
 #include <fstream>
 #include <iomanip>
 #include <memory>
+#include <set>
 #include <stdexcept>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace Ewoms {
@@ -45,10 +49,14 @@ namespace Ewoms {
  {
     /*!
      * \brief Create the Grid
+     *
+     * If binaryData is specified, the grid is additionally stored in the format of
+     * Opm::BinaryGridFile.
      */
     static void convert( const std::string& artFileName,
                          std::ostream& dgfFile,
-                         const unsigned precision = 16 )
+                         const unsigned precision = 16,
+                         Opm::BinaryGridFile::Data* binaryData = nullptr )
     {
         using Scalar = double;
         using GlobalPosition = Dune::FieldVector< Scalar, 2 >;
@@ -208,6 +216,25 @@ namespace Ewoms {
                 if (mat.determinant() < 0)
                     std::swap(vertIndices[2], vertIndices[1]);
 
+                // the binary grid file bypasses the DGF parser, so the simplex
+                // fix-up of the parser must be done here: besides the orientation,
+                // the vertices are rotated such that the longest edge, which is
+                // used as the refinement edge, is opposite to the first vertex.
+                // Rotating the vertices preserves the orientation.
+                unsigned longestEdgeIdx = 0;
+                Scalar longestEdgeLength = 0.0;
+                for (unsigned i = 0; i < 3; ++i) {
+                    auto edgeVec = vertexPos[vertIndices[(i + 2) % 3]].first;
+                    edgeVec -= vertexPos[vertIndices[(i + 1) % 3]].first;
+                    if (edgeVec.two_norm() > longestEdgeLength) {
+                        longestEdgeLength = edgeVec.two_norm();
+                        longestEdgeIdx = i;
+                    }
+                }
+                std::rotate(vertIndices.begin(),
+                            vertIndices.begin() + longestEdgeIdx,
+                            vertIndices.end());
+
                 elements.push_back( vertIndices );
             }
             else if (curParseMode == Finished) {
@@ -258,6 +285,39 @@ namespace Ewoms {
         dgfFile << "default 1" << std::endl;
         dgfFile << "#" << std::endl << std::endl;
         dgfFile << "#" << std::endl;
+
+        if (binaryData) {
+            binaryData->dim = 2;
+            binaryData->dimWorld = 2;
+            for (const auto& vertex : vertexPos) {
+                binaryData->vertexCoords.push_back(vertex.first[0]);
+                binaryData->vertexCoords.push_back(vertex.first[1]);
+            }
+            for (const auto& element : elements) {
+                binaryData->elementCorners.insert(binaryData->elementCorners.end(),
+                                                  element.begin(), element.end());
+                binaryData->elementOffsets.push_back(binaryData->elementCorners.size());
+            }
+
+            // the DGF file only flags the vertices on fractures and DgfVanguard
+            // marks every element edge whose vertices are both flagged, which may
+            // include edges which are not fractures in the ART file. The binary
+            // file must yield the same fractures, so the same rule is used here.
+            std::set<std::pair<unsigned, unsigned> > flaggedEdges;
+            for (const auto& element : elements) {
+                for (std::size_t i = 0; i < element.size(); ++i) {
+                    for (std::size_t j = i + 1; j < element.size(); ++j) {
+                        if (vertexPos[ element[ i ] ].second > 0 && vertexPos[ element[ j ] ].second > 0)
+                            flaggedEdges.emplace(std::min(element[ i ], element[ j ]),
+                                                 std::max(element[ i ], element[ j ]));
+                    }
+                }
+            }
+            for (const auto& edge : flaggedEdges) {
+                binaryData->fractureEdges.push_back(edge.first);
+                binaryData->fractureEdges.push_back(edge.second);
+            }
+        }
     }
  };
 
@@ -270,7 +330,9 @@ int main( int argc, char** argv )
                   << "\n"
                   << "Usage: " << argv[0] << " ART_FILENAME\n"
                   << "\n"
-                  << "The result will be written to the file $ART_FILENAME.dgf\n";
+                  << "The result will be written to the file $ART_FILENAME.dgf. Additionally,\n"
+                  << "the grid is written to the binary grid file $ART_FILENAME.dgf.bin\n"
+                  << "which is used instead of the DGF file if the grid cache is enabled.\n";
         return 1;
     }
 
@@ -279,8 +341,20 @@ int main( int argc, char** argv )
     dgfname += ".dgf";
 
     std::cout << "Converting ART file \"" << filename << "\" to DGF file \"" << dgfname << "\"\n";
-    std::ofstream dgfFile( dgfname );
-    Ewoms::Art2DGF::convert( filename, dgfFile );
+    std::ostringstream dgfStream;
+    Opm::BinaryGridFile::Data binaryData;
+    Ewoms::Art2DGF::convert( filename, dgfStream, /*precision=*/16, &binaryData );
+
+    const std::string dgfContent = dgfStream.str();
+    std::ofstream dgfFile( dgfname, std::ios::binary );
+    dgfFile << dgfContent;
+    dgfFile.close();
+
+    // the binary grid file is tagged with the hash of the DGF file, so that it is
+    // considered to be stale as soon as the DGF file is modified
+    Opm::BinaryGridFile::write( dgfname + ".bin",
+                                Opm::BinaryGridFile::hash( dgfContent.data(), dgfContent.size() ),
+                                binaryData );
 
     return 0;
 }
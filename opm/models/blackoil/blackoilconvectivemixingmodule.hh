@@ -79,6 +79,16 @@ public:
     struct ConvectiveMixingModuleParam
     {};
 
+    struct FaceCoefficients
+    {};
+
+    static FaceCoefficients faceCoefficients(const Scalar,
+                                             const Scalar,
+                                             const Scalar,
+                                             const unsigned,
+                                             const unsigned)
+    { return {}; }
+
     #if HAVE_ECL_INPUT
     static void beginEpisode(const EclipseState&,
                              const Schedule&,
@@ -120,6 +130,15 @@ public:
                                         const Scalar,
                                         const ConvectiveMixingModuleParam&)
     {}
+
+    static void addConvectiveMixingFlux(RateVector&,
+                                        const IntensiveQuantities&,
+                                        const IntensiveQuantities&,
+                                        const unsigned,
+                                        const unsigned,
+                                        const FaceCoefficients&,
+                                        const ConvectiveMixingModuleParam&)
+    {}
 };
 
 template <class TypeTag>
@@ -150,6 +169,46 @@ public:
         std::vector<Scalar> Psi_;
     };
 
+    /*!
+     * \brief The quantities of the convective mixing flux over a face which do not
+     *        depend on the solution.
+     */
+    struct FaceCoefficients
+    {
+        Scalar distZg{0.0};
+        Scalar transPerArea{0.0};
+        Scalar refDensityLiquidIn{0.0};
+        Scalar refDensityLiquidEx{0.0};
+        Scalar refDensityGasIn{0.0};
+        Scalar refDensityGasEx{0.0};
+    };
+
+    /*!
+     * \brief Compute the solution independent quantities of the convective mixing flux
+     *        over a face.
+     */
+    static FaceCoefficients faceCoefficients(const Scalar distZg,
+                                             const Scalar trans,
+                                             const Scalar faceArea,
+                                             const unsigned pvtRegionIdxIn,
+                                             const unsigned pvtRegionIdxEx)
+    {
+        FaceCoefficients coeffs;
+        coeffs.distZg = distZg;
+        coeffs.transPerArea = trans / faceArea;
+        if (FluidSystem::phaseIsActive(FluidSystem::waterPhaseIdx)) {
+            coeffs.refDensityLiquidIn = FluidSystem::waterPvt().waterReferenceDensity(pvtRegionIdxIn);
+            coeffs.refDensityLiquidEx = FluidSystem::waterPvt().waterReferenceDensity(pvtRegionIdxEx);
+        }
+        else {
+            coeffs.refDensityLiquidIn = FluidSystem::oilPvt().oilReferenceDensity(pvtRegionIdxIn);
+            coeffs.refDensityLiquidEx = FluidSystem::oilPvt().oilReferenceDensity(pvtRegionIdxEx);
+        }
+        coeffs.refDensityGasIn = FluidSystem::referenceDensity(FluidSystem::gasPhaseIdx, pvtRegionIdxIn);
+        coeffs.refDensityGasEx = FluidSystem::referenceDensity(FluidSystem::gasPhaseIdx, pvtRegionIdxEx);
+        return coeffs;
+    }
+
     #if HAVE_ECL_INPUT
     static void beginEpisode(const EclipseState& eclState,
                              const Schedule& schedule,
@@ -282,6 +341,34 @@ public:
             return;
         }
 
+        addConvectiveMixingFlux(flux,
+                                intQuantsIn,
+                                intQuantsEx,
+                                globalIndexIn,
+                                globalIndexEx,
+                                faceCoefficients(distZg, trans, faceArea,
+                                                 intQuantsIn.pvtRegionIndex(),
+                                                 intQuantsEx.pvtRegionIndex()),
+                                info);
+    }
+
+    /*!
+     * \brief Adds the convective mixing mass flux flux to the flux vector over a flux
+     *        integration point using face coefficients which have been computed in
+     *        advance by faceCoefficients().
+     */
+    static void addConvectiveMixingFlux(RateVector& flux,
+                                        const IntensiveQuantities& intQuantsIn,
+                                        const IntensiveQuantities& intQuantsEx,
+                                        const unsigned globalIndexIn,
+                                        const unsigned globalIndexEx,
+                                        const FaceCoefficients& coeffs,
+                                        const ConvectiveMixingModuleParam& info)
+    {
+        if (info.active_.empty()) {
+            return;
+        }
+
         if (!info.active_[ intQuantsIn.pvtRegionIndex()] || !info.active_[ intQuantsEx.pvtRegionIndex()]) {
             return;
         }
@@ -304,13 +391,9 @@ public:
             FluidSystem::waterPvt().inverseFormationVolumeFactor(intQuantsIn.pvtRegionIndex(), t_in, p_in, rssat_in, salt_in):
             FluidSystem::oilPvt().inverseFormationVolumeFactor(intQuantsIn.pvtRegionIndex(), t_in, p_in, rssat_in);
 
-        const auto& densityLiquidIn = (FluidSystem::phaseIsActive(FluidSystem::waterPhaseIdx)) ?
-            FluidSystem::waterPvt().waterReferenceDensity(intQuantsIn.pvtRegionIndex()) :
-            FluidSystem::oilPvt().oilReferenceDensity(intQuantsIn.pvtRegionIndex());
-
-        const auto rho_in = Opm::getValue(intQuantsIn.fluidState().invB(liquidPhaseIdx)) * densityLiquidIn;
+        const auto rho_in = Opm::getValue(intQuantsIn.fluidState().invB(liquidPhaseIdx)) * coeffs.refDensityLiquidIn;
         const auto rho_sat_in = bLiquidSatIn
-            * (densityLiquidIn + rssat_in * FluidSystem::referenceDensity(FluidSystem::gasPhaseIdx, intQuantsIn.pvtRegionIndex()));
+            * (coeffs.refDensityLiquidIn + rssat_in * coeffs.refDensityGasIn);
 
         //exteriour
         const auto t_ex = Opm::getValue(intQuantsEx.fluidState().temperature(liquidPhaseIdx));
@@ -324,17 +407,12 @@ public:
             FluidSystem::waterPvt().inverseFormationVolumeFactor(intQuantsEx.pvtRegionIndex(), t_ex, p_ex, rssat_ex, salt_ex):
             FluidSystem::oilPvt().inverseFormationVolumeFactor(intQuantsEx.pvtRegionIndex(), t_ex, p_ex, rssat_ex);
 
-
-        const auto& densityLiquidEx = (FluidSystem::phaseIsActive(FluidSystem::waterPhaseIdx)) ?
-            FluidSystem::waterPvt().waterReferenceDensity(intQuantsEx.pvtRegionIndex()) :
-            FluidSystem::oilPvt().oilReferenceDensity(intQuantsEx.pvtRegionIndex());
-
-        const auto rho_ex = Opm::getValue(intQuantsEx.fluidState().invB(liquidPhaseIdx)) * densityLiquidEx;
+        const auto rho_ex = Opm::getValue(intQuantsEx.fluidState().invB(liquidPhaseIdx)) * coeffs.refDensityLiquidEx;
         const auto rho_sat_ex = bLiquidSatEx
-            * (densityLiquidEx + rssat_ex * FluidSystem::referenceDensity(FluidSystem::gasPhaseIdx, intQuantsEx.pvtRegionIndex()));
+            * (coeffs.refDensityLiquidEx + rssat_ex * coeffs.refDensityGasEx);
         //rho difference approximation
         const auto delta_rho = (rho_sat_ex + rho_sat_in - rho_in - rho_ex)/2;
-        const auto pressure_difference_convective_mixing =  delta_rho * distZg;
+        const auto pressure_difference_convective_mixing =  delta_rho * coeffs.distZg;
 
         //if change in pressure
         if (Opm::abs(pressure_difference_convective_mixing) > 1e-12){
@@ -362,7 +440,7 @@ public:
             // We restrict the convective mixing mass flux to rssat * Psi.
             const Evaluation RsupRestricted = Opm::min(Rsup, rssat_up*info.Psi_[up.pvtRegionIndex()]);
 
-            const auto convectiveFlux = -trans*transMult*info.Xhi_[up.pvtRegionIndex()]*invB*pressure_difference_convective_mixing*RsupRestricted/(visc*faceArea);
+            const auto convectiveFlux = -coeffs.transPerArea*transMult*info.Xhi_[up.pvtRegionIndex()]*invB*pressure_difference_convective_mixing*RsupRestricted/visc;
             unsigned activeGasCompIdx = Indices::canonicalToActiveComponentIndex(FluidSystem::gasCompIdx);
             if (globalUpIndex == globalIndexIn)
                 flux[conti0EqIdx + activeGasCompIdx] += convectiveFlux;
@@ -370,7 +448,8 @@ public:
                 flux[conti0EqIdx + activeGasCompIdx] += Opm::getValue(convectiveFlux);            
 
             if constexpr (enableEnergy) {
-                const auto& h = up.fluidState().enthalpy(liquidPhaseIdx) * FluidSystem::referenceDensity(FluidSystem::gasPhaseIdx, up.pvtRegionIndex());
+                const Scalar refDensityGasUp = (upIdx == interiorDofIdx) ? coeffs.refDensityGasIn : coeffs.refDensityGasEx;
+                const auto& h = up.fluidState().enthalpy(liquidPhaseIdx) * refDensityGasUp;
                 if (globalUpIndex == globalIndexIn) {
                     flux[contiEnergyEqIdx] += convectiveFlux * h;
                 }
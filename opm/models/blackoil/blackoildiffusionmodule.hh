@@ -61,6 +61,8 @@ class BlackOilDiffusionModule<TypeTag, /*enableDiffusion=*/false>
     using RateVector = GetPropType<TypeTag, Properties::RateVector>;
 
 public:
+    struct FaceCoefficients
+    {};
 
     #if HAVE_ECL_INPUT
     /*!
@@ -71,6 +73,9 @@ public:
     }
     #endif
 
+    static FaceCoefficients faceCoefficients(Scalar, Scalar, unsigned)
+    { return {}; }
+
     /*!
      * \brief Register all run-time parameters for the diffusion module.
      */
@@ -109,8 +114,20 @@ class BlackOilDiffusionModule<TypeTag, /*enableDiffusion=*/true>
 
 public:
     using ExtensiveQuantities = BlackOilDiffusionExtensiveQuantities<TypeTag,true>;
-    
-    
+
+    /*!
+     * \brief The quantities of the diffusive flux over a face which do not depend on
+     *        the solution.
+     *
+     * The conversion factors are the ones of the PVT region of the interior cell.
+     */
+    struct FaceCoefficients
+    {
+        Scalar diffusivity{0.0}; // diffusivity per face area
+        Scalar toFractionGasOil{0.0};
+        Scalar toFractionGasWater{0.0};
+    };
+
     #if HAVE_ECL_INPUT
     /*!
      * \brief Initialize all internal data structures needed by the diffusion module
@@ -127,6 +144,26 @@ public:
     static void registerParameters()
     {}
 
+    /*!
+     * \brief Compute the solution independent quantities of the diffusive flux over
+     *        a face.
+     */
+    static FaceCoefficients faceCoefficients(Scalar diffusivity,
+                                             Scalar faceArea,
+                                             unsigned pvtRegionIdx)
+    {
+        FaceCoefficients coeffs;
+        // opm-models expects per area flux
+        coeffs.diffusivity = diffusivity / faceArea;
+        if (FluidSystem::phaseIsActive(FluidSystem::gasPhaseIdx)) {
+            if (FluidSystem::phaseIsActive(FluidSystem::oilPhaseIdx))
+                coeffs.toFractionGasOil = toFractionGasOil(pvtRegionIdx);
+            if (FluidSystem::phaseIsActive(FluidSystem::waterPhaseIdx))
+                coeffs.toFractionGasWater = toFractionGasWater(pvtRegionIdx);
+        }
+        return coeffs;
+    }
+
     /*!
      * \brief Adds the mass flux due to molecular diffusion to the flux vector over the
      *        integration point. Following the notation in blackoilmodel.hh,
@@ -171,7 +208,43 @@ public:
                                  const Evaluation& diffusivity,
                                  const EvaluationArray& effectiveDiffusionCoefficient)
     {
-        unsigned pvtRegionIndex = fluidStateI.pvtRegionIndex();
+        const auto coeffs = faceCoefficients(/*diffusivity=*/0.0, /*faceArea=*/1.0,
+                                             fluidStateI.pvtRegionIndex());
+        addDiffusiveFlux_(flux, fluidStateI, fluidStateJ,
+                          diffusivity,
+                          coeffs.toFractionGasOil,
+                          coeffs.toFractionGasWater,
+                          effectiveDiffusionCoefficient);
+    }
+
+    /*!
+     * \brief Adds the mass flux due to molecular diffusion using face coefficients
+     *        which have been computed in advance by faceCoefficients().
+     */
+    template<class FluidState,class EvaluationArray>
+    static void addDiffusiveFlux(RateVector& flux,
+                                 const FluidState& fluidStateI,
+                                 const FluidState& fluidStateJ,
+                                 const FaceCoefficients& coeffs,
+                                 const EvaluationArray& effectiveDiffusionCoefficient)
+    {
+        addDiffusiveFlux_(flux, fluidStateI, fluidStateJ,
+                          coeffs.diffusivity,
+                          coeffs.toFractionGasOil,
+                          coeffs.toFractionGasWater,
+                          effectiveDiffusionCoefficient);
+    }
+
+private:
+    template<class FluidState, class DiffusivityEval, class EvaluationArray>
+    static void addDiffusiveFlux_(RateVector& flux,
+                                  const FluidState& fluidStateI,
+                                  const FluidState& fluidStateJ,
+                                  const DiffusivityEval& diffusivity,
+                                  const Scalar fractionGasOil,
+                                  const Scalar fractionGasWater,
+                                  const EvaluationArray& effectiveDiffusionCoefficient)
+    {
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
             if (!FluidSystem::phaseIsActive(phaseIdx)) {
                 continue;
@@ -199,22 +272,22 @@ public:
             Evaluation diffR = 0.0;
             if (FluidSystem::enableDissolvedGas() && FluidSystem::phaseIsActive(FluidSystem::gasPhaseIdx) && phaseIdx == FluidSystem::oilPhaseIdx) {
                 Evaluation rsAvg = (fluidStateI.Rs() + Toolbox::value(fluidStateJ.Rs())) / 2;
-                convFactor = 1.0 / (toFractionGasOil(pvtRegionIndex) + rsAvg);
+                convFactor = 1.0 / (fractionGasOil + rsAvg);
                 diffR = fluidStateI.Rs() - Toolbox::value(fluidStateJ.Rs());
             }
             if (FluidSystem::enableVaporizedOil() && FluidSystem::phaseIsActive(FluidSystem::oilPhaseIdx) && phaseIdx == FluidSystem::gasPhaseIdx) {
                 Evaluation rvAvg = (fluidStateI.Rv() + Toolbox::value(fluidStateJ.Rv())) / 2;
-                convFactor = toFractionGasOil(pvtRegionIndex) / (1.0 + rvAvg*toFractionGasOil(pvtRegionIndex));
+                convFactor = fractionGasOil / (1.0 + rvAvg*fractionGasOil);
                 diffR = fluidStateI.Rv() - Toolbox::value(fluidStateJ.Rv());
             }
             if (FluidSystem::enableDissolvedGasInWater() && phaseIdx == FluidSystem::waterPhaseIdx) {
                 Evaluation rsAvg = (fluidStateI.Rsw() + Toolbox::value(fluidStateJ.Rsw())) / 2;
-                convFactor = 1.0 / (toFractionGasWater(pvtRegionIndex) + rsAvg);
+                convFactor = 1.0 / (fractionGasWater + rsAvg);
                 diffR = fluidStateI.Rsw() - Toolbox::value(fluidStateJ.Rsw());
             }
             if (FluidSystem::enableVaporizedWater() && phaseIdx == FluidSystem::gasPhaseIdx) {
                 Evaluation rvAvg = (fluidStateI.Rvw() + Toolbox::value(fluidStateJ.Rvw())) / 2;
-                convFactor = toFractionGasWater(pvtRegionIndex)/ (1.0 + rvAvg*toFractionGasWater(pvtRegionIndex));
+                convFactor = fractionGasWater / (1.0 + rvAvg*fractionGasWater);
                 diffR = fluidStateI.Rvw() - Toolbox::value(fluidStateJ.Rvw());
             }
 
@@ -240,7 +313,6 @@ public:
         }
     }
 
-private:
     static Scalar toFractionGasOil (unsigned regionIdx) {
         Scalar mMOil = use_mole_fraction_? FluidSystem::molarMass(FluidSystem::oilCompIdx, regionIdx) : 1;
         Scalar rhoO = FluidSystem::referenceDensity(FluidSystem::oilPhaseIdx, regionIdx);
@@ -66,12 +66,18 @@ class BlackOilDispersionModule<TypeTag, /*enableDispersion=*/false>
 public:
     using ExtensiveQuantities = BlackOilDispersionExtensiveQuantities<TypeTag,false>;
 
+    struct FaceCoefficients
+    {};
+
 #if HAVE_ECL_INPUT
     static void initFromState(const EclipseState&)
     {
     }
 #endif
 
+    static FaceCoefficients faceCoefficients(Scalar, Scalar, unsigned)
+    { return {}; }
+
     /*!
      * \brief Adds the dispersive flux to the flux vector over a flux
      *        integration point.
@@ -90,6 +96,14 @@ public:
                                   const Evaluation&,
                                   const Scalar&)
     {}
+
+    template<class FluidState, class Scalar>
+    static void addDispersiveFlux(RateVector&,
+                                  const FluidState&,
+                                  const FluidState&,
+                                  const FaceCoefficients&,
+                                  const Scalar&)
+    {}
 };
 
 /*!
@@ -119,6 +133,20 @@ class BlackOilDispersionModule<TypeTag, /*enableDispersion=*/true>
 
 public:
     using ExtensiveQuantities = BlackOilDispersionExtensiveQuantities<TypeTag,true>;
+
+    /*!
+     * \brief The quantities of the dispersive flux over a face which do not depend on
+     *        the solution.
+     *
+     * The conversion factors are the ones of the PVT region of the interior cell.
+     */
+    struct FaceCoefficients
+    {
+        Scalar dispersivity{0.0}; // dispersivity per face area
+        Scalar toMassFractionGasOil{0.0};
+        Scalar toMassFractionGasWater{0.0};
+    };
+
 #if HAVE_ECL_INPUT
     static void initFromState(const EclipseState& eclState)
     {
@@ -180,7 +208,63 @@ public:
                                   const Evaluation& dispersivity,
                                   const Scalar& normVelocityAvg)
     {
-        unsigned pvtRegionIndex = fluidStateI.pvtRegionIndex();
+        const auto coeffs = faceCoefficients(/*dispersivity=*/0.0, /*faceArea=*/1.0,
+                                             fluidStateI.pvtRegionIndex());
+        addDispersiveFlux_(flux, fluidStateI, fluidStateJ,
+                           dispersivity,
+                           coeffs.toMassFractionGasOil,
+                           coeffs.toMassFractionGasWater,
+                           normVelocityAvg);
+    }
+
+    /*!
+     * \brief Adds the mass flux due to dispersion using face coefficients which have
+     *        been computed in advance by faceCoefficients().
+     */
+    template<class FluidState, class Scalar>
+    static void addDispersiveFlux(RateVector& flux,
+                                  const FluidState& fluidStateI,
+                                  const FluidState& fluidStateJ,
+                                  const FaceCoefficients& coeffs,
+                                  const Scalar& normVelocityAvg)
+    {
+        addDispersiveFlux_(flux, fluidStateI, fluidStateJ,
+                           coeffs.dispersivity,
+                           coeffs.toMassFractionGasOil,
+                           coeffs.toMassFractionGasWater,
+                           normVelocityAvg);
+    }
+
+    /*!
+     * \brief Compute the solution independent quantities of the dispersive flux over
+     *        a face.
+     */
+    static FaceCoefficients faceCoefficients(Scalar dispersivity,
+                                             Scalar faceArea,
+                                             unsigned pvtRegionIdx)
+    {
+        FaceCoefficients coeffs;
+        // opm-models expects per area flux
+        coeffs.dispersivity = dispersivity / faceArea;
+        if (FluidSystem::phaseIsActive(FluidSystem::gasPhaseIdx)) {
+            if (FluidSystem::phaseIsActive(FluidSystem::oilPhaseIdx))
+                coeffs.toMassFractionGasOil = toMassFractionGasOil(pvtRegionIdx);
+            if (FluidSystem::phaseIsActive(FluidSystem::waterPhaseIdx))
+                coeffs.toMassFractionGasWater = toMassFractionGasWater(pvtRegionIdx);
+        }
+        return coeffs;
+    }
+
+private:
+    template<class FluidState, class DispersivityEval, class VelocityArray>
+    static void addDispersiveFlux_(RateVector& flux,
+                                   const FluidState& fluidStateI,
+                                   const FluidState& fluidStateJ,
+                                   const DispersivityEval& dispersivity,
+                                   const Scalar fractionGasOil,
+                                   const Scalar fractionGasWater,
+                                   const VelocityArray& normVelocityAvg)
+    {
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
             if (!FluidSystem::phaseIsActive(phaseIdx)) {
                 continue;
@@ -212,22 +296,22 @@ public:
             Evaluation diffR = 0.0;
             if (FluidSystem::enableDissolvedGas() && FluidSystem::phaseIsActive(FluidSystem::gasPhaseIdx) && phaseIdx == FluidSystem::oilPhaseIdx) {
                 Evaluation rsAvg = (fluidStateI.Rs() + Toolbox::value(fluidStateJ.Rs())) / 2;
-                convFactor = 1.0 / (toMassFractionGasOil(pvtRegionIndex) + rsAvg);
+                convFactor = 1.0 / (fractionGasOil + rsAvg);
                 diffR = fluidStateI.Rs() - Toolbox::value(fluidStateJ.Rs());
             }
             if (FluidSystem::enableVaporizedOil() && FluidSystem::phaseIsActive(FluidSystem::oilPhaseIdx) && phaseIdx == FluidSystem::gasPhaseIdx) {
                 Evaluation rvAvg = (fluidStateI.Rv() + Toolbox::value(fluidStateJ.Rv())) / 2;
-                convFactor = toMassFractionGasOil(pvtRegionIndex) / (1.0 + rvAvg*toMassFractionGasOil(pvtRegionIndex));
+                convFactor = fractionGasOil / (1.0 + rvAvg*fractionGasOil);
                 diffR = fluidStateI.Rv() - Toolbox::value(fluidStateJ.Rv());
             }
             if (FluidSystem::enableDissolvedGasInWater() && phaseIdx == FluidSystem::waterPhaseIdx) {
                 Evaluation rsAvg = (fluidStateI.Rsw() + Toolbox::value(fluidStateJ.Rsw())) / 2;
-                convFactor = 1.0 / (toMassFractionGasWater(pvtRegionIndex) + rsAvg);
+                convFactor = 1.0 / (fractionGasWater + rsAvg);
                 diffR = fluidStateI.Rsw() - Toolbox::value(fluidStateJ.Rsw());
             }
             if (FluidSystem::enableVaporizedWater() && phaseIdx == FluidSystem::gasPhaseIdx) {
                 Evaluation rvAvg = (fluidStateI.Rvw() + Toolbox::value(fluidStateJ.Rvw())) / 2;
-                convFactor = toMassFractionGasWater(pvtRegionIndex)/ (1.0 + rvAvg*toMassFractionGasWater(pvtRegionIndex));
+                convFactor = fractionGasWater / (1.0 + rvAvg*fractionGasWater);
                 diffR = fluidStateI.Rvw() - Toolbox::value(fluidStateJ.Rvw());
             }
 
@@ -253,8 +337,6 @@ public:
         }
     }
 
-private:
-
     static Scalar toMassFractionGasOil (unsigned regionIdx) {
         Scalar rhoO = FluidSystem::referenceDensity(FluidSystem::oilPhaseIdx, regionIdx);
         Scalar rhoG = FluidSystem::referenceDensity(FluidSystem::gasPhaseIdx, regionIdx);
@@ -377,12 +377,35 @@ public:
                 mobilities.push_back(&(dirMob_->getArray(i)));
             }
         }
+        std::array<Evaluation, numPhases> invB;
+        std::array<Evaluation, numPhases> viscosity;
+        {
+            OPM_TIMEBLOCK_LOCAL(pvtPropertiesUpdate);
+            // the PVT cache may only be used for the primary degrees of freedom: with
+            // the cell-centered discretizations to which the cache is restricted,
+            // these are only updated by the thread which handles their element.
+            auto& pvtCache = problem.model().pvtCache();
+            if (pvtCache.enabled() && timeIdx == 0 && dofIdx < elemCtx.numPrimaryDof(timeIdx)) {
+                pvtCache.evaluate(globalSpaceIdx,
+                                  fluidState_,
+                                  scalarValue(SoMax),
+                                  invB,
+                                  viscosity);
+            }
+            else {
+                for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                    if (!FluidSystem::phaseIsActive(phaseIdx))
+                        continue;
+                    invB[phaseIdx] = FluidSystem::inverseFormationVolumeFactor(fluidState_, phaseIdx, pvtRegionIdx);
+                    viscosity[phaseIdx] = FluidSystem::viscosity(fluidState_, paramCache, phaseIdx);
+                }
+            }
+        }
         for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
             if (!FluidSystem::phaseIsActive(phaseIdx))
                 continue;
-            const auto& b = FluidSystem::inverseFormationVolumeFactor(fluidState_, phaseIdx, pvtRegionIdx);
-            fluidState_.setInvB(phaseIdx, b);
-            const auto& mu = FluidSystem::viscosity(fluidState_, paramCache, phaseIdx);
+            fluidState_.setInvB(phaseIdx, invB[phaseIdx]);
+            const auto& mu = viscosity[phaseIdx];
             for (int i = 0; i<nmobilities; i++) {
                 if (enableExtbo && phaseIdx == oilPhaseIdx) {
                     (*mobilities[i])[phaseIdx] /= asImp_().oilViscosity();
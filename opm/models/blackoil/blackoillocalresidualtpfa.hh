@@ -43,6 +43,8 @@
 #include <opm/input/eclipse/EclipseState/Grid/FaceDir.hpp>
 #include <opm/input/eclipse/Schedule/BCProp.hpp>
 
+#include <array>
+
 namespace Opm {
 /*!
  * \ingroup BlackOilModel
@@ -115,6 +117,35 @@ class BlackOilLocalResidualTPFA : public GetPropType<TypeTag, Properties::DiscLo
 
 public:
 
+    /*!
+     * \brief The properties of a cell at the beginning of the time step which are
+     *        used if the cell is the upstream cell of a phase and treated explicitly.
+     */
+    struct LaggedUpstreamProperties
+    {
+        std::array<Scalar, numPhases> mobility{};
+        std::array<Scalar, numPhases> invB{};
+        Scalar Rs = 0.0;
+        Scalar Rsw = 0.0;
+        Scalar Rv = 0.0;
+        Scalar Rvw = 0.0;
+    };
+
+    /*!
+     * \brief The information required to treat the upstream cell of a face explicitly.
+     *
+     * If the upstream cell of a phase is explicit, its mobility, formation volume
+     * factor and dissolution factors are taken from the beginning of the time step,
+     * so the flux of the phase only depends on the pressures of the current solution.
+     */
+    struct AdaptiveImplicitInfo
+    {
+        bool explicitIn = false;
+        bool explicitEx = false;
+        LaggedUpstreamProperties in{};
+        LaggedUpstreamProperties ex{};
+    };
+
     struct ResidualNBInfo
     {
         double trans;
@@ -128,8 +159,123 @@ public:
         double outAlpha;
         double diffusivity;
         double dispersivity;
+        // solution independent parts of the module fluxes, see updateFaceCoefficients()
+        typename DiffusionModule::FaceCoefficients diffusion{};
+        typename DispersionModule::FaceCoefficients dispersion{};
+        typename ConvectiveMixingModule::FaceCoefficients convectiveMixing{};
+        // adaptive implicit treatment of the face, see updateAdaptiveImplicitInfo()
+        AdaptiveImplicitInfo adaptiveImplicit{};
     };
 
+    /*!
+     * \brief Precompute the parts of the diffusive, dispersive and convective mixing
+     *        fluxes over a face which do not depend on the solution.
+     *
+     * This needs to be called once the remaining members of the neighbor info have
+     * been set.
+     */
+    static void updateFaceCoefficients(ResidualNBInfo& nbInfo,
+                                       unsigned pvtRegionIdxIn,
+                                       unsigned pvtRegionIdxEx)
+    {
+        nbInfo.diffusion = DiffusionModule::faceCoefficients(nbInfo.diffusivity,
+                                                             nbInfo.faceArea,
+                                                             pvtRegionIdxIn);
+        nbInfo.dispersion = DispersionModule::faceCoefficients(nbInfo.dispersivity,
+                                                               nbInfo.faceArea,
+                                                               pvtRegionIdxIn);
+        nbInfo.convectiveMixing = ConvectiveMixingModule::faceCoefficients(nbInfo.dZg,
+                                                                           nbInfo.trans,
+                                                                           nbInfo.faceArea,
+                                                                           pvtRegionIdxIn,
+                                                                           pvtRegionIdxEx);
+    }
+
+    /*!
+     * \brief Store the properties of both cells of a face for the adaptive implicit
+     *        formulation and specify which of the cells are treated explicitly.
+     *
+     * This is supposed to be called at the beginning of a time step, i.e., when the
+     * intensive quantities still correspond to the solution of the last time step.
+     */
+    static void updateAdaptiveImplicitInfo(ResidualNBInfo& nbInfo,
+                                           bool explicitIn,
+                                           bool explicitEx,
+                                           const IntensiveQuantities& intQuantsIn,
+                                           const IntensiveQuantities& intQuantsEx)
+    {
+        auto& aim = nbInfo.adaptiveImplicit;
+        aim.explicitIn = explicitIn;
+        aim.explicitEx = explicitEx;
+        storeLaggedProperties_(aim.in, intQuantsIn, nbInfo.faceDir);
+        storeLaggedProperties_(aim.ex, intQuantsEx, nbInfo.faceDir);
+    }
+
+    /*!
+     * \brief Returns true if the flux over a face only has derivatives with regard to
+     *        the pressure primary variable.
+     *
+     * This is the case if both cells of the face are treated explicitly and no fluxes
+     * except those of the phases are considered. The derivatives of the phase pressure
+     * differences with regard to the remaining primary variables, i.e., those of the
+     * capillary pressures and of the densities, are dropped for such faces. This only
+     * affects the Jacobian, not the residual.
+     */
+    static bool fluxOnlyDependsOnPressure(const ResidualNBInfo& nbInfo)
+    {
+        constexpr bool onlyPhaseFluxes =
+            !enableEnergy && !enableDiffusion && !enableDispersion && !enableConvectiveMixing;
+        return onlyPhaseFluxes
+            && nbInfo.adaptiveImplicit.explicitIn
+            && nbInfo.adaptiveImplicit.explicitEx;
+    }
+
+    /*!
+     * \brief Compute the reservoir volume fluxes of the phases over a face.
+     *
+     * No derivatives and no fluxes of the conserved quantities are computed. This is
+     * used to estimate the CFL numbers of the adaptive implicit formulation.
+     */
+    static void computeVolumeFluxes(std::array<Scalar, numPhases>& volumeFlux,
+                                    const IntensiveQuantities& intQuantsIn,
+                                    const IntensiveQuantities& intQuantsEx,
+                                    unsigned globalIndexIn,
+                                    unsigned globalIndexEx,
+                                    const ResidualNBInfo& nbInfo,
+                                    const ModuleParams& moduleParams)
+    {
+        const Scalar transMult = (Toolbox::value(intQuantsIn.rockCompTransMultiplier())
+                                  + Toolbox::value(intQuantsEx.rockCompTransMultiplier()))/2;
+        volumeFlux.fill(0.0);
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (!FluidSystem::phaseIsActive(phaseIdx))
+                continue;
+
+            short upIdx;
+            short dnIdx;
+            Evaluation pressureDifference;
+            ExtensiveQuantities::calculatePhasePressureDiff_(upIdx,
+                                                             dnIdx,
+                                                             pressureDifference,
+                                                             intQuantsIn,
+                                                             intQuantsEx,
+                                                             phaseIdx,
+                                                             /*interiorDofIdx=*/0,
+                                                             /*exteriorDofIdx=*/1,
+                                                             nbInfo.Vin,
+                                                             nbInfo.Vex,
+                                                             globalIndexIn,
+                                                             globalIndexEx,
+                                                             nbInfo.dZg,
+                                                             nbInfo.thpres,
+                                                             moduleParams);
+            const IntensiveQuantities& up = (upIdx == 0) ? intQuantsIn : intQuantsEx;
+            volumeFlux[phaseIdx] = Toolbox::value(pressureDifference)
+                * Toolbox::value(up.mobility(phaseIdx, nbInfo.faceDir))
+                * transMult * (-nbInfo.trans);
+        }
+    }
+
     struct ModuleParams {
         ConvectiveMixingModuleParam convectiveMixingModuleParam;
     };
@@ -310,7 +456,13 @@ public:
         const Scalar diffusivity = problem.diffusivity(globalIndexEx, globalIndexIn);
         const Scalar dispersivity = problem.dispersivity(globalIndexEx, globalIndexIn);
 
-        const ResidualNBInfo res_nbinfo {trans, faceArea, thpres, distZ * g, faceDir, Vin, Vex, inAlpha, outAlpha, diffusivity, dispersivity};
+        ResidualNBInfo res_nbinfo {trans, faceArea, thpres, distZ * g, faceDir, Vin, Vex,
+                                   inAlpha, outAlpha, diffusivity, dispersivity,
+                                   /*diffusion=*/{}, /*dispersion=*/{},
+                                   /*convectiveMixing=*/{}, /*adaptiveImplicit=*/{}};
+        updateFaceCoefficients(res_nbinfo,
+                               intQuantsIn.pvtRegionIndex(),
+                               intQuantsEx.pvtRegionIndex());
 
         calculateFluxes_(flux,
                          darcy,
@@ -373,41 +525,53 @@ public:
             unsigned globalUpIndex = (upIdx == interiorDofIdx) ? globalIndexIn : globalIndexEx;
             // Use arithmetic average (more accurate with harmonic, but that requires recomputing the transmissbility)
             const Evaluation transMult = (intQuantsIn.rockCompTransMultiplier() + Toolbox::value(intQuantsEx.rockCompTransMultiplier()))/2;
+            const auto& aim = nbInfo.adaptiveImplicit;
+            const bool upIsIn = (globalUpIndex == globalIndexIn);
+            const bool upIsExplicit = upIsIn ? aim.explicitIn : aim.explicitEx;
+            const LaggedUpstreamProperties& lagged = upIsIn ? aim.in : aim.ex;
             Evaluation darcyFlux;
-            if (globalUpIndex == globalIndexIn) {
-                    darcyFlux = pressureDifference * up.mobility(phaseIdx, facedir) * transMult * (-trans / faceArea);
+            if (upIsExplicit) {
+                darcyFlux = pressureDifference * (lagged.mobility[phaseIdx] * transMult * (-trans / faceArea));
+                if (fluxOnlyDependsOnPressure(nbInfo))
+                    keepPressureDerivative_(darcyFlux);
+            } else if (upIsIn) {
+                darcyFlux = pressureDifference * up.mobility(phaseIdx, facedir) * transMult * (-trans / faceArea);
             } else {
-                darcyFlux = pressureDifference *
-                    (Toolbox::value(up.mobility(phaseIdx, facedir)) * transMult * (-trans / faceArea));
+                darcyFlux = pressureDifference * (Toolbox::value(up.mobility(phaseIdx, facedir)) * transMult * (-trans / faceArea));
             }
 
             unsigned activeCompIdx = Indices::canonicalToActiveComponentIndex(FluidSystem::solventComponentIndex(phaseIdx));
             darcy[conti0EqIdx + activeCompIdx] = darcyFlux.value() * faceArea; // NB! For the FLORES fluxes without derivatives
 
             unsigned pvtRegionIdx = up.pvtRegionIndex();
+            if (upIsExplicit) {
+                const Evaluation surfaceVolumeFlux = lagged.invB[phaseIdx] * darcyFlux;
+                evalLaggedPhaseFluxes_(flux, phaseIdx, pvtRegionIdx, surfaceVolumeFlux, lagged);
+            }
             // if (upIdx == globalFocusDofIdx){
-            if (globalUpIndex == globalIndexIn) {
+            else if (upIsIn) {
                 const auto& invB
                     = getInvB_<FluidSystem, FluidState, Evaluation>(up.fluidState(), phaseIdx, pvtRegionIdx);
                 const auto& surfaceVolumeFlux = invB * darcyFlux;
                 evalPhaseFluxes_<Evaluation, Evaluation, FluidState>(
                     flux, phaseIdx, pvtRegionIdx, surfaceVolumeFlux, up.fluidState());
-                if constexpr (enableEnergy) {
-                    EnergyModule::template addPhaseEnthalpyFluxes_<Evaluation, Evaluation, FluidState>(
-                        flux, phaseIdx, darcyFlux, up.fluidState());
-                }
             } else {
                 const auto& invB = getInvB_<FluidSystem, FluidState, Scalar>(up.fluidState(), phaseIdx, pvtRegionIdx);
                 const auto& surfaceVolumeFlux = invB * darcyFlux;
                 evalPhaseFluxes_<Scalar, Evaluation, FluidState>(
                     flux, phaseIdx, pvtRegionIdx, surfaceVolumeFlux, up.fluidState());
-                if constexpr (enableEnergy) {
+            }
+
+            if constexpr (enableEnergy) {
+                if (upIsIn) {
+                    EnergyModule::template addPhaseEnthalpyFluxes_<Evaluation, Evaluation, FluidState>(
+                        flux, phaseIdx, darcyFlux, up.fluidState());
+                } else {
                     EnergyModule::template
                         addPhaseEnthalpyFluxes_<Scalar, Evaluation, FluidState>
                         (flux,phaseIdx,darcyFlux, up.fluidState());
                 }
             }
-
         }
 
         // deal with solvents (if present)
@@ -429,9 +593,7 @@ public:
                                                             intQuantsEx,
                                                             globalIndexIn,
                                                             globalIndexEx,
-                                                            nbInfo.dZg,
-                                                            nbInfo.trans,
-                                                            nbInfo.faceArea,
+                                                            nbInfo.convectiveMixing,
                                                             moduleParams.convectiveMixingModuleParam);
         }
         
@@ -471,29 +633,27 @@ public:
 
 
 
-        // deal with diffusion (if present). opm-models expects per area flux (added in the tmpdiffusivity).
+        // deal with diffusion (if present). opm-models expects per area flux (the
+        // precomputed face diffusivity is already divided by the face area).
         if constexpr(enableDiffusion){
             typename DiffusionModule::ExtensiveQuantities::EvaluationArray effectiveDiffusionCoefficient;
             DiffusionModule::ExtensiveQuantities::update(effectiveDiffusionCoefficient, intQuantsIn, intQuantsEx);
-            const Scalar diffusivity = nbInfo.diffusivity;
-            const Scalar tmpdiffusivity = diffusivity / faceArea;
             DiffusionModule::addDiffusiveFlux(flux,
                                               intQuantsIn.fluidState(),
                                               intQuantsEx.fluidState(),
-                                              tmpdiffusivity,
+                                              nbInfo.diffusion,
                                               effectiveDiffusionCoefficient);
 
         }
-        // deal with dispersion (if present). opm-models expects per area flux (added in the tmpdispersivity).
+        // deal with dispersion (if present). opm-models expects per area flux (the
+        // precomputed face dispersivity is already divided by the face area).
         if constexpr(enableDispersion){
             typename DispersionModule::ExtensiveQuantities::ScalarArray normVelocityAvg;
             DispersionModule::ExtensiveQuantities::update(normVelocityAvg, intQuantsIn, intQuantsEx);
-            const Scalar dispersivity = nbInfo.dispersivity;
-            const Scalar tmpdispersivity = dispersivity / faceArea;
             DispersionModule::addDispersiveFlux(flux,
                                                 intQuantsIn.fluidState(),
                                                 intQuantsEx.fluidState(),
-                                                tmpdispersivity,
+                                                nbInfo.dispersion,
                                                 normVelocityAvg);
 
         }
@@ -745,6 +905,74 @@ public:
         evalPhaseFluxes_<UpEval>(flux, phaseIdx, pvtRegionIdx, surfaceVolumeFlux, upFs);
     }
 
+    // set all derivatives of an evaluation except the one with regard to the pressure
+    // to zero
+    static void keepPressureDerivative_(Evaluation& eval)
+    {
+        const Scalar pressureDerivative = eval.derivative(Indices::pressureSwitchIdx);
+        eval = Toolbox::createConstant(eval.value());
+        eval.setDerivative(Indices::pressureSwitchIdx, pressureDerivative);
+    }
+
+    // store the properties of a cell which are needed if it is an explicit upstream cell
+    static void storeLaggedProperties_(LaggedUpstreamProperties& lagged,
+                                       const IntensiveQuantities& intQuants,
+                                       FaceDir::DirEnum faceDir)
+    {
+        const auto& fs = intQuants.fluidState();
+        const unsigned pvtRegionIdx = intQuants.pvtRegionIndex();
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (!FluidSystem::phaseIsActive(phaseIdx))
+                continue;
+            lagged.mobility[phaseIdx] = Toolbox::value(intQuants.mobility(phaseIdx, faceDir));
+            lagged.invB[phaseIdx] = getInvB_<FluidSystem, FluidState, Scalar>(fs, phaseIdx, pvtRegionIdx);
+        }
+        if (FluidSystem::enableDissolvedGas())
+            lagged.Rs = BlackOil::getRs_<FluidSystem, FluidState, Scalar>(fs, pvtRegionIdx);
+        if (FluidSystem::enableDissolvedGasInWater())
+            lagged.Rsw = BlackOil::getRsw_<FluidSystem, FluidState, Scalar>(fs, pvtRegionIdx);
+        if (FluidSystem::enableVaporizedOil())
+            lagged.Rv = BlackOil::getRv_<FluidSystem, FluidState, Scalar>(fs, pvtRegionIdx);
+        if (FluidSystem::enableVaporizedWater())
+            lagged.Rvw = BlackOil::getRvw_<FluidSystem, FluidState, Scalar>(fs, pvtRegionIdx);
+    }
+
+    // the same as evalPhaseFluxes_(), but with the properties of an explicit upstream
+    // cell from the beginning of the time step
+    static void evalLaggedPhaseFluxes_(RateVector& flux,
+                                       unsigned phaseIdx,
+                                       unsigned pvtRegionIdx,
+                                       const Evaluation& surfaceVolumeFlux,
+                                       const LaggedUpstreamProperties& lagged)
+    {
+        auto addComponentFlux = [&flux, pvtRegionIdx](unsigned compIdx,
+                                                      unsigned refPhaseIdx,
+                                                      const Evaluation& rate)
+        {
+            const unsigned activeCompIdx = Indices::canonicalToActiveComponentIndex(compIdx);
+            if (blackoilConserveSurfaceVolume)
+                flux[conti0EqIdx + activeCompIdx] += rate;
+            else
+                flux[conti0EqIdx + activeCompIdx] += rate*FluidSystem::referenceDensity(refPhaseIdx, pvtRegionIdx);
+        };
+
+        addComponentFlux(FluidSystem::solventComponentIndex(phaseIdx), phaseIdx, surfaceVolumeFlux);
+        if (phaseIdx == oilPhaseIdx) {
+            if (FluidSystem::enableDissolvedGas())
+                addComponentFlux(gasCompIdx, gasPhaseIdx, lagged.Rs*surfaceVolumeFlux);
+        }
+        else if (phaseIdx == waterPhaseIdx) {
+            if (FluidSystem::enableDissolvedGasInWater())
+                addComponentFlux(gasCompIdx, gasPhaseIdx, lagged.Rsw*surfaceVolumeFlux);
+        }
+        else if (phaseIdx == gasPhaseIdx) {
+            if (FluidSystem::enableVaporizedOil())
+                addComponentFlux(oilCompIdx, oilPhaseIdx, lagged.Rv*surfaceVolumeFlux);
+            if (FluidSystem::enableVaporizedWater())
+                addComponentFlux(waterCompIdx, waterPhaseIdx, lagged.Rvw*surfaceVolumeFlux);
+        }
+    }
+
     /*!
      * \brief Helper function to calculate the flux of mass in terms of conservation
      *        quantities via specific fluid phase over a face.
@@ -32,18 +32,29 @@
 
 #include <opm/models/blackoil/blackoilmicpparams.hh>
 #include <opm/models/io/vtkblackoilmicpmodule.hh>
+#include <opm/models/parallel/threadedentityiterator.hh>
+#include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/timer.hh>
+
+#include <opm/material/densead/Evaluation.hpp>
 
 #if HAVE_ECL_INPUT
 #include <opm/input/eclipse/EclipseState/EclipseState.hpp>
 #include <opm/input/eclipse/EclipseState/MICPpara.hpp>
 #endif
 
+#include <dune/common/fmatrix.hh>
 #include <dune/common/fvector.hh>
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <cstddef>
+#include <iostream>
+#include <limits>
 #include <stdexcept>
 #include <string>
+#include <vector>
 
 namespace Opm {
 /*!
@@ -66,9 +77,17 @@ class BlackOilMICPModule
     using EqVector = GetPropType<TypeTag, Properties::EqVector>;
     using RateVector = GetPropType<TypeTag, Properties::RateVector>;
     using Indices = GetPropType<TypeTag, Properties::Indices>;
+    using GridView = GetPropType<TypeTag, Properties::GridView>;
+    using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
 
     using Toolbox = MathToolbox<Evaluation>;
 
+    // the unknowns of the reaction sub-problem are the five MICP concentrations, in
+    // the order microbes, oxygen, urea, biofilm, calcite
+    static constexpr unsigned numReactionVars = 5;
+    using ReactionVector = std::array<Scalar, numReactionVars>;
+    using ReactionEvaluation = DenseAd::Evaluation<Scalar, numReactionVars>;
+
     static constexpr unsigned microbialConcentrationIdx = Indices::microbialConcentrationIdx;
     static constexpr unsigned oxygenConcentrationIdx = Indices::oxygenConcentrationIdx;
     static constexpr unsigned ureaConcentrationIdx = Indices::ureaConcentrationIdx;
@@ -203,8 +222,38 @@ public:
             return;
 
         VtkBlackOilMICPModule<TypeTag>::registerParameters();
+
+        Parameters::Register<Parameters::MICPOperatorSplitting>
+            ("Solve the MICP reactions after the transport of each time step "
+             "using implicit sub-steps in every cell");
+        Parameters::Register<Parameters::MICPReactionTolerance<Scalar>>
+            ("Relative tolerance for the local error of the MICP reaction sub-steps");
+        Parameters::Register<Parameters::MICPMaxReactionSubSteps>
+            ("Maximum number of MICP reaction sub-steps per cell and time step");
+        Parameters::Register<Parameters::MICPReactionVerbose>
+            ("Print statistics about the MICP reaction sub-steps");
+    }
+
+    /*!
+     * \brief Read the run-time parameters of the black-oil MICP module.
+     */
+    static void init()
+    {
+        if constexpr (enableMICP) {
+            params_.operatorSplitting_ = Parameters::Get<Parameters::MICPOperatorSplitting>();
+            params_.reactionTolerance_ = Parameters::Get<Parameters::MICPReactionTolerance<Scalar>>();
+            params_.maxReactionSubSteps_ = Parameters::Get<Parameters::MICPMaxReactionSubSteps>();
+            params_.reactionVerbose_ = Parameters::Get<Parameters::MICPReactionVerbose>();
+        }
     }
 
+    /*!
+     * \brief Returns true if the reactions are not part of the residual but are
+     *        solved separately by applyReactionStep().
+     */
+    static bool operatorSplitting()
+    { return params_.operatorSplitting_; }
+
     /*!
      * \brief Register all MICP specific VTK and ECL output modules.
      */
@@ -306,52 +355,154 @@ public:
         if (!enableMICP)
             return;
 
-        // compute dpW (max norm of the pressure gradient in the cell center)
+        // the reactions are dealt with by applyReactionStep()
+        if (operatorSplitting())
+            return;
+
         const IntensiveQuantities& intQuants = elemCtx.intensiveQuantities(dofIdx, timeIdx);
-        const auto& K = elemCtx.problem().intrinsicPermeability(elemCtx, dofIdx, 0);
-        size_t numInteriorFaces = elemCtx.numInteriorFaces(timeIdx);
-        Evaluation dpW = 0;
-        for (unsigned scvfIdx = 0; scvfIdx < numInteriorFaces; scvfIdx++) {
-          const auto& extQuants = elemCtx.extensiveQuantities(scvfIdx, timeIdx);
-          unsigned upIdx = extQuants.upstreamIndex(waterPhaseIdx);
-          const auto& up = elemCtx.intensiveQuantities(upIdx, timeIdx);
-          const Evaluation& mobWater = up.mobility(waterPhaseIdx);
+        const Evaluation dpW = computeWaterVelocityNorm_(elemCtx, dofIdx, timeIdx);
+
+        const auto rates = reactionRates_(intQuants.porosity(),
+                                          intQuants.microbialConcentration(),
+                                          intQuants.oxygenConcentration(),
+                                          intQuants.ureaConcentration(),
+                                          intQuants.biofilmConcentration(),
+                                          dpW);
+        source[Indices::contiMicrobialEqIdx] += rates[0];
+        source[Indices::contiOxygenEqIdx] += rates[1];
+        source[Indices::contiUreaEqIdx] += rates[2];
+        source[Indices::contiBiofilmEqIdx] += rates[3];
+        source[Indices::contiCalciteEqIdx] += rates[4];
+    }
 
-          // compute water velocity from flux
-          Evaluation waterVolumeVelocity = extQuants.volumeFlux(waterPhaseIdx) / (K[0][0] * mobWater);
-          dpW = std::max(dpW, abs(waterVolumeVelocity));
+    /*!
+     * \brief Integrate the MICP reactions over the current time step.
+     *
+     * This is used if operator splitting is enabled: After the transport problem of a
+     * time step has converged, the reaction kinetics are integrated independently in
+     * every cell, keeping the porosity of the transport solution and the water
+     * velocities fixed. Each cell uses implicit Euler sub-steps whose size is chosen
+     * by step doubling, i.e., it is controlled by the difference between one full and
+     * two half steps.
+     *
+     * \return false if the reactions could not be integrated in at least one cell.
+     */
+    static bool applyReactionStep(Simulator& simulator)
+    {
+        if constexpr (enableMICP) {
+            Timer reactionTimer;
+            reactionTimer.start();
+
+            auto& model = simulator.model();
+            const auto& gridView = simulator.gridView();
+            const Scalar dt = simulator.timeStepSize();
+
+            // with vertex-centered discretizations, the degrees of freedom are shared
+            // by several elements
+            if (model.numGridDof() != static_cast<std::size_t>(gridView.size(/*codim=*/0)))
+                throw std::logic_error("Operator splitting of the MICP reactions requires "
+                                       "a cell-centered discretization");
+
+            // the reactions of a cell depend on the water velocities, i.e., on the state
+            // of its neighbors. Thus all inputs are gathered before any primary variable
+            // gets modified.
+            const std::size_t numDof = model.numGridDof();
+            std::vector<Scalar> cellDpW(numDof, 0.0);
+            std::vector<Scalar> cellPorosity(numDof, 0.0);
+            std::vector<char> isInteriorCell(numDof, 0);
+
+            ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+            {
+                // Attention: the variables below are thread specific and thus cannot be
+                // moved in front of the #pragma!
+                ElementContext elemCtx(simulator);
+                auto elemIt = threadedElemIt.beginParallel();
+                for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                    const auto& elem = *elemIt;
+                    if (elem.partitionType() != Dune::InteriorEntity)
+                        continue;
+
+                    elemCtx.updateAll(elem);
+                    const unsigned numPrimaryDof = elemCtx.numPrimaryDof(/*timeIdx=*/0);
+                    for (unsigned dofIdx = 0; dofIdx < numPrimaryDof; ++dofIdx) {
+                        const unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+                        const auto& intQuants = elemCtx.intensiveQuantities(dofIdx, /*timeIdx=*/0);
+                        cellDpW[globalIdx] = scalarValue(computeWaterVelocityNorm_(elemCtx, dofIdx, /*timeIdx=*/0));
+                        cellPorosity[globalIdx] = scalarValue(intQuants.porosity());
+                        isInteriorCell[globalIdx] = 1;
+                    }
+                }
+            }
+
+            std::vector<int> threadSucceeded(ThreadManager::maxThreads(), 1);
+            std::vector<int> threadMaxSubSteps(ThreadManager::maxThreads(), 0);
+            std::vector<Scalar> threadMinSubStepSize(ThreadManager::maxThreads(), dt);
+
+            auto& solution = model.solution(/*timeIdx=*/0);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+            for (std::size_t globalIdx = 0; globalIdx < numDof; ++globalIdx) {
+                if (!isInteriorCell[globalIdx])
+                    continue;
+
+                const unsigned threadId = ThreadManager::threadId();
+                PrimaryVariables& priVars = solution[globalIdx];
+                ReactionVector y = {priVars[microbialConcentrationIdx],
+                                    priVars[oxygenConcentrationIdx],
+                                    priVars[ureaConcentrationIdx],
+                                    priVars[biofilmConcentrationIdx],
+                                    priVars[calciteConcentrationIdx]};
+                // the porosity without the volume occupied by biofilm and calcite
+                const Scalar phi0 = cellPorosity[globalIdx] + y[3] + y[4];
+
+                int numSubSteps = 0;
+                Scalar minSubStepSize = dt;
+                if (!integrateReactions_(y, phi0, cellDpW[globalIdx], dt, numSubSteps, minSubStepSize)) {
+                    threadSucceeded[threadId] = 0;
+                    continue;
+                }
+
+                priVars[microbialConcentrationIdx] = y[0];
+                priVars[oxygenConcentrationIdx] = y[1];
+                priVars[ureaConcentrationIdx] = y[2];
+                priVars[biofilmConcentrationIdx] = y[3];
+                priVars[calciteConcentrationIdx] = y[4];
+
+                threadMaxSubSteps[threadId] = std::max(threadMaxSubSteps[threadId], numSubSteps);
+                threadMinSubStepSize[threadId] = std::min(threadMinSubStepSize[threadId], minSubStepSize);
+            }
+
+            const auto& comm = gridView.comm();
+            const bool succeeded =
+                comm.min(*std::min_element(threadSucceeded.begin(), threadSucceeded.end()));
+            if (!succeeded)
+                return false;
+
+            model.syncOverlap();
+            model.invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0);
+
+            reactionTimer.stop();
+            if (params_.reactionVerbose_) {
+                const int maxSubSteps =
+                    comm.max(*std::max_element(threadMaxSubSteps.begin(), threadMaxSubSteps.end()));
+                const Scalar minSubStepSize =
+                    comm.min(*std::min_element(threadMinSubStepSize.begin(), threadMinSubStepSize.end()));
+                if (comm.rank() == 0)
+                    std::cout << "MICP reactions: time step size " << dt << " seconds, "
+                              << "at most " << maxSubSteps << " sub-steps per cell, "
+                              << "smallest sub-step size " << minSubStepSize << " seconds, "
+                              << "took " << reactionTimer.realTimeElapsed() << " seconds\n"
+                              << std::flush;
+            }
+
+            return true;
         }
-
-        // get the model parameters
-        Scalar k_a = microbialAttachmentRate();
-        Scalar k_d = microbialDeathRate();
-        Scalar rho_b = densityBiofilm();
-        Scalar rho_c = densityCalcite();
-        Scalar k_str = detachmentRate();
-        Scalar k_o = halfVelocityOxygen();
-        Scalar k_u = halfVelocityUrea() / 10.0;//Dividing by scaling factor 10 (see WellInterface_impl.hpp)
-        Scalar mu = maximumGrowthRate();
-        Scalar mu_u = maximumUreaUtilization() / 10.0;//Dividing by scaling factor 10 (see WellInterface_impl.hpp)
-        Scalar Y_sb = yieldGrowthCoefficient();
-        Scalar F = oxygenConsumptionFactor();
-        Scalar Y_uc = 1.67 * 10; //Multiplying by scaling factor 10 (see WellInterface_impl.hpp)
-
-        // compute the processes
-        source[Indices::contiMicrobialEqIdx] += intQuants.microbialConcentration() * intQuants.porosity() *
-                                                      (Y_sb * mu * intQuants.oxygenConcentration() / (k_o + intQuants.oxygenConcentration()) - k_d - k_a)
-                                                + rho_b * intQuants.biofilmConcentration() * k_str * pow(intQuants.porosity() * dpW, 0.58);
-
-        source[Indices::contiOxygenEqIdx] -= (intQuants.microbialConcentration() * intQuants.porosity() + rho_b * intQuants.biofilmConcentration()) *
-                                                    F * mu * intQuants.oxygenConcentration() / (k_o + intQuants.oxygenConcentration());
-
-        source[Indices::contiUreaEqIdx] -= rho_b * intQuants.biofilmConcentration() * mu_u * intQuants.ureaConcentration() / (k_u + intQuants.ureaConcentration());
-
-        source[Indices::contiBiofilmEqIdx] += intQuants.biofilmConcentration() * (Y_sb * mu * intQuants.oxygenConcentration() / (k_o + intQuants.oxygenConcentration()) - k_d
-                                                              - k_str * pow(intQuants.porosity() * dpW, 0.58) - Y_uc * (rho_b / rho_c) * intQuants.biofilmConcentration() * mu_u *
-                                                                  (intQuants.ureaConcentration() / (k_u + intQuants.ureaConcentration())) / (intQuants.porosity() + intQuants.biofilmConcentration()))
-                                              + k_a * intQuants.microbialConcentration() * intQuants.porosity() / rho_b;
-
-        source[Indices::contiCalciteEqIdx] += (rho_b / rho_c) * intQuants.biofilmConcentration() * Y_uc * mu_u * intQuants.ureaConcentration() / (k_u + intQuants.ureaConcentration());
+        else
+            return true;
     }
 
     static const Scalar densityBiofilm()
@@ -445,6 +596,187 @@ public:
     }
 
 private:
+    // compute dpW (max norm of the pressure gradient in the cell center)
+    static Evaluation computeWaterVelocityNorm_(const ElementContext& elemCtx,
+                                                unsigned dofIdx,
+                                                unsigned timeIdx)
+    {
+        const auto& K = elemCtx.problem().intrinsicPermeability(elemCtx, dofIdx, 0);
+        size_t numInteriorFaces = elemCtx.numInteriorFaces(timeIdx);
+        Evaluation dpW = 0;
+        for (unsigned scvfIdx = 0; scvfIdx < numInteriorFaces; scvfIdx++) {
+          const auto& extQuants = elemCtx.extensiveQuantities(scvfIdx, timeIdx);
+          unsigned upIdx = extQuants.upstreamIndex(waterPhaseIdx);
+          const auto& up = elemCtx.intensiveQuantities(upIdx, timeIdx);
+          const Evaluation& mobWater = up.mobility(waterPhaseIdx);
+
+          // compute water velocity from flux
+          Evaluation waterVolumeVelocity = extQuants.volumeFlux(waterPhaseIdx) / (K[0][0] * mobWater);
+          dpW = std::max(dpW, abs(waterVolumeVelocity));
+        }
+        return dpW;
+    }
+
+    // the reaction rates of microbes, oxygen, urea, biofilm and calcite
+    template <class LhsEval>
+    static std::array<LhsEval, numReactionVars> reactionRates_(const LhsEval& porosity,
+                                                              const LhsEval& microbialConcentration,
+                                                              const LhsEval& oxygenConcentration,
+                                                              const LhsEval& ureaConcentration,
+                                                              const LhsEval& biofilmConcentration,
+                                                              const LhsEval& dpW)
+    {
+        // get the model parameters
+        Scalar k_a = microbialAttachmentRate();
+        Scalar k_d = microbialDeathRate();
+        Scalar rho_b = densityBiofilm();
+        Scalar rho_c = densityCalcite();
+        Scalar k_str = detachmentRate();
+        Scalar k_o = halfVelocityOxygen();
+        Scalar k_u = halfVelocityUrea() / 10.0;//Dividing by scaling factor 10 (see WellInterface_impl.hpp)
+        Scalar mu = maximumGrowthRate();
+        Scalar mu_u = maximumUreaUtilization() / 10.0;//Dividing by scaling factor 10 (see WellInterface_impl.hpp)
+        Scalar Y_sb = yieldGrowthCoefficient();
+        Scalar F = oxygenConsumptionFactor();
+        Scalar Y_uc = 1.67 * 10; //Multiplying by scaling factor 10 (see WellInterface_impl.hpp)
+
+        // compute the processes
+        std::array<LhsEval, numReactionVars> rates;
+        rates[0] = microbialConcentration * porosity *
+                       (Y_sb * mu * oxygenConcentration / (k_o + oxygenConcentration) - k_d - k_a)
+                   + rho_b * biofilmConcentration * k_str * pow(porosity * dpW, 0.58);
+
+        rates[1] = - (microbialConcentration * porosity + rho_b * biofilmConcentration) *
+                       F * mu * oxygenConcentration / (k_o + oxygenConcentration);
+
+        rates[2] = - rho_b * biofilmConcentration * mu_u * ureaConcentration / (k_u + ureaConcentration);
+
+        rates[3] = biofilmConcentration * (Y_sb * mu * oxygenConcentration / (k_o + oxygenConcentration) - k_d
+                                           - k_str * pow(porosity * dpW, 0.58) - Y_uc * (rho_b / rho_c) * biofilmConcentration * mu_u *
+                                               (ureaConcentration / (k_u + ureaConcentration)) / (porosity + biofilmConcentration))
+                   + k_a * microbialConcentration * porosity / rho_b;
+
+        rates[4] = (rho_b / rho_c) * biofilmConcentration * Y_uc * mu_u * ureaConcentration / (k_u + ureaConcentration);
+
+        return rates;
+    }
+
+    // the storage term of the reaction sub-problem, cf. addStorage()
+    template <class LhsEval>
+    static std::array<LhsEval, numReactionVars> reactionStorage_(const std::array<LhsEval, numReactionVars>& y,
+                                                                Scalar phi0)
+    {
+        LhsEval surfaceVolumeWater = max(phi0 - y[3] - y[4], 1e-10);
+        return {surfaceVolumeWater * y[0],
+                surfaceVolumeWater * y[1],
+                surfaceVolumeWater * y[2],
+                y[3],
+                y[4]};
+    }
+
+    // do a single implicit Euler step of the reaction sub-problem
+    static bool implicitReactionStep_(ReactionVector& y,
+                                      Scalar phi0,
+                                      Scalar dpW,
+                                      Scalar dt)
+    {
+        const ReactionVector yOld = y;
+        const auto storageOld = reactionStorage_(yOld, phi0);
+        const ReactionEvaluation dpWEval(dpW);
+
+        for (int iterIdx = 0; iterIdx < 20; ++iterIdx) {
+            std::array<ReactionEvaluation, numReactionVars> yEval;
+            for (unsigned i = 0; i < numReactionVars; ++i)
+                yEval[i] = ReactionEvaluation::createVariable(y[i], i);
+
+            const auto storage = reactionStorage_(yEval, phi0);
+            const auto rates = reactionRates_(phi0 - yEval[3] - yEval[4],
+                                              yEval[0], yEval[1], yEval[2], yEval[3],
+                                              dpWEval);
+
+            Dune::FieldMatrix<Scalar, numReactionVars, numReactionVars> jac;
+            Dune::FieldVector<Scalar, numReactionVars> res;
+            for (unsigned i = 0; i < numReactionVars; ++i) {
+                const ReactionEvaluation r = storage[i] - storageOld[i] - dt*rates[i];
+                res[i] = r.value();
+                for (unsigned j = 0; j < numReactionVars; ++j)
+                    jac[i][j] = r.derivative(j);
+            }
+
+            Dune::FieldVector<Scalar, numReactionVars> delta;
+            try {
+                jac.solve(delta, res);
+            }
+            catch (const Dune::FMatrixError&) {
+                return false;
+            }
+
+            bool converged = true;
+            for (unsigned i = 0; i < numReactionVars; ++i) {
+                if (!std::isfinite(delta[i]))
+                    return false;
+
+                // concentrations cannot become negative
+                const Scalar newValue = std::max(y[i] - delta[i], Scalar{0.0});
+                converged = converged && std::abs(newValue - y[i]) <= 1e-10*(1.0 + std::abs(y[i]));
+                y[i] = newValue;
+            }
+
+            if (converged)
+                return true;
+        }
+
+        return false;
+    }
+
+    // integrate the reactions of a cell over a time step of size dt
+    static bool integrateReactions_(ReactionVector& y,
+                                    Scalar phi0,
+                                    Scalar dpW,
+                                    Scalar dt,
+                                    int& numSubSteps,
+                                    Scalar& minSubStepSize)
+    {
+        // concentrations below this value are not considered for the error estimate
+        const Scalar absFloor = 1e-8;
+        const Scalar tol = params_.reactionTolerance_;
+
+        Scalar t = 0.0;
+        Scalar h = dt;
+        for (int tryIdx = 0; t < dt; ++tryIdx) {
+            if (tryIdx >= params_.maxReactionSubSteps_)
+                return false;
+
+            h = std::min(h, dt - t);
+
+            ReactionVector yFull = y;
+            ReactionVector yHalf = y;
+            if (!implicitReactionStep_(yFull, phi0, dpW, h)
+                || !implicitReactionStep_(yHalf, phi0, dpW, h/2)
+                || !implicitReactionStep_(yHalf, phi0, dpW, h/2))
+            {
+                h /= 4;
+                continue;
+            }
+
+            Scalar err = 0.0;
+            for (unsigned i = 0; i < numReactionVars; ++i)
+                err = std::max(err, std::abs(yFull[i] - yHalf[i])/(tol*std::max(std::abs(yHalf[i]), absFloor)));
+
+            if (err <= 1.0) {
+                y = yHalf;
+                t += h;
+                ++numSubSteps;
+                minSubStepSize = std::min(minSubStepSize, h);
+            }
+
+            // the local error of the implicit Euler method is of second order
+            h *= std::clamp(Scalar{0.9}/std::sqrt(std::max(err, Scalar{1e-10})), Scalar{0.2}, Scalar{5.0});
+        }
+
+        return true;
+    }
+
     static BlackOilMICPParams<Scalar> params_;
 };
 
@@ -30,6 +30,23 @@
 
 #include <vector>
 
+namespace Opm::Parameters {
+
+//! \brief Solve the MICP reactions separately from the transport in each time step.
+struct MICPOperatorSplitting { static constexpr bool value = false; };
+
+//! \brief Relative tolerance for the error of the MICP reaction sub-steps.
+template<class Scalar>
+struct MICPReactionTolerance { static constexpr Scalar value = 1e-4; };
+
+//! \brief Maximum number of MICP reaction sub-steps per cell and time step.
+struct MICPMaxReactionSubSteps { static constexpr int value = 1000; };
+
+//! \brief Print statistics of the MICP reaction sub-stepping.
+struct MICPReactionVerbose { static constexpr bool value = false; };
+
+} // namespace Opm::Parameters
+
 namespace Opm {
 
 //! \brief Struct holding the parameters for the BlackOilMICPModule class.
@@ -53,6 +70,12 @@ struct BlackOilMICPParams {
     Scalar maximumUreaConcentration_;
     Scalar toleranceBeforeClogging_;
     std::vector<Scalar> phi_;
+
+    // settings for solving the reactions separately from the transport
+    bool operatorSplitting_ = false;
+    Scalar reactionTolerance_ = 1e-4;
+    int maxReactionSubSteps_ = 1000;
+    bool reactionVerbose_ = false;
 };
 
 } // namespace Opm
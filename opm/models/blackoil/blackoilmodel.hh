@@ -49,6 +49,7 @@
 #include <opm/models/blackoil/blackoilprimaryvariables.hh>
 #include <opm/models/blackoil/blackoilproblem.hh>
 #include <opm/models/blackoil/blackoilproperties.hh>
+#include <opm/models/blackoil/blackoilpvtcache.hh>
 #include <opm/models/blackoil/blackoilratevector.hh>
 #include <opm/models/blackoil/blackoilsolventmodules.hh>
 #include <opm/models/blackoil/blackoiltwophaseindices.hh>
@@ -311,6 +312,11 @@ public:
         : ParentType(simulator)
     {
         eqWeights_.resize(numEq, 1.0);
+
+        PolymerModule::init();
+        MICPModule::init();
+
+        pvtCache_.init(this->numGridDof());
     }
 
     /*!
@@ -326,6 +332,7 @@ public:
         EnergyModule::registerParameters();
         DiffusionModule::registerParameters();
         MICPModule::registerParameters();
+        BlackOilPvtCache<TypeTag>::registerParameters();
 
         // register runtime parameters of the VTK output modules
         VtkBlackOilModule<TypeTag>::registerParameters();
@@ -456,6 +463,29 @@ public:
         eqWeights_[eqIdx] = value;
     }
 
+    /*!
+     * \brief Returns the cache for the PVT properties of the degrees of freedom.
+     *
+     * The cache is updated while the intensive quantities are computed, so it can be
+     * modified using a constant model object.
+     */
+    BlackOilPvtCache<TypeTag>& pvtCache() const
+    { return pvtCache_; }
+
+    /*!
+     * \copydoc FvBaseDiscretization::updateConverged
+     *
+     * If the MICP reactions are treated by operator splitting, they are integrated
+     * after the Newton method has converged for the transport problem.
+     */
+    bool updateConverged()
+    {
+        if (MICPModule::operatorSplitting())
+            return MICPModule::applyReactionStep(this->simulator_);
+
+        return true;
+    }
+
     /*!
      * \brief Write the current solution for a degree of freedom to a
      *        restart file.
@@ -608,6 +638,7 @@ protected:
 private:
 
     std::vector<Scalar> eqWeights_;
+    mutable BlackOilPvtCache<TypeTag> pvtCache_;
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
     const Implementation& asImp_() const
@@ -30,6 +30,7 @@
 
 #include <opm/models/blackoil/blackoilnewtonmethodparameters.hh>
 #include <opm/models/blackoil/blackoilproperties.hh>
+#include <opm/models/blackoil/blackoilsequentialsolver.hh>
 
 #include <opm/common/Exceptions.hpp>
 
@@ -37,6 +38,9 @@
 #include <opm/models/nonlinear/newtonmethod.hh>
 #include "blackoilmicpmodules.hh"
 
+#include <memory>
+#include <stdexcept>
+
 namespace Opm::Properties {
 
 template <class TypeTag, class MyTypeTag>
@@ -65,6 +69,7 @@ class BlackOilNewtonMethod : public GetPropType<TypeTag, Properties::DiscNewtonM
     using Scalar = GetPropType<TypeTag, Properties::Scalar>;
     using Linearizer = GetPropType<TypeTag, Properties::Linearizer>;
     using MICPModule = BlackOilMICPModule<TypeTag>;
+    using SequentialSolver = BlackOilSequentialSolver<TypeTag>;
 
     static const unsigned numEq = getPropValue<TypeTag, Properties::NumEq>();
     static constexpr bool enableSaltPrecipitation = getPropValue<TypeTag, Properties::EnableSaltPrecipitation>();
@@ -83,6 +88,8 @@ public:
         pressMin_ = Parameters::Get<Parameters::PressureMin<Scalar>>();
         waterSaturationMax_ = Parameters::Get<Parameters::MaximumWaterSaturation<Scalar>>();
         waterOnlyThreshold_ = Parameters::Get<Parameters::WaterOnlyThreshold<Scalar>>();
+        if (Parameters::Get<Parameters::SequentialImplicit>())
+            sequentialSolver_ = std::make_unique<SequentialSolver>();
     }
 
     /*!
@@ -94,6 +101,10 @@ public:
 
         wasSwitched_.resize(this->model().numTotalDof());
         std::fill(wasSwitched_.begin(), wasSwitched_.end(), false);
+
+        if (sequentialSolver_ && this->simulator_.gridView().comm().size() > 1)
+            throw std::runtime_error("The sequential implicit solution strategy is "
+                                     "only available for sequential runs");
     }
 
     /*!
@@ -126,6 +137,10 @@ public:
             ("Maximum water saturation");
         Parameters::Register<Parameters::WaterOnlyThreshold<Scalar>>
             ("Cells with water saturation above or equal is considered one-phase water only");
+        Parameters::Register<Parameters::SequentialImplicit>
+            ("Solve each Newton iteration sequentially for the pressure and for the "
+             "transported quantities instead of solving the fully coupled system");
+        SequentialSolver::registerParameters();
     }
 
     /*!
@@ -135,19 +150,58 @@ public:
     unsigned numPriVarsSwitched() const
     { return numPriVarsSwitched_; }
 
+    /*!
+     * \copydoc NewtonMethod::converged()
+     *
+     * If the residual was computed using expanded PVT properties, the iteration is
+     * not accepted. Instead, the next iteration evaluates all PVT properties exactly.
+     */
+    bool converged() const
+    { return ParentType::converged() && !pvtCacheExpanded_; }
+
 protected:
     friend NewtonMethod<TypeTag>;
     friend ParentType;
 
+    /*!
+     * \copydoc NewtonMethod::begin_
+     */
+    void begin_(const SolutionVector& u)
+    {
+        pvtCacheExpanded_ = false;
+        ParentType::begin_(u);
+    }
+
     /*!
      * \copydoc FvBaseNewtonMethod::beginIteration_
      */
     void beginIteration_()
     {
         numPriVarsSwitched_ = 0;
+
+        // the last residual was small enough but relied on the PVT cache
+        auto& pvtCache = this->model().pvtCache();
+        if (pvtCache.enabled())
+            pvtCache.setExact(pvtCacheExpanded_ && ParentType::converged());
+
         ParentType::beginIteration_();
     }
 
+    /*!
+     * \copydoc NewtonMethod::preSolve_
+     */
+    void preSolve_(const SolutionVector& currentSolution,
+                   const GlobalEqVector& currentResidual)
+    {
+        ParentType::preSolve_(currentSolution, currentResidual);
+
+        const auto& pvtCache = this->model().pvtCache();
+        if (pvtCache.enabled()) {
+            const auto& comm = this->simulator_.gridView().comm();
+            pvtCacheExpanded_ = comm.max(static_cast<int>(pvtCache.usedExpansion())) > 0;
+        }
+    }
+
     /*!
      * \copydoc FvBaseNewtonMethod::endIteration_
      */
@@ -172,6 +226,23 @@ protected:
         ParentType::endIteration_(uCurrentIter, uLastIter);
     }
 
+    /*!
+     * \copydoc NewtonMethod::solveLinear_
+     *
+     * If the sequential implicit strategy is enabled, the pressure and the
+     * transported quantities are solved for one after the other.
+     */
+    bool solveLinear_(GlobalEqVector& solutionUpdate)
+    {
+        if (!sequentialSolver_)
+            return ParentType::solveLinear_(solutionUpdate);
+
+        auto& linearizer = this->model().linearizer();
+        return sequentialSolver_->solve(linearizer.jacobian(),
+                                        linearizer.residual(),
+                                        solutionUpdate);
+    }
+
 public:
     void update_(SolutionVector& nextSolution,
                  const SolutionVector& currentSolution,
@@ -429,6 +500,9 @@ protected:
 private:
     int numPriVarsSwitched_;
 
+    // true if the PVT cache expanded any properties for the most recent residual
+    bool pvtCacheExpanded_ = false;
+
     Scalar priVarOscilationThreshold_;
     Scalar waterSaturationMax_;
     Scalar waterOnlyThreshold_;
@@ -445,6 +519,9 @@ private:
     // keep track of cells where the primary variable meaning has changed
     // to detect and hinder oscillations
     std::vector<bool> wasSwitched_;
+
+    // only set if the sequential implicit solution strategy is used
+    std::unique_ptr<SequentialSolver> sequentialSolver_;
 };
 
 } // namespace Opm
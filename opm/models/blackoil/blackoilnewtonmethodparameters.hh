@@ -62,6 +62,22 @@ struct MaximumWaterSaturation { static constexpr Scalar value = 1.0; };
 template<class Scalar>
 struct WaterOnlyThreshold { static constexpr Scalar value = 1.0; };
 
+struct SequentialImplicit { static constexpr bool value = false; };
+
+template<class Scalar>
+struct SequentialPressureTolerance { static constexpr Scalar value = 1e-4; };
+
+struct SequentialPressureMaxIterations { static constexpr int value = 500; };
+
+struct SequentialReorderedTransport { static constexpr bool value = true; };
+
+template<class Scalar>
+struct SequentialTransportTolerance { static constexpr Scalar value = 1e-8; };
+
+struct SequentialTransportMaxIterations { static constexpr int value = 100; };
+
+struct SequentialVerbose { static constexpr bool value = false; };
+
 } // namespace Opm::Parameters
 
 #endif
@@ -32,6 +32,7 @@
 
 #include <opm/models/blackoil/blackoilpolymerparams.hh>
 #include <opm/models/io/vtkblackoilpolymermodule.hh>
+#include <opm/models/utils/parametersystem.hh>
 
 #include <opm/common/OpmLog/OpmLog.hpp>
 
@@ -46,9 +47,12 @@
 
 #include <dune/common/fvector.hh>
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <stdexcept>
 #include <string>
+#include <utility>
 
 namespace Opm {
 /*!
@@ -266,6 +270,15 @@ public:
                     params_.plyshlogShearEffectRefLogVelocity_[pvtRegionIdx][i] = waterVelocity[i];
                 }
             }
+
+            for (unsigned pvtRegionIdx = 0; pvtRegionIdx < numPvtRegions; ++ pvtRegionIdx) {
+                params_.buildShearFactorSurface(pvtRegionIdx, shearFactorConcentrationRefinement);
+                if (params_.plyshlogShearFactorSurface_[pvtRegionIdx].empty()) {
+                    OpmLog::warning("The PLYSHLOG table of PVT region " + std::to_string(pvtRegionIdx + 1)
+                                    + " does not yield a monotonic sheared velocity. The shear factor"
+                                    " of this region will be computed iteratively.\n");
+                }
+            }
         }
 
         if (params_.hasShrate_ && !enablePolymerMolarWeight) {
@@ -387,15 +400,55 @@ public:
         }
     }
 
+    //! \brief Set the parameters of the polymer module.
+    static void setParams(BlackOilPolymerParams<Scalar>&& params)
+    {
+        params_ = std::move(params);
+    }
+
     /*!
      * \brief Register all run-time parameters for the black-oil polymer module.
      */
     static void registerParameters()
     {
-        if constexpr (enablePolymer)
+        if constexpr (enablePolymer) {
             VtkBlackOilPolymerModule<TypeTag>::registerParameters();
+
+            Parameters::Register<Parameters::PolymerActivityThreshold<Scalar>>
+                ("Polymer concentration up to which the viscosity corrections of "
+                 "the Todd-Longstaff mixing rule are linearized around a vanishing "
+                 "concentration. This is exact for the default of zero; positive "
+                 "values trade an approximation error of second order in the "
+                 "concentration for speed");
+        }
     }
 
+    /*!
+     * \brief Read the run-time parameters of the black-oil polymer module.
+     */
+    static void init()
+    {
+        if constexpr (enablePolymer) {
+            params_.activityThreshold_ = Parameters::Get<Parameters::PolymerActivityThreshold<Scalar>>();
+            if (params_.activityThreshold_ > 0.0)
+                OpmLog::info("The polymer viscosity corrections are approximated for polymer "
+                             "concentrations up to " + std::to_string(params_.activityThreshold_));
+        }
+    }
+
+    /*!
+     * \brief Returns true if the Todd-Longstaff viscosity corrections need to be fully
+     *        evaluated for a given polymer concentration.
+     *
+     * Otherwise, their linearization around a vanishing concentration is used. All
+     * other polymer properties are always evaluated. This only yields exactly the
+     * same result if the PolymerActivityThreshold parameter is zero. For positive
+     * thresholds, the corrections of cells with small concentrations are
+     * approximated.
+     */
+    static bool isActive(Scalar polymerConcentration)
+    { return std::abs(polymerConcentration) > params_.activityThreshold_; }
+
     /*!
      * \brief Register all polymer specific VTK and ECL output modules.
      */
@@ -706,6 +759,10 @@ public:
      *
      * Input is polymer concentration and either the water velocity or the shrate if hasShrate_ is true.
      * The pvtnumRegionIdx is needed to make sure the right table is used.
+     *
+     * If possible, the shear factor is interpolated from the surface which has been
+     * tabulated at initialization time. Like for the iterative solution, the
+     * derivatives are only taken with regard to the velocity.
      */
     template <class Evaluation>
     static Evaluation computeShearFactor(const Evaluation& polymerConcentration,
@@ -728,10 +785,72 @@ public:
         if (v0AbsLog < shearEffectRefLogVelocity[0])
             return ToolboxLocal::createConstant(v0, 1.0);
 
+        const auto& surface = params_.plyshlogShearFactorSurface_[pvtnumRegionIdx];
+        const Scalar c = scalarValue(polymerConcentration);
+        if (!surface.empty() && surface.concentration.front() <= c && c <= surface.concentration.back())
+            return exp(interpolateLogShearMultiplier_(surface, c, v0AbsLog));
+
+        return computeShearFactorIteratively_(viscosityMultiplier, pvtnumRegionIdx, v0AbsLog);
+    }
+
+    const Scalar molarMass() const
+    {
+        return 0.25; // kg/mol
+    }
+
+private:
+    // number of intervals each interval of the PLYVISC table is split into for the
+    // precomputed shear factor surface
+    static constexpr unsigned shearFactorConcentrationRefinement = 10;
+
+    // evaluate the logarithm of the shear multiplier at a given (unsheared)
+    // logarithmic velocity using row rowIdx of the precomputed surface
+    template <class Evaluation>
+    static Evaluation interpolateLogShearMultiplierRow_(const typename BlackOilPolymerParams<Scalar>::ShearFactorSurface& surface,
+                                                        std::size_t rowIdx,
+                                                        const Evaluation& v0AbsLog)
+    {
+        const std::size_t n = surface.numVelocityNodes;
+        const Scalar* x = surface.logUnshearedVelocity.data() + rowIdx*n;
+        const Scalar* y = surface.logMultiplier.data() + rowIdx*n;
+        if (n == 1)
+            return MathToolbox<Evaluation>::createConstant(v0AbsLog, y[0]);
+
+        // find the segment, values outside of the table are extrapolated linearly
+        std::size_t segIdx = std::upper_bound(x + 1, x + n - 1, scalarValue(v0AbsLog)) - x - 1;
+        const Scalar slope = (y[segIdx + 1] - y[segIdx])/(x[segIdx + 1] - x[segIdx]);
+        return y[segIdx] + slope*(v0AbsLog - x[segIdx]);
+    }
+
+    template <class Evaluation>
+    static Evaluation interpolateLogShearMultiplier_(const typename BlackOilPolymerParams<Scalar>::ShearFactorSurface& surface,
+                                                     Scalar polymerConcentration,
+                                                     const Evaluation& v0AbsLog)
+    {
+        const auto& conc = surface.concentration;
+        if (conc.size() == 1)
+            return interpolateLogShearMultiplierRow_(surface, 0, v0AbsLog);
+
+        std::size_t rowIdx = std::upper_bound(conc.begin() + 1, conc.end() - 1, polymerConcentration) - conc.begin() - 1;
+        const Scalar alpha = (polymerConcentration - conc[rowIdx])/(conc[rowIdx + 1] - conc[rowIdx]);
+        return
+            interpolateLogShearMultiplierRow_(surface, rowIdx, v0AbsLog)*(1.0 - alpha)
+            + interpolateLogShearMultiplierRow_(surface, rowIdx + 1, v0AbsLog)*alpha;
+    }
+
+    // compute the shear factor by solving for the sheared velocity using the
+    // Newton-Raphson method. this is used if the shear factor could not be
+    // tabulated.
+    template <class Evaluation>
+    static Evaluation computeShearFactorIteratively_(Scalar viscosityMultiplier,
+                                                     unsigned pvtnumRegionIdx,
+                                                     const Evaluation& v0AbsLog)
+    {
         // compute shear factor from input
         // Z = (1 + (P - 1) * M(v)) / P
         // where M(v) is computed from user input
         // and P = viscosityMultiplier
+        const std::vector<Scalar>& shearEffectRefLogVelocity = params_.plyshlogShearEffectRefLogVelocity_[pvtnumRegionIdx];
         const std::vector<Scalar>& shearEffectRefMultiplier = params_.plyshlogShearEffectRefMultiplier_[pvtnumRegionIdx];
         size_t numTableEntries = shearEffectRefLogVelocity.size();
         assert(shearEffectRefMultiplier.size() == numTableEntries);
@@ -778,15 +897,8 @@ public:
 
         // return the shear factor
         return exp(logShearEffectMultiplier.eval(u, /*extrapolate=*/true));
-
     }
 
-    const Scalar molarMass() const
-    {
-        return 0.25; // kg/mol
-    }
-
-private:
     static BlackOilPolymerParams<Scalar> params_;
 };
 
@@ -857,23 +969,28 @@ public:
 
         // compute effective viscosities
         if constexpr (!enablePolymerMolarWeight) {
-          const Scalar cmax = PolymerModule::plymaxMaxConcentration(elemCtx, dofIdx, timeIdx);
-            const auto& fs = asImp_().fluidState_;
-            const Evaluation& muWater = fs.viscosity(waterPhaseIdx);
-            const auto& viscosityMultiplier = PolymerModule::plyviscViscosityMultiplierTable(elemCtx, dofIdx, timeIdx);
-            const Evaluation viscosityMixture = viscosityMultiplier.eval(polymerConcentration_, /*extrapolate=*/true) * muWater;
-
-            // Do the Todd-Longstaff mixing
-            const Scalar plymixparToddLongstaff = PolymerModule::plymixparToddLongstaff(elemCtx, dofIdx, timeIdx);
-            const Evaluation viscosityPolymer = viscosityMultiplier.eval(cmax, /*extrapolate=*/true) * muWater;
-            const Evaluation viscosityPolymerEffective = pow(viscosityMixture, plymixparToddLongstaff) * pow(viscosityPolymer, 1.0 - plymixparToddLongstaff);
-            const Evaluation viscosityWaterEffective = pow(viscosityMixture, plymixparToddLongstaff) * pow(muWater, 1.0 - plymixparToddLongstaff);
-
-            const Evaluation cbar = polymerConcentration_ / cmax;
-            // waterViscosity / effectiveWaterViscosity
-            waterViscosityCorrection_ = muWater * ((1.0 - cbar) / viscosityWaterEffective + cbar / viscosityPolymerEffective);
-            // effectiveWaterViscosity / effectivePolymerViscosity
-            polymerViscosityCorrection_ =  (muWater / waterViscosityCorrection_) / viscosityPolymerEffective;
+            const Scalar cmax = PolymerModule::plymaxMaxConcentration(elemCtx, dofIdx, timeIdx);
+            if (!PolymerModule::isActive(getValue(polymerConcentration_))) {
+                polymerFreeViscosityCorrections_(elemCtx, dofIdx, timeIdx, cmax);
+            }
+            else {
+                const auto& fs = asImp_().fluidState_;
+                const Evaluation& muWater = fs.viscosity(waterPhaseIdx);
+                const auto& viscosityMultiplier = PolymerModule::plyviscViscosityMultiplierTable(elemCtx, dofIdx, timeIdx);
+                const Evaluation viscosityMixture = viscosityMultiplier.eval(polymerConcentration_, /*extrapolate=*/true) * muWater;
+
+                // Do the Todd-Longstaff mixing
+                const Scalar plymixparToddLongstaff = PolymerModule::plymixparToddLongstaff(elemCtx, dofIdx, timeIdx);
+                const Evaluation viscosityPolymer = viscosityMultiplier.eval(cmax, /*extrapolate=*/true) * muWater;
+                const Evaluation viscosityPolymerEffective = pow(viscosityMixture, plymixparToddLongstaff) * pow(viscosityPolymer, 1.0 - plymixparToddLongstaff);
+                const Evaluation viscosityWaterEffective = pow(viscosityMixture, plymixparToddLongstaff) * pow(muWater, 1.0 - plymixparToddLongstaff);
+
+                const Evaluation cbar = polymerConcentration_ / cmax;
+                // waterViscosity / effectiveWaterViscosity
+                waterViscosityCorrection_ = muWater * ((1.0 - cbar) / viscosityWaterEffective + cbar / viscosityPolymerEffective);
+                // effectiveWaterViscosity / effectivePolymerViscosity
+                polymerViscosityCorrection_ =  (muWater / waterViscosityCorrection_) / viscosityPolymerEffective;
+            }
         }
         else { // based on PLYVMH
             const auto& plyvmhCoefficients = PolymerModule::plyvmhCoefficients(elemCtx, dofIdx, timeIdx);
@@ -931,6 +1048,40 @@ protected:
     Implementation& asImp_()
     { return *static_cast<Implementation*>(this); }
 
+    /*!
+     * \brief Compute the viscosity corrections of a polymer free cell.
+     *
+     * With the Todd-Longstaff mixing rule, the water viscosity cancels out of both
+     * corrections, i.e., with the viscosity multiplier M(c), the mixing parameter w
+     * and k = 1 - M(c_max)^(w - 1) they become
+     *
+     *   waterViscosityCorrection = M(c)^(-w) * (1 - k c/c_max)
+     *   polymerViscosityCorrection = M(c_max)^(w - 1) / (1 - k c/c_max)
+     *
+     * This method uses the linearization of these expressions around c = 0. For a
+     * vanishing polymer concentration, this yields the same values and derivatives as
+     * the full evaluation but avoids all Evaluation valued powers. For positive
+     * concentrations, the error is of second order in c.
+     */
+    void polymerFreeViscosityCorrections_(const ElementContext& elemCtx,
+                                          unsigned dofIdx,
+                                          unsigned timeIdx,
+                                          const Scalar cmax)
+    {
+        const auto& viscosityMultiplier = PolymerModule::plyviscViscosityMultiplierTable(elemCtx, dofIdx, timeIdx);
+        const Scalar plymixparToddLongstaff = PolymerModule::plymixparToddLongstaff(elemCtx, dofIdx, timeIdx);
+        const Scalar m0 = viscosityMultiplier.eval(Scalar{0.0}, /*extrapolate=*/true);
+        const Scalar dm0 = viscosityMultiplier.evalDerivative(Scalar{0.0}, /*extrapolate=*/true);
+        const Scalar mMaxPow = std::pow(viscosityMultiplier.eval(cmax, /*extrapolate=*/true),
+                                        plymixparToddLongstaff - 1.0);
+        const Scalar k = (1.0 - mMaxPow) / cmax;
+
+        const Scalar w0 = std::pow(m0, -plymixparToddLongstaff);
+        const Scalar dw0 = -plymixparToddLongstaff * w0 / m0 * dm0 - w0 * k;
+        waterViscosityCorrection_ = w0 + dw0 * polymerConcentration_;
+        polymerViscosityCorrection_ = mMaxPow + mMaxPow * k * polymerConcentration_;
+    }
+
     Evaluation polymerConcentration_;
     // polymer molecular weight
     Evaluation polymerMoleWeight_;
@@ -31,9 +31,25 @@
 #include <opm/material/common/Tabulated1DFunction.hpp>
 #include <opm/material/common/IntervalTabulated2DFunction.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <map>
 #include <vector>
 
+namespace Opm::Parameters {
+
+/*!
+ * \brief Polymer concentration up to which the Todd-Longstaff viscosity corrections
+ *        are linearized around a vanishing concentration.
+ *
+ * This is an approximation for positive values.
+ */
+template<class Scalar>
+struct PolymerActivityThreshold { static constexpr Scalar value = 0.0; };
+
+} // namespace Opm::Parameters
+
 namespace Opm {
 
 //! \brief Struct holding the parameters for the BlackOilPolymerModule class.
@@ -108,6 +124,77 @@ struct BlackOilPolymerParams {
         TabulatedTwoDFunction table_func;
     };
 
+    /*!
+     * \brief Precomputed shear-thinning surface of a single PVT region.
+     *
+     * For a fixed polymer concentration, the logarithm of the shear multiplier
+     * is a piecewise linear function of the logarithm of the sheared water
+     * velocity. Since log(v0) = log(v) + log(Z(v)) is then piecewise linear and
+     * monotonic, too, its inverse can be tabulated directly: row j of
+     * logUnshearedVelocity/logMultiplier holds log(v0) and log(Z) at the PLYSHLOG
+     * nodes for the concentration concentration[j]. Evaluating the shear factor
+     * thus boils down to two table look-ups instead of a Newton solve.
+     */
+    struct ShearFactorSurface {
+        std::vector<Scalar> concentration;
+        std::vector<Scalar> logUnshearedVelocity;
+        std::vector<Scalar> logMultiplier;
+        std::size_t numVelocityNodes = 0;
+
+        bool empty() const
+        { return concentration.empty(); }
+    };
+
+    /*!
+     * \brief Tabulate the shear factor of a PVT region.
+     *
+     * The concentration axis consists of the nodes of the PLYVISC table with each
+     * of its intervals uniformly refined by numRefinements. If the relation
+     * between unsheared and sheared velocity turns out not to be monotonic for
+     * some concentration, the surface is left empty and the shear factor must be
+     * computed iteratively.
+     */
+    void buildShearFactorSurface(unsigned pvtRegionIdx, unsigned numRefinements)
+    {
+        plyshlogShearFactorSurface_.resize(plyshlogShearEffectRefLogVelocity_.size());
+
+        const auto& viscMultTable = plyviscViscosityMultiplierTable_[pvtRegionIdx];
+        const auto& refLogVelocity = plyshlogShearEffectRefLogVelocity_[pvtRegionIdx];
+        const auto& refMultiplier = plyshlogShearEffectRefMultiplier_[pvtRegionIdx];
+        const std::size_t numVelocityNodes = refLogVelocity.size();
+
+        ShearFactorSurface surface;
+        surface.numVelocityNodes = numVelocityNodes;
+        const std::size_t numViscNodes = viscMultTable.numSamples();
+        for (std::size_t k = 0; k + 1 < numViscNodes; ++k) {
+            const Scalar c0 = viscMultTable.xAt(k);
+            const Scalar c1 = viscMultTable.xAt(k + 1);
+            for (unsigned r = 0; r < numRefinements; ++r)
+                surface.concentration.push_back(c0 + (c1 - c0)*r/numRefinements);
+        }
+        if (numViscNodes > 0)
+            surface.concentration.push_back(viscMultTable.xAt(numViscNodes - 1));
+
+        surface.logUnshearedVelocity.resize(surface.concentration.size()*numVelocityNodes);
+        surface.logMultiplier.resize(surface.concentration.size()*numVelocityNodes);
+        for (std::size_t j = 0; j < surface.concentration.size(); ++j) {
+            const Scalar viscMult = viscMultTable.eval(surface.concentration[j], /*extrapolate=*/true);
+            for (std::size_t i = 0; i < numVelocityNodes; ++i) {
+                const Scalar logZ = std::log((1.0 + (viscMult - 1.0)*refMultiplier[i]) / viscMult);
+                const std::size_t idx = j*numVelocityNodes + i;
+                surface.logMultiplier[idx] = logZ;
+                surface.logUnshearedVelocity[idx] = refLogVelocity[i] + logZ;
+
+                if (i > 0 && !(surface.logUnshearedVelocity[idx] > surface.logUnshearedVelocity[idx - 1])) {
+                    plyshlogShearFactorSurface_[pvtRegionIdx] = ShearFactorSurface{};
+                    return;
+                }
+            }
+        }
+
+        plyshlogShearFactorSurface_[pvtRegionIdx] = std::move(surface);
+    }
+
     std::vector<Scalar> plyrockDeadPoreVolume_;
     std::vector<Scalar> plyrockResidualResistanceFactor_;
     std::vector<Scalar> plyrockRockDensityFactor_;
@@ -119,6 +206,7 @@ struct BlackOilPolymerParams {
     std::vector<Scalar> plymixparToddLongstaff_;
     std::vector<std::vector<Scalar>> plyshlogShearEffectRefMultiplier_;
     std::vector<std::vector<Scalar>> plyshlogShearEffectRefLogVelocity_;
+    std::vector<ShearFactorSurface> plyshlogShearFactorSurface_;
     std::vector<Scalar> shrate_;
     bool hasShrate_;
     bool hasPlyshlog_;
@@ -128,6 +216,10 @@ struct BlackOilPolymerParams {
     std::map<int, TabulatedTwoDFunction> skprwatTables_;
 
     std::map<int, SkprpolyTable> skprpolyTables_;
+
+    // cells with a polymer concentration up to this value use the linearized
+    // viscosity corrections
+    Scalar activityThreshold_ = 0.0;
 };
 
 } // namespace Opm
@@ -0,0 +1,420 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::BlackOilPvtCache
+ */
+#ifndef EWOMS_BLACK_OIL_PVT_CACHE_HH
+#define EWOMS_BLACK_OIL_PVT_CACHE_HH
+
+#include <opm/material/densead/Evaluation.hpp>
+#include <opm/material/densead/Math.hpp>
+#include <opm/material/fluidstates/BlackOilFluidState.hpp>
+
+#include <opm/models/blackoil/blackoilproperties.hh>
+#include <opm/models/discretization/common/fvbaseproperties.hh>
+#include <opm/models/utils/parametersystem.hh>
+#include <opm/models/utils/propertysystem.hh>
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace Opm::Parameters {
+
+//! \brief Reuse the PVT properties of the last Newton iteration in each cell.
+struct EnablePvtCache { static constexpr bool value = false; };
+
+/*!
+ * \brief Relative change of the pressure, of the mixing ratios, of the temperature and
+ *        of the salt concentration up to which the PVT properties of a cell are
+ *        reevaluated by linearization.
+ */
+template<class Scalar>
+struct PvtCacheTolerance { static constexpr Scalar value = 1e-3; };
+
+} // namespace Opm::Parameters
+
+namespace Opm {
+
+/*!
+ * \ingroup BlackOilModel
+ *
+ * \brief Caches the inverse formation volume factors and the viscosities of the
+ *        fluid phases of each degree of freedom between Newton iterations.
+ *
+ * Whenever the PVT properties of a cell are evaluated, the values and their partial
+ * derivatives with regard to the phase pressure, the mixing ratios of the phase (R_s
+ * for oil, R_v and R_vw for gas, R_sw for water) and, if they are primary variables,
+ * the temperature and the salt concentration are stored. In subsequent evaluations,
+ * the properties are obtained by a first order expansion around the stored state as
+ * long as the relative change of these quantities does not exceed the
+ * PvtCacheTolerance parameter. The intermediate Newton iterations are thus
+ * approximations, which trade accuracy for the table lookups, and the cache is
+ * disabled by default. A tolerance of zero only reuses bit-identical states, which
+ * hardly ever occur between Newton iterations.
+ *
+ * A cached state is never reused if the PVT region or the set of present phases
+ * changed. Since each cache entry must only be updated by a single thread, the cache
+ * is only available for cell-centered discretizations.
+ *
+ * The cache records whether the most recent evaluation of a degree of freedom used the
+ * expansion. If it did, the Newton method must not accept the iteration as converged:
+ * it switches the cache to exact mode, in which all properties are evaluated using
+ * the PVT tables, and only accepts a residual which was computed this way.
+ */
+template <class TypeTag>
+class BlackOilPvtCache
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using FluidSystem = GetPropType<TypeTag, Properties::FluidSystem>;
+    using Indices = GetPropType<TypeTag, Properties::Indices>;
+
+    enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
+    enum { waterPhaseIdx = FluidSystem::waterPhaseIdx };
+    enum { oilPhaseIdx = FluidSystem::oilPhaseIdx };
+    enum { gasPhaseIdx = FluidSystem::gasPhaseIdx };
+    enum { enableBrine = getPropValue<TypeTag, Properties::EnableBrine>() };
+    enum { enableVapwat = getPropValue<TypeTag, Properties::EnableVapwat>() };
+    enum { has_disgas_in_water = getPropValue<TypeTag, Properties::EnableDisgasInWater>() };
+    enum { enableSaltPrecipitation = getPropValue<TypeTag, Properties::EnableSaltPrecipitation>() };
+    enum { enableTemperature = getPropValue<TypeTag, Properties::EnableTemperature>() };
+    enum { enableEnergy = getPropValue<TypeTag, Properties::EnableEnergy>() };
+
+    static constexpr bool compositionSwitchEnabled = Indices::compositionSwitchIdx >= 0;
+    static constexpr bool isCellCentered =
+        std::is_same_v<GetPropType<TypeTag, Properties::DofMapper>,
+                       GetPropType<TypeTag, Properties::ElementMapper>>;
+
+    // the PVT properties are differentiated with regard to the phase pressure, up to
+    // two mixing ratios, and the temperature and the salt concentration if these are
+    // primary variables
+    static constexpr int temperatureVarIdx = 3;
+    static constexpr int saltVarIdx = temperatureVarIdx + (enableEnergy ? 1 : 0);
+    static constexpr int numPvtVars = saltVarIdx + (enableBrine ? 1 : 0);
+    using PvtEvaluation = DenseAd::Evaluation<Scalar, numPvtVars>;
+    using PvtFluidState = BlackOilFluidState<PvtEvaluation,
+                                             FluidSystem,
+                                             enableTemperature,
+                                             enableEnergy,
+                                             compositionSwitchEnabled,
+                                             enableVapwat,
+                                             enableBrine,
+                                             enableSaltPrecipitation,
+                                             has_disgas_in_water,
+                                             Indices::numPhases>;
+
+    struct PhaseEntry
+    {
+        Scalar pressure;
+        std::array<Scalar, 2> mixing;
+        PvtEvaluation invB;
+        PvtEvaluation viscosity;
+    };
+
+    struct Entry
+    {
+        bool valid = false;
+        bool expanded = false;
+        unsigned pvtRegionIdx;
+        unsigned presentPhases;
+        Scalar temperature;
+        Scalar saltConcentration;
+        std::array<PhaseEntry, numPhases> phases;
+    };
+
+public:
+    /*!
+     * \brief Register all run-time parameters of the PVT cache.
+     */
+    static void registerParameters()
+    {
+        Parameters::Register<Parameters::EnablePvtCache>
+            ("Reuse the PVT properties of the last Newton iteration in each cell.");
+        Parameters::Register<Parameters::PvtCacheTolerance<Scalar>>
+            ("Relative change of the pressure, the mixing ratios, the temperature and "
+             "the salt concentration of a cell up to which the cached PVT properties "
+             "are reevaluated by linearization instead of the PVT tables. Zero only "
+             "reuses exactly matching states.");
+    }
+
+    /*!
+     * \brief Read the run-time parameters and allocate the cache entries.
+     */
+    void init(std::size_t numDof)
+    {
+        enabled_ = Parameters::Get<Parameters::EnablePvtCache>();
+        tolerance_ = Parameters::Get<Parameters::PvtCacheTolerance<Scalar>>();
+        if (enabled_ && !isCellCentered)
+            throw std::runtime_error("The PVT cache is only available for cell-centered "
+                                     "discretizations");
+        if (enabled_)
+            entries_.assign(numDof, Entry{});
+    }
+
+    /*!
+     * \brief Returns true if the PVT cache is used.
+     */
+    bool enabled() const
+    { return enabled_; }
+
+    /*!
+     * \brief Specify whether the cached properties must not be expanded.
+     *
+     * In exact mode, the properties are always evaluated using the PVT tables. The
+     * cache entries are still updated, so they can be expanded again once the exact
+     * mode is left.
+     */
+    void setExact(bool yesno)
+    { exact_ = yesno; }
+
+    /*!
+     * \brief Returns true if the properties are always evaluated using the PVT tables.
+     */
+    bool exact() const
+    { return exact_; }
+
+    /*!
+     * \brief Returns true if the most recent evaluation of any degree of freedom of
+     *        this process used the first order expansion instead of the PVT tables.
+     */
+    bool usedExpansion() const
+    {
+        for (const auto& entry : entries_)
+            if (entry.expanded)
+                return true;
+        return false;
+    }
+
+    /*!
+     * \brief Compute the inverse formation volume factors and the viscosities of all
+     *        active phases of a fluid state.
+     *
+     * The pressures, saturations, mixing ratios, the temperature and the salt
+     * concentration of the fluid state must have been set.
+     *
+     * \param globalDofIdx The global index of the degree of freedom. The cache
+     *                     entry of a degree of freedom must not be accessed
+     *                     concurrently.
+     * \param maxOilSaturation The maximum oil saturation of the degree of freedom. It
+     *                         is passed on to the parameter cache of the fluid system
+     *                         but is not part of the cached state.
+     */
+    template <class FluidState, class Evaluation>
+    void evaluate(unsigned globalDofIdx,
+                  const FluidState& fluidState,
+                  Scalar maxOilSaturation,
+                  std::array<Evaluation, numPhases>& invB,
+                  std::array<Evaluation, numPhases>& viscosity)
+    {
+        Entry& entry = entries_[globalDofIdx];
+        const bool reuse = !exact_ && isReusable_(entry, fluidState);
+        if (!reuse)
+            update_(entry, fluidState, maxOilSaturation);
+        entry.expanded = reuse;
+
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (!FluidSystem::phaseIsActive(phaseIdx))
+                continue;
+
+            const PhaseEntry& phaseEntry = entry.phases[phaseIdx];
+            const Evaluation dp = fluidState.pressure(phaseIdx) - phaseEntry.pressure;
+            const auto mixing = mixingRatios_(fluidState, phaseIdx);
+            const Evaluation dr0 = mixing[0] - phaseEntry.mixing[0];
+            const Evaluation dr1 = mixing[1] - phaseEntry.mixing[1];
+            invB[phaseIdx] = expand_<Evaluation>(phaseEntry.invB, dp, dr0, dr1);
+            viscosity[phaseIdx] = expand_<Evaluation>(phaseEntry.viscosity, dp, dr0, dr1);
+            if constexpr (enableEnergy) {
+                const Evaluation dT = fluidState.temperature(/*phaseIdx=*/0) - entry.temperature;
+                invB[phaseIdx] += dT*phaseEntry.invB.derivative(temperatureVarIdx);
+                viscosity[phaseIdx] += dT*phaseEntry.viscosity.derivative(temperatureVarIdx);
+            }
+            if constexpr (enableBrine) {
+                const Evaluation dSalt = fluidState.saltConcentration() - entry.saltConcentration;
+                invB[phaseIdx] += dSalt*phaseEntry.invB.derivative(saltVarIdx);
+                viscosity[phaseIdx] += dSalt*phaseEntry.viscosity.derivative(saltVarIdx);
+            }
+        }
+    }
+
+private:
+    // the mixing ratios on which the properties of a phase depend
+    template <class FluidState>
+    static auto mixingRatios_(const FluidState& fluidState, unsigned phaseIdx)
+    {
+        using Evaluation = std::remove_cv_t<std::remove_reference_t<decltype(fluidState.Rs())>>;
+        std::array<Evaluation, 2> result;
+        result[0] = 0.0;
+        result[1] = 0.0;
+        if (phaseIdx == oilPhaseIdx)
+            result[0] = fluidState.Rs();
+        else if (phaseIdx == gasPhaseIdx) {
+            result[0] = fluidState.Rv();
+            result[1] = fluidState.Rvw();
+        }
+        else if (phaseIdx == waterPhaseIdx)
+            result[0] = fluidState.Rsw();
+        return result;
+    }
+
+    template <class Evaluation>
+    static Evaluation expand_(const PvtEvaluation& cached,
+                              const Evaluation& dp,
+                              const Evaluation& dr0,
+                              const Evaluation& dr1)
+    {
+        Evaluation result = dp*cached.derivative(0);
+        result += dr0*cached.derivative(1);
+        result += dr1*cached.derivative(2);
+        result += cached.value();
+        return result;
+    }
+
+    static bool isClose_(Scalar value, Scalar reference, Scalar tolerance)
+    { return std::abs(value - reference) <= tolerance*std::abs(reference); }
+
+    template <class FluidState>
+    static unsigned presentPhases_(const FluidState& fluidState)
+    {
+        unsigned result = 0;
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+            if (FluidSystem::phaseIsActive(phaseIdx) &&
+                scalarValue(fluidState.saturation(phaseIdx)) > 0.0)
+                result |= 1u << phaseIdx;
+        return result;
+    }
+
+    template <class FluidState>
+    static Scalar saltConcentration_(const FluidState& fluidState)
+    {
+        if constexpr (enableBrine)
+            return scalarValue(fluidState.saltConcentration());
+        else
+            return 0.0;
+    }
+
+    template <class FluidState>
+    bool isReusable_(const Entry& entry, const FluidState& fluidState) const
+    {
+        if (!entry.valid ||
+            entry.pvtRegionIdx != fluidState.pvtRegionIndex() ||
+            entry.presentPhases != presentPhases_(fluidState))
+            return false;
+
+        // the temperature and the salt concentration are only expanded if they are
+        // primary variables
+        const Scalar temperature = scalarValue(fluidState.temperature(/*phaseIdx=*/0));
+        if (enableEnergy ? !isClose_(temperature, entry.temperature, tolerance_)
+                         : temperature != entry.temperature)
+            return false;
+        if (!isClose_(saltConcentration_(fluidState), entry.saltConcentration, tolerance_))
+            return false;
+
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (!FluidSystem::phaseIsActive(phaseIdx))
+                continue;
+
+            const PhaseEntry& phaseEntry = entry.phases[phaseIdx];
+            if (!isClose_(scalarValue(fluidState.pressure(phaseIdx)), phaseEntry.pressure, tolerance_))
+                return false;
+
+            const auto mixing = mixingRatios_(fluidState, phaseIdx);
+            for (unsigned i = 0; i < mixing.size(); ++i)
+                if (!isClose_(scalarValue(mixing[i]), phaseEntry.mixing[i], tolerance_))
+                    return false;
+        }
+
+        return true;
+    }
+
+    // evaluate the PVT properties at the current state using the PVT tables
+    template <class FluidState>
+    void update_(Entry& entry,
+                 const FluidState& fluidState,
+                 Scalar maxOilSaturation) const
+    {
+        const unsigned pvtRegionIdx = fluidState.pvtRegionIndex();
+        entry.valid = true;
+        entry.pvtRegionIdx = pvtRegionIdx;
+        entry.presentPhases = presentPhases_(fluidState);
+        entry.temperature = scalarValue(fluidState.temperature(/*phaseIdx=*/0));
+        entry.saltConcentration = saltConcentration_(fluidState);
+
+        // set up a fluid state which uses the pressure and the mixing ratios of each
+        // phase as the independent variables
+        PvtFluidState pvtFluidState;
+        pvtFluidState.setPvtRegionIndex(pvtRegionIdx);
+        if constexpr (enableEnergy)
+            pvtFluidState.setTemperature(PvtEvaluation::createVariable(entry.temperature, temperatureVarIdx));
+        else if constexpr (enableTemperature)
+            pvtFluidState.setTemperature(entry.temperature);
+        if constexpr (enableBrine)
+            pvtFluidState.setSaltConcentration(PvtEvaluation::createVariable(entry.saltConcentration, saltVarIdx));
+        if constexpr (compositionSwitchEnabled) {
+            pvtFluidState.setRs(PvtEvaluation::createVariable(scalarValue(fluidState.Rs()), 1));
+            pvtFluidState.setRv(PvtEvaluation::createVariable(scalarValue(fluidState.Rv()), 1));
+        }
+        if constexpr (enableVapwat)
+            pvtFluidState.setRvw(PvtEvaluation::createVariable(scalarValue(fluidState.Rvw()), 2));
+        if constexpr (has_disgas_in_water)
+            pvtFluidState.setRsw(PvtEvaluation::createVariable(scalarValue(fluidState.Rsw()), 1));
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (!FluidSystem::phaseIsActive(phaseIdx))
+                continue;
+            pvtFluidState.setSaturation(phaseIdx, scalarValue(fluidState.saturation(phaseIdx)));
+            pvtFluidState.setPressure(phaseIdx,
+                                      PvtEvaluation::createVariable(scalarValue(fluidState.pressure(phaseIdx)), 0));
+        }
+
+        typename FluidSystem::template ParameterCache<PvtEvaluation> paramCache;
+        paramCache.setRegionIndex(pvtRegionIdx);
+        if (FluidSystem::phaseIsActive(oilPhaseIdx))
+            paramCache.setMaxOilSat(maxOilSaturation);
+        paramCache.updateAll(pvtFluidState);
+
+        for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+            if (!FluidSystem::phaseIsActive(phaseIdx))
+                continue;
+
+            PhaseEntry& phaseEntry = entry.phases[phaseIdx];
+            phaseEntry.pressure = scalarValue(fluidState.pressure(phaseIdx));
+            const auto mixing = mixingRatios_(fluidState, phaseIdx);
+            phaseEntry.mixing = {scalarValue(mixing[0]), scalarValue(mixing[1])};
+            phaseEntry.invB = FluidSystem::inverseFormationVolumeFactor(pvtFluidState, phaseIdx, pvtRegionIdx);
+            phaseEntry.viscosity = FluidSystem::viscosity(pvtFluidState, paramCache, phaseIdx);
+        }
+    }
+
+    bool enabled_ = false;
+    bool exact_ = false;
+    Scalar tolerance_ = 0.0;
+    std::vector<Entry> entries_;
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,390 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \copydoc Opm::BlackOilSequentialSolver
+ */
+#ifndef EWOMS_BLACK_OIL_SEQUENTIAL_SOLVER_HH
+#define EWOMS_BLACK_OIL_SEQUENTIAL_SOLVER_HH
+
+#include <opm/models/blackoil/blackoilnewtonmethodparameters.hh>
+#include <opm/models/blackoil/blackoilproperties.hh>
+#include <opm/models/utils/parametersystem.hh>
+
+#include <opm/simulators/linalg/linalgproperties.hh>
+#include <opm/simulators/linalg/matrixblock.hh>
+#include <opm/simulators/linalg/reorderedblocksolver.hh>
+
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioners.hh>
+#include <dune/istl/solvers.hh>
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \ingroup BlackOilModel
+ *
+ * \brief Solves the linearized black-oil equations sequentially for the pressure and
+ *        for the transported quantities.
+ *
+ * Each cell's equations are combined to a pressure equation using quasi-IMPES
+ * weights, i.e., the weights w_i are given by D_ii^T w_i = e_p where D_ii is the
+ * diagonal block of the Jacobian and e_p is the unit vector of the pressure primary
+ * variable. The resulting scalar system is solved for the pressure update.
+ *
+ * In the transport stage, the pressure update is kept fixed. Its contribution is
+ * moved to the right hand side, the pressure is removed from the unknowns and the
+ * equation of each cell which has the largest weight is dropped. This results in a
+ * reduced system with (numEq - 1) x (numEq - 1) blocks for the transported
+ * quantities, which is assembled into a separate matrix. Since the remaining
+ * couplings between the cells follow the upwind directions, the transport system is
+ * by default solved by processing the cells in topological order (see
+ * Linear::ReorderedBlockSolver). If this does not converge, or if the reordering is
+ * disabled, the reduced system is solved by ILU0-preconditioned BiCGSTAB. The
+ * coupling between the two stages is resolved by the outer (Newton) iterations.
+ */
+template <class TypeTag>
+class BlackOilSequentialSolver
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Indices = GetPropType<TypeTag, Properties::Indices>;
+    using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>;
+    using GlobalEqVector = GetPropType<TypeTag, Properties::GlobalEqVector>;
+
+    static constexpr unsigned numEq = getPropValue<TypeTag, Properties::NumEq>();
+    static constexpr unsigned pressureIdx = Indices::pressureSwitchIdx;
+    static_assert(numEq > 1, "The sequential implicit strategy requires transported quantities");
+    static constexpr int numTransportEq = numEq - 1;
+
+    using Weights = Dune::FieldVector<Scalar, numEq>;
+    using PressureMatrix = Dune::BCRSMatrix<Dune::FieldMatrix<Scalar, 1, 1>>;
+    using PressureVector = Dune::BlockVector<Dune::FieldVector<Scalar, 1>>;
+    using TransportMatrix = Dune::BCRSMatrix<MatrixBlock<Scalar, numTransportEq, numTransportEq>>;
+    using TransportVector = Dune::BlockVector<Dune::FieldVector<Scalar, numTransportEq>>;
+    using TransportSolver = Linear::ReorderedBlockSolver<TransportMatrix, TransportVector>;
+
+public:
+    BlackOilSequentialSolver()
+    {
+        pressureTolerance_ = Parameters::Get<Parameters::SequentialPressureTolerance<Scalar>>();
+        pressureMaxIterations_ = Parameters::Get<Parameters::SequentialPressureMaxIterations>();
+        transportTolerance_ = Parameters::Get<Parameters::SequentialTransportTolerance<Scalar>>();
+        transportMaxIterations_ = Parameters::Get<Parameters::SequentialTransportMaxIterations>();
+        verbose_ = Parameters::Get<Parameters::SequentialVerbose>();
+        if (Parameters::Get<Parameters::SequentialReorderedTransport>())
+            transportSolver_ = std::make_unique<TransportSolver>(transportTolerance_,
+                                                                 transportMaxIterations_);
+    }
+
+    /*!
+     * \brief Register all run-time parameters of the sequential solution strategy.
+     */
+    static void registerParameters()
+    {
+        Parameters::Register<Parameters::SequentialPressureTolerance<Scalar>>
+            ("The relative residual reduction of the linear solver for the pressure "
+             "stage of the sequential implicit solution strategy");
+        Parameters::Register<Parameters::SequentialPressureMaxIterations>
+            ("The maximum number of linear iterations for the pressure stage of the "
+             "sequential implicit solution strategy");
+        Parameters::Register<Parameters::SequentialReorderedTransport>
+            ("Solve the transport stage of the sequential implicit solution strategy "
+             "by processing the cells in the order of the upwind directions");
+        Parameters::Register<Parameters::SequentialTransportTolerance<Scalar>>
+            ("The relative tolerance of the transport stage, i.e., of the Gauss-Seidel "
+             "iterations for cyclic dependencies of the reordered transport solver or "
+             "of the BiCGSTAB solver");
+        Parameters::Register<Parameters::SequentialTransportMaxIterations>
+            ("The maximum number of Gauss-Seidel iterations for cyclic dependencies "
+             "of the reordered transport solver or of BiCGSTAB iterations for the "
+             "transport stage");
+        Parameters::Register<Parameters::SequentialVerbose>
+            ("Print the iterations of the stages of the sequential implicit "
+             "solution strategy");
+    }
+
+    /*!
+     * \brief Compute the solution update of a linearized system of equations using
+     *        a pressure stage followed by a transport stage.
+     *
+     * \param jacobian The Jacobian matrix of the most recent linearization
+     * \param residual The residual of the most recent linearization
+     * \param solutionUpdate The vector which receives the update of the solution
+     * \return true if both stages converged
+     */
+    bool solve(const SparseMatrixAdapter& jacobian,
+               const GlobalEqVector& residual,
+               GlobalEqVector& solutionUpdate)
+    {
+        const auto& matrix = jacobian.istlMatrix();
+
+        computeWeights_(matrix);
+        if (!solvePressure_(matrix, residual))
+            return false;
+
+        assembleTransport_(matrix, residual);
+        if (!solveTransport_())
+            return false;
+
+        solutionUpdate.resize(matrix.N());
+        for (std::size_t cellIdx = 0; cellIdx < matrix.N(); ++cellIdx) {
+            auto& update = solutionUpdate[cellIdx];
+            update[pressureIdx] = pressureUpdate_[cellIdx][0];
+            for (unsigned k = 0; k < numTransportEq; ++k)
+                update[transportPvIdx_(k)] = transportUpdate_[cellIdx][k];
+        }
+
+        return true;
+    }
+
+private:
+    // compute the quasi-IMPES weights of all cells and choose the equation which is
+    // replaced by the pressure constraint in the transport stage
+    template <class Matrix>
+    void computeWeights_(const Matrix& matrix)
+    {
+        const std::size_t numCells = matrix.N();
+        weights_.resize(numCells);
+        replacedEq_.resize(numCells);
+
+        Weights unitPressure(0.0);
+        unitPressure[pressureIdx] = 1.0;
+        for (std::size_t cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+            const auto& diagBlock = matrix[cellIdx][cellIdx];
+            Dune::FieldMatrix<Scalar, numEq, numEq> diagBlockTransposed;
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                    diagBlockTransposed[pvIdx][eqIdx] = diagBlock[eqIdx][pvIdx];
+
+            auto& w = weights_[cellIdx];
+            diagBlockTransposed.solve(w, unitPressure);
+
+            // normalize the weights to make the pressure equations comparable
+            const Scalar maxWeight = w.infinity_norm();
+            w /= maxWeight;
+
+            unsigned eqIdx = 0;
+            for (unsigned i = 1; i < numEq; ++i)
+                if (std::abs(w[i]) > std::abs(w[eqIdx]))
+                    eqIdx = i;
+            replacedEq_[cellIdx] = eqIdx;
+        }
+    }
+
+    // (re-)create a matrix with the sparsity pattern of the Jacobian unless it already
+    // has it. the pattern is compared entry by entry because the number of rows and of
+    // non-zeros does not identify it, e.g., after the grid has been adapted.
+    template <class TargetMatrix, class Matrix>
+    static void updatePattern_(std::unique_ptr<TargetMatrix>& target, const Matrix& matrix)
+    {
+        if (target && samePattern_(*target, matrix))
+            return;
+
+        const std::size_t numCells = matrix.N();
+        target = std::make_unique<TargetMatrix>(numCells, numCells,
+                                                matrix.nonzeroes(),
+                                                TargetMatrix::row_wise);
+        auto srcRow = matrix.begin();
+        for (auto row = target->createbegin(); row != target->createend(); ++row, ++srcRow) {
+            for (auto col = srcRow->begin(); col != srcRow->end(); ++col)
+                row.insert(col.index());
+        }
+    }
+
+    template <class TargetMatrix, class Matrix>
+    static bool samePattern_(const TargetMatrix& target, const Matrix& matrix)
+    {
+        if (target.N() != matrix.N() || target.nonzeroes() != matrix.nonzeroes())
+            return false;
+
+        auto row = target.begin();
+        for (auto srcRow = matrix.begin(); srcRow != matrix.end(); ++srcRow, ++row) {
+            if (row->size() != srcRow->size())
+                return false;
+
+            auto col = row->begin();
+            for (auto srcCol = srcRow->begin(); srcCol != srcRow->end(); ++srcCol, ++col)
+                if (col.index() != srcCol.index())
+                    return false;
+        }
+
+        return true;
+    }
+
+    // assemble the pressure equations and solve them for the pressure update
+    template <class Matrix>
+    bool solvePressure_(const Matrix& matrix, const GlobalEqVector& residual)
+    {
+        const std::size_t numCells = matrix.N();
+        updatePattern_(pressureMatrix_, matrix);
+
+        pressureResidual_.resize(numCells);
+        pressureUpdate_.resize(numCells);
+        for (auto row = matrix.begin(); row != matrix.end(); ++row) {
+            const auto rowIdx = row.index();
+            const auto& w = weights_[rowIdx];
+            auto& pressureRow = (*pressureMatrix_)[rowIdx];
+            for (auto col = row->begin(); col != row->end(); ++col) {
+                Scalar value = 0.0;
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    value += w[eqIdx]*(*col)[eqIdx][pressureIdx];
+                pressureRow[col.index()] = value;
+            }
+            pressureResidual_[rowIdx] = w*residual[rowIdx];
+        }
+
+        using Operator = Dune::MatrixAdapter<PressureMatrix, PressureVector, PressureVector>;
+        Operator pressureOperator(*pressureMatrix_);
+        Dune::SeqILU<PressureMatrix, PressureVector, PressureVector> preconditioner(*pressureMatrix_, 1.0);
+        Dune::BiCGSTABSolver<PressureVector> solver(pressureOperator,
+                                                    preconditioner,
+                                                    pressureTolerance_,
+                                                    pressureMaxIterations_,
+                                                    /*verbose=*/0);
+
+        Dune::InverseOperatorResult result;
+        pressureUpdate_ = 0.0;
+        solver.apply(pressureUpdate_, pressureResidual_, result);
+
+        if (verbose_)
+            std::cout << "Sequential implicit: pressure stage took "
+                      << result.iterations << " iterations, reduction "
+                      << result.reduction << "\n" << std::flush;
+
+        return result.converged;
+    }
+
+    // the index of the primary variable which corresponds to an unknown of the
+    // transport system
+    static unsigned transportPvIdx_(unsigned k)
+    { return (k < pressureIdx) ? k : k + 1; }
+
+    // the index of the equation which corresponds to an equation of the transport
+    // system of a cell
+    unsigned transportEqIdx_(std::size_t cellIdx, unsigned k) const
+    { return (k < replacedEq_[cellIdx]) ? k : k + 1; }
+
+    // assemble the system of the transported quantities for a fixed pressure update.
+    // the pressure is no unknown of this system and the equation which is replaced by
+    // the pressure constraint is dropped.
+    template <class Matrix>
+    void assembleTransport_(const Matrix& matrix, const GlobalEqVector& residual)
+    {
+        const std::size_t numCells = matrix.N();
+        updatePattern_(transportMatrix_, matrix);
+
+        transportResidual_.resize(numCells);
+        transportUpdate_.resize(numCells);
+        for (auto row = matrix.begin(); row != matrix.end(); ++row) {
+            const auto rowIdx = row.index();
+            auto& rhs = transportResidual_[rowIdx];
+            for (unsigned i = 0; i < numTransportEq; ++i)
+                rhs[i] = residual[rowIdx][transportEqIdx_(rowIdx, i)];
+
+            auto transportCol = (*transportMatrix_)[rowIdx].begin();
+            for (auto col = row->begin(); col != row->end(); ++col, ++transportCol) {
+                const auto& block = *col;
+                auto& transportBlock = *transportCol;
+                const Scalar dp = pressureUpdate_[col.index()][0];
+                for (unsigned i = 0; i < numTransportEq; ++i) {
+                    const unsigned eqIdx = transportEqIdx_(rowIdx, i);
+                    rhs[i] -= block[eqIdx][pressureIdx]*dp;
+                    for (unsigned k = 0; k < numTransportEq; ++k)
+                        transportBlock[i][k] = block[eqIdx][transportPvIdx_(k)];
+                }
+            }
+        }
+    }
+
+    bool solveTransport_()
+    {
+        if (transportSolver_) {
+            transportSolver_->setMatrix(*transportMatrix_);
+            const bool converged = transportSolver_->solve(transportUpdate_, transportResidual_);
+            if (verbose_)
+                std::cout << "Sequential implicit: transport stage has "
+                          << transportSolver_->numComponents() << " components in "
+                          << transportSolver_->numLevels() << " levels, largest component: "
+                          << transportSolver_->maxComponentSize() << " cells"
+                          << (converged ? "" : ", not converged") << "\n" << std::flush;
+            if (converged)
+                return true;
+        }
+
+        using Operator = Dune::MatrixAdapter<TransportMatrix, TransportVector, TransportVector>;
+        Operator transportOperator(*transportMatrix_);
+        Dune::SeqILU<TransportMatrix, TransportVector, TransportVector> preconditioner(*transportMatrix_, 1.0);
+        Dune::BiCGSTABSolver<TransportVector> solver(transportOperator,
+                                                     preconditioner,
+                                                     transportTolerance_,
+                                                     transportMaxIterations_,
+                                                     /*verbose=*/0);
+
+        // the solver overwrites the right hand side
+        TransportVector rhs = transportResidual_;
+        Dune::InverseOperatorResult result;
+        transportUpdate_ = 0.0;
+        solver.apply(transportUpdate_, rhs, result);
+
+        if (verbose_)
+            std::cout << "Sequential implicit: transport stage took "
+                      << result.iterations << " iterations, reduction "
+                      << result.reduction << "\n" << std::flush;
+
+        return result.converged;
+    }
+
+    Scalar pressureTolerance_;
+    int pressureMaxIterations_;
+    Scalar transportTolerance_;
+    int transportMaxIterations_;
+    bool verbose_;
+
+    std::vector<Weights> weights_;
+    std::vector<unsigned> replacedEq_;
+
+    std::unique_ptr<PressureMatrix> pressureMatrix_;
+    PressureVector pressureResidual_;
+    PressureVector pressureUpdate_;
+    std::unique_ptr<TransportMatrix> transportMatrix_;
+    TransportVector transportResidual_;
+    TransportVector transportUpdate_;
+
+    // only set if the transport stage is solved by reordering
+    std::unique_ptr<TransportSolver> transportSolver_;
+};
+
+} // namespace Opm
+
+#endif
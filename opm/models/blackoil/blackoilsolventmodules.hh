@@ -727,6 +727,42 @@ public:
         return params_.tlMixParamDensity_[miscnumRegionIdx];
     }
 
+    /*!
+     * \brief The tables of the miscible solvent model of a MISCNUM region.
+     */
+    struct MiscibilityTables
+    {
+        const TabulatedFunction* misc;
+        const TabulatedFunction* pmisc;
+        const TabulatedFunction* sorwmis;
+        const TabulatedFunction* sgcwmis;
+        const TabulatedFunction* tlPMix;
+        Scalar tlMixParamViscosity;
+        Scalar tlMixParamDensity;
+    };
+
+    /*!
+     * \brief Returns all tables of the miscible solvent model which apply to a
+     *        degree of freedom.
+     *
+     * This only requires a single lookup of the MISCNUM region and is only valid for
+     * miscible runs.
+     */
+    static MiscibilityTables miscibilityTables(const ElementContext& elemCtx,
+                                               unsigned scvIdx,
+                                               unsigned timeIdx)
+    {
+        assert(isMiscible());
+        unsigned miscnumRegionIdx = elemCtx.problem().miscnumRegionIndex(elemCtx, scvIdx, timeIdx);
+        return MiscibilityTables{&params_.misc_[miscnumRegionIdx],
+                                 &params_.pmisc_[miscnumRegionIdx],
+                                 &params_.sorwmis_[miscnumRegionIdx],
+                                 &params_.sgcwmis_[miscnumRegionIdx],
+                                 &params_.tlPMixTable_[miscnumRegionIdx],
+                                 params_.tlMixParamViscosity_[miscnumRegionIdx],
+                                 params_.tlMixParamDensity_[miscnumRegionIdx]};
+    }
+
     static bool isMiscible()
     {
         return params_.isMiscible_;
@@ -860,10 +896,23 @@ public:
         if (solventSaturation().value() < cutOff)
             return;
 
-        // Pressure effects on capillary pressure miscibility
+        // look up the miscibility tables of the MISCNUM region and evaluate the ones
+        // which only depend on the pressure and on the water saturation once. Both are
+        // reused by effectiveProperties().
         if (SolventModule::isMiscible()) {
+            miscibilityTables_ = SolventModule::miscibilityTables(elemCtx, dofIdx, timeIdx);
             const Evaluation& p = FluidSystem::phaseIsActive(oilPhaseIdx)? fs.pressure(oilPhaseIdx) : fs.pressure(gasPhaseIdx);
-            const Evaluation pmisc = SolventModule::pmisc(elemCtx, dofIdx, timeIdx).eval(p, /*extrapolate=*/true);
+            pmisc_ = miscibilityTables_.pmisc->eval(p, /*extrapolate=*/true);
+            if (FluidSystem::phaseIsActive(waterPhaseIdx)) {
+                const Evaluation& sw = fs.saturation(waterPhaseIdx);
+                sorwmis_ = miscibilityTables_.sorwmis->eval(sw, /*extrapolate=*/true);
+                sgcwmis_ = miscibilityTables_.sgcwmis->eval(sw, /*extrapolate=*/true);
+            }
+        }
+
+        // Pressure effects on capillary pressure miscibility
+        if (SolventModule::isMiscible()) {
+            const Evaluation& pmisc = pmisc_;
             const Evaluation& pgImisc = fs.pressure(gasPhaseIdx);
 
             // compute capillary pressure for miscible fluid
@@ -896,10 +945,9 @@ public:
 
         // account for miscibility of oil and solvent
         if (SolventModule::isMiscible() && FluidSystem::phaseIsActive(oilPhaseIdx)) {
-            const auto& misc = SolventModule::misc(elemCtx, dofIdx, timeIdx);
-            const auto& pmisc = SolventModule::pmisc(elemCtx, dofIdx, timeIdx);
-            const Evaluation& p = FluidSystem::phaseIsActive(oilPhaseIdx)? fs.pressure(oilPhaseIdx) : fs.pressure(gasPhaseIdx);
-            const Evaluation miscibility = misc.eval(Fsolgas, /*extrapolate=*/true) * pmisc.eval(p, /*extrapolate=*/true);
+            // the oil pressure is not modified above, so the pressure dependent
+            // miscibility can be reused
+            const Evaluation miscibility = miscibilityTables_.misc->eval(Fsolgas, /*extrapolate=*/true) * pmisc_;
 
             // TODO adjust endpoints of sn and ssg
             unsigned cellIdx = elemCtx.globalSpaceIndex(dofIdx, timeIdx);
@@ -910,16 +958,12 @@ public:
             const Scalar& sogcr = scaledDrainageInfo.Sogcr;
             Evaluation sor = sogcr;
             if (FluidSystem::phaseIsActive(waterPhaseIdx)) {
-                const Evaluation& sw = fs.saturation(waterPhaseIdx);
-                const auto& sorwmis = SolventModule::sorwmis(elemCtx, dofIdx, timeIdx);
-                sor = miscibility * sorwmis.eval(sw,  /*extrapolate=*/true) + (1.0 - miscibility) * sogcr;
+                sor = miscibility * sorwmis_ + (1.0 - miscibility) * sogcr;
             }
             const Scalar& sgcr = scaledDrainageInfo.Sgcr;
             Evaluation sgc = sgcr;
             if (FluidSystem::phaseIsActive(waterPhaseIdx)) {
-                const Evaluation& sw = fs.saturation(waterPhaseIdx);
-                const auto& sgcwmis = SolventModule::sgcwmis(elemCtx, dofIdx, timeIdx);
-                sgc = miscibility * sgcwmis.eval(sw,  /*extrapolate=*/true) + (1.0 - miscibility) * sgcr;
+                sgc = miscibility * sgcwmis_ + (1.0 - miscibility) * sgcr;
             }
 
             Evaluation oilGasSolventSat = gasSolventSat;
@@ -967,9 +1011,9 @@ public:
      *
      * At this point the pressures and saturations of the fluid state are correct.
      */
-    void solventPvtUpdate_(const ElementContext& elemCtx,
-                           unsigned scvIdx,
-                           unsigned timeIdx)
+    void solventPvtUpdate_(const ElementContext&,
+                           unsigned,
+                           unsigned)
     {
         const auto& iq = asImp_();
         unsigned pvtRegionIdx = iq.pvtRegionIndex();
@@ -1024,7 +1068,7 @@ public:
         }   
 
         solventDensity_ = solventInvFormationVolumeFactor_*solventRefDensity_;
-        effectiveProperties(elemCtx, scvIdx, timeIdx);
+        effectiveProperties();
 
         solventMobility_ /= solventViscosity_;
 
@@ -1056,9 +1100,7 @@ public:
 private:
     // Computes the effective properties based on
     // Todd-Longstaff mixing model.
-    void effectiveProperties(const ElementContext& elemCtx,
-                             unsigned scvIdx,
-                             unsigned timeIdx)
+    void effectiveProperties()
     {
         if (!SolventModule::isMiscible())
             return;
@@ -1080,15 +1122,13 @@ private:
         Evaluation gasEffSat = fs.saturation(gasPhaseIdx);
         Evaluation solventEffSat = solventSaturation();
         if (FluidSystem::phaseIsActive(waterPhaseIdx)) {
-            const auto& sorwmis = SolventModule::sorwmis(elemCtx, scvIdx, timeIdx);
-            const auto& sgcwmis = SolventModule::sgcwmis(elemCtx, scvIdx, timeIdx);
+            // the residual saturations have been evaluated by solventPostSatFuncUpdate_()
             const Evaluation zero = 0.0;
-            const Evaluation& sw = fs.saturation(waterPhaseIdx);
             if (FluidSystem::phaseIsActive(oilPhaseIdx)) {
-                oilEffSat = std::max(oilEffSat - sorwmis.eval(sw,  /*extrapolate=*/true), zero);
+                oilEffSat = std::max(oilEffSat - sorwmis_, zero);
             }
-            gasEffSat = std::max(gasEffSat - sgcwmis.eval(sw,  /*extrapolate=*/true), zero);
-            solventEffSat = std::max(solventEffSat - sgcwmis.eval(sw,  /*extrapolate=*/true), zero);
+            gasEffSat = std::max(gasEffSat - sgcwmis_, zero);
+            solventEffSat = std::max(solventEffSat - sgcwmis_, zero);
         }
         const Evaluation oilGasSolventEffSat =  oilEffSat + gasEffSat + solventEffSat;
         const Evaluation oilSolventEffSat = oilEffSat + solventEffSat;
@@ -1100,11 +1140,14 @@ private:
         // The pressureMixingParameter represent the miscibility of the solvent while the mixingParameterViscosity the effect of the porous media.
         // The pressureMixingParameter is not implemented in ecl100.
         const Evaluation& p = FluidSystem::phaseIsActive(oilPhaseIdx)? fs.pressure(oilPhaseIdx) : fs.pressure(gasPhaseIdx);
-        // account for pressure effects
-        const auto& pmiscTable = SolventModule::pmisc(elemCtx, scvIdx, timeIdx);
-        const Evaluation pmisc = pmiscTable.eval(p, /*extrapolate=*/true);
-        const auto& tlPMixTable = SolventModule::tlPMixTable(elemCtx, scvIdx, timeIdx);
-        const Evaluation tlMixParamMu = SolventModule::tlMixParamViscosity(elemCtx, scvIdx, timeIdx) * tlPMixTable.eval(p,  /*extrapolate=*/true);
+        // account for pressure effects. Without an oil phase, the gas pressure has
+        // been modified after pmisc_ was evaluated.
+        const auto& tables = miscibilityTables_;
+        const Evaluation pmisc = FluidSystem::phaseIsActive(oilPhaseIdx)
+            ? pmisc_
+            : tables.pmisc->eval(p, /*extrapolate=*/true);
+        const Evaluation tlPMix = tables.tlPMix->eval(p,  /*extrapolate=*/true);
+        const Evaluation tlMixParamMu = tables.tlMixParamViscosity * tlPMix;
 
         const Evaluation& muGas = fs.viscosity(gasPhaseIdx);
         const Evaluation& muSolvent = solventViscosity_;
@@ -1151,7 +1194,7 @@ private:
         // Mixing parameter for density
         // The pressureMixingParameter represent the miscibility of the solvent while the mixingParameterDenisty the effect of the porous media.
         // The pressureMixingParameter is not implemented in ecl100.
-        const Evaluation tlMixParamRho = SolventModule::tlMixParamDensity(elemCtx, scvIdx, timeIdx) * tlPMixTable.eval(p,  /*extrapolate=*/true);
+        const Evaluation tlMixParamRho = tables.tlMixParamDensity * tlPMix;
 
         // compute effective viscosities for density calculations. These have to
         // be recomputed as a different mixing parameter may be used.
@@ -1262,6 +1305,13 @@ protected:
     Evaluation solventMobility_;
     Evaluation solventInvFormationVolumeFactor_;
 
+    // miscibility tables and table values shared by the saturation function and the
+    // PVT updates
+    typename SolventModule::MiscibilityTables miscibilityTables_;
+    Evaluation pmisc_;
+    Evaluation sorwmis_;
+    Evaluation sgcwmis_;
+
     Scalar solventRefDensity_;
 };
 
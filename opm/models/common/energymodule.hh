@@ -753,7 +753,6 @@ class EnergyExtensiveQuantities<TypeTag, /*enableEnergy=*/true>
     using GridView = GetPropType<TypeTag, Properties::GridView>;
 
     enum { dimWorld = GridView::dimensionworld };
-    using EvalDimVector = Dune::FieldVector<Evaluation, dimWorld>;
     using DimVector = Dune::FieldVector<Scalar, dimWorld>;
 
 protected:
@@ -766,18 +765,12 @@ protected:
         const auto& gradCalc = elemCtx.gradientCalculator();
         Opm::TemperatureCallback<TypeTag> temperatureCallback(elemCtx);
 
-        EvalDimVector temperatureGrad;
-        gradCalc.calculateGradient(temperatureGrad,
-                                   elemCtx,
-                                   faceIdx,
-                                   temperatureCallback);
-
-        // scalar product of temperature gradient and scvf normal
-        const auto& face = elemCtx.stencil(/*timeIdx=*/0).interiorFace(faceIdx);
-
-        temperatureGradNormal_ = 0;
-        for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx)
-            temperatureGradNormal_ += (face.normal()[dimIdx]*temperatureGrad[dimIdx]);
+        // scalar product of temperature gradient and scvf normal. only this is needed
+        // for the conductive heat flux, so the full gradient is not assembled.
+        gradCalc.calculateNormalGradient(temperatureGradNormal_,
+                                         elemCtx,
+                                         faceIdx,
+                                         temperatureCallback);
 
         const auto& extQuants = elemCtx.extensiveQuantities(faceIdx, timeIdx);
         const auto& intQuantsInside = elemCtx.intensiveQuantities(extQuants.interiorIndex(), timeIdx);
@@ -35,6 +35,9 @@ namespace Opm::Parameters {
 //! Returns whether gravity is considered in the problem.
 struct EnableGravity { static constexpr bool value = false; };
 
+//! Evaluate the spatial parameters of the problem once and store them per degree of freedom.
+struct EnableSpatialParameterStore { static constexpr bool value = false; };
+
 } // namespace Opm::Parameters
 
 #endif
@@ -33,6 +33,8 @@
 
 #include <dune/grid/common/partitionset.hh>
 
+#include <opm/common/Exceptions.hpp>
+
 #include <opm/material/fluidmatrixinteractions/NullMaterial.hpp>
 #include <opm/material/common/Means.hpp>
 #include <opm/material/densead/Evaluation.hpp>
@@ -46,6 +48,9 @@
 
 #include <opm/utility/CopyablePtr.hpp>
 
+#include <utility>
+#include <vector>
+
 namespace Opm {
 /*!
  * \ingroup Discretization
@@ -95,6 +100,35 @@ public:
 
         Parameters::Register<Parameters::EnableGravity>
             ("Use the gravity correction for the pressure gradients.");
+        Parameters::Register<Parameters::EnableSpatialParameterStore>
+            ("Evaluate the porosity, the permeability, the material law parameters and "
+             "the temperature of the problem only once and store them for each degree "
+             "of freedom. This requires them to be independent of time.");
+    }
+
+    /*!
+     * \brief Called by the simulator after the initial solution has been applied.
+     *
+     * If the spatial parameter store is enabled, this is the point where it is filled
+     * because the problem is fully initialized at this point.
+     */
+    void initialSolutionApplied()
+    {
+        ParentType::initialSolutionApplied();
+
+        if (enableSpatialParameterStore_)
+            updateSpatialParameterStore_();
+    }
+
+    /*!
+     * \brief Called by the simulator after the grid has been changed.
+     */
+    void gridChanged()
+    {
+        ParentType::gridChanged();
+
+        if (enableSpatialParameterStore_)
+            updateSpatialParameterStore_();
     }
 
     /*!
@@ -112,18 +146,89 @@ public:
                                            unsigned intersectionIdx,
                                            unsigned timeIdx) const
     {
-        const auto& scvf = context.stencil(timeIdx).interiorFace(intersectionIdx);
+        if (!faceIntrinsicPermeability_.empty()) {
+            const unsigned elemIdx = this->elementMapper().index(context.element());
+            result = faceIntrinsicPermeability_[faceOffset_[elemIdx] + intersectionIdx];
+            return;
+        }
 
+        const auto& scvf = context.stencil(timeIdx).interiorFace(intersectionIdx);
         const DimMatrix& K1 = asImp_().intrinsicPermeability(context, scvf.interiorIndex(), timeIdx);
         const DimMatrix& K2 = asImp_().intrinsicPermeability(context, scvf.exteriorIndex(), timeIdx);
+        harmonicMeanPermeability_(result, K1, K2);
+    }
 
-        // entry-wise harmonic mean. this is almost certainly wrong if
-        // you have off-main diagonal entries in your permeabilities!
-        for (unsigned i = 0; i < dimWorld; ++i)
-            for (unsigned j = 0; j < dimWorld; ++j)
-                result[i][j] = harmonicMean(K1[i][j], K2[i][j]);
+    /*!
+     * \name Stored spatial parameters
+     *
+     * These methods return the spatial parameters of a degree of freedom from the
+     * spatial parameter store. If the store is disabled or the problem does not
+     * implement the respective parameter, the problem's callback is used instead.
+     */
+    // \{
+
+    /*!
+     * \brief Returns the stored intrinsic permeability tensor of a degree of freedom.
+     *
+     * \copydetails intrinsicPermeability()
+     */
+    template <class Context>
+    const DimMatrix& storedIntrinsicPermeability(const Context& context,
+                                                 unsigned spaceIdx,
+                                                 unsigned timeIdx) const
+    {
+        if (intrinsicPermeability_.empty())
+            return asImp_().intrinsicPermeability(context, spaceIdx, timeIdx);
+        return intrinsicPermeability_[context.globalSpaceIndex(spaceIdx, timeIdx)];
+    }
+
+    /*!
+     * \brief Returns the stored porosity of a degree of freedom.
+     *
+     * \copydetails porosity()
+     */
+    template <class Context>
+    Scalar storedPorosity(const Context& context,
+                          unsigned spaceIdx,
+                          unsigned timeIdx) const
+    {
+        if (porosity_.empty())
+            return asImp_().porosity(context, spaceIdx, timeIdx);
+        return porosity_[context.globalSpaceIndex(spaceIdx, timeIdx)];
     }
 
+    /*!
+     * \brief Returns the stored material law parameters of a degree of freedom.
+     *
+     * \copydetails materialLawParams()
+     */
+    template <class Context>
+    const MaterialLawParams& storedMaterialLawParams(const Context& context,
+                                                     unsigned spaceIdx,
+                                                     unsigned timeIdx) const
+    {
+        if (materialLawParams_.empty())
+            return asImp_().materialLawParams(context, spaceIdx, timeIdx);
+        return *materialLawParams_[context.globalSpaceIndex(spaceIdx, timeIdx)];
+    }
+
+    /*!
+     * \brief Returns the stored temperature of a degree of freedom.
+     *
+     * \copydetails temperature()
+     */
+    template <class Context>
+    Scalar storedTemperature(const Context& context,
+                             unsigned spaceIdx,
+                             unsigned timeIdx) const
+    {
+        if (temperature_.empty())
+            return asImp_().temperature(context, spaceIdx, timeIdx);
+        return temperature_[context.globalSpaceIndex(spaceIdx, timeIdx)];
+    }
+
+    // \}
+
     /*!
      * \name Problem parameters
      */
@@ -142,7 +247,7 @@ public:
                                            unsigned,
                                            unsigned) const
     {
-        throw std::logic_error("Not implemented: Problem::intrinsicPermeability()");
+        throw NotImplemented("Not implemented: Problem::intrinsicPermeability()");
     }
 
     /*!
@@ -159,7 +264,7 @@ public:
                     unsigned,
                     unsigned) const
     {
-        throw std::logic_error("Not implemented: Problem::porosity()");
+        throw NotImplemented("Not implemented: Problem::porosity()");
     }
 
     /*!
@@ -177,7 +282,7 @@ public:
                       unsigned,
                       unsigned) const
     {
-        throw std::logic_error("Not implemented: Problem::solidEnergyParams()");
+        throw NotImplemented("Not implemented: Problem::solidEnergyParams()");
     }
 
     /*!
@@ -195,7 +300,7 @@ public:
                          unsigned,
                          unsigned) const
     {
-        throw std::logic_error("Not implemented: Problem::thermalConductionParams()");
+        throw NotImplemented("Not implemented: Problem::thermalConductionParams()");
     }
 
     /*!
@@ -211,7 +316,7 @@ public:
                       unsigned,
                       unsigned) const
     {
-        throw std::logic_error("Not implemented: Problem::tortuosity()");
+        throw NotImplemented("Not implemented: Problem::tortuosity()");
     }
 
     /*!
@@ -227,7 +332,7 @@ public:
                         unsigned,
                         unsigned) const
     {
-        throw std::logic_error("Not implemented: Problem::dispersivity()");
+        throw NotImplemented("Not implemented: Problem::dispersivity()");
     }
 
     /*!
@@ -282,7 +387,7 @@ public:
      * no energy equation is to be used.
      */
     Scalar temperature() const
-    { throw std::logic_error("Not implemented:temperature() method not implemented by the actual problem"); }
+    { throw NotImplemented("Not implemented:temperature() method not implemented by the actual problem"); }
 
 
     /*!
@@ -401,7 +506,123 @@ private:
         if (Parameters::Get<Parameters::EnableGravity>()) {
             gravity_[dimWorld-1]  = -9.81;
         }
+
+        enableSpatialParameterStore_ = Parameters::Get<Parameters::EnableSpatialParameterStore>();
+    }
+
+    static void harmonicMeanPermeability_(DimMatrix& result,
+                                          const DimMatrix& K1,
+                                          const DimMatrix& K2)
+    {
+        // entry-wise harmonic mean. this is almost certainly wrong if
+        // you have off-main diagonal entries in your permeabilities!
+        for (unsigned i = 0; i < dimWorld; ++i)
+            for (unsigned j = 0; j < dimWorld; ++j)
+                result[i][j] = harmonicMean(K1[i][j], K2[i][j]);
+    }
+
+    // evaluate the spatial parameter callbacks of the problem for all degrees of
+    // freedom. parameters which are not implemented by the problem, i.e. whose
+    // callback throws NotImplemented, are not stored. all other errors propagate.
+    void updateSpatialParameterStore_()
+    {
+        porosity_.clear();
+        intrinsicPermeability_.clear();
+        materialLawParams_.clear();
+        temperature_.clear();
+        faceOffset_.clear();
+        faceIntrinsicPermeability_.clear();
+
+        const std::size_t numDof = this->model().numGridDof();
+        std::vector<Scalar> porosity(numDof);
+        std::vector<DimMatrix> intrinsicPermeability(numDof);
+        std::vector<const MaterialLawParams*> materialLawParams(numDof);
+        std::vector<Scalar> temperature(numDof);
+        bool hasPorosity = true;
+        bool hasIntrinsicPermeability = true;
+        bool hasTemperature = true;
+
+        const auto& gridView = this->gridView();
+        std::vector<unsigned> faceOffset(gridView.size(/*codim=*/0) + 1, 0);
+
+        ElementContext elemCtx(this->simulator());
+        for (const auto& elem : elements(gridView)) {
+            elemCtx.updateStencil(elem);
+
+            const unsigned elemIdx = this->elementMapper().index(elem);
+            faceOffset[elemIdx + 1] = elemCtx.numInteriorFaces(/*timeIdx=*/0);
+
+            for (unsigned dofIdx = 0; dofIdx < elemCtx.numPrimaryDof(/*timeIdx=*/0); ++dofIdx) {
+                const unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+
+                materialLawParams[globalIdx] = &asImp_().materialLawParams(elemCtx, dofIdx, /*timeIdx=*/0);
+                if (hasPorosity) {
+                    try {
+                        porosity[globalIdx] = asImp_().porosity(elemCtx, dofIdx, /*timeIdx=*/0);
+                    }
+                    catch (const NotImplemented&) {
+                        hasPorosity = false;
+                    }
+                }
+                if (hasIntrinsicPermeability) {
+                    try {
+                        intrinsicPermeability[globalIdx] =
+                            asImp_().intrinsicPermeability(elemCtx, dofIdx, /*timeIdx=*/0);
+                    }
+                    catch (const NotImplemented&) {
+                        hasIntrinsicPermeability = false;
+                    }
+                }
+                if (hasTemperature) {
+                    try {
+                        temperature[globalIdx] = asImp_().temperature(elemCtx, dofIdx, /*timeIdx=*/0);
+                    }
+                    catch (const NotImplemented&) {
+                        hasTemperature = false;
+                    }
+                }
+            }
+        }
+
+        // the harmonic means of the permeabilities of the faces of each element
+        if (hasIntrinsicPermeability) {
+            for (std::size_t elemIdx = 1; elemIdx < faceOffset.size(); ++elemIdx)
+                faceOffset[elemIdx] += faceOffset[elemIdx - 1];
+
+            faceIntrinsicPermeability_.resize(faceOffset.back());
+            for (const auto& elem : elements(gridView)) {
+                elemCtx.updateStencil(elem);
+
+                const auto& stencil = elemCtx.stencil(/*timeIdx=*/0);
+                const unsigned offset = faceOffset[this->elementMapper().index(elem)];
+                for (unsigned faceIdx = 0; faceIdx < stencil.numInteriorFaces(); ++faceIdx) {
+                    const auto& scvf = stencil.interiorFace(faceIdx);
+                    harmonicMeanPermeability_(faceIntrinsicPermeability_[offset + faceIdx],
+                                              intrinsicPermeability[stencil.globalSpaceIndex(scvf.interiorIndex())],
+                                              intrinsicPermeability[stencil.globalSpaceIndex(scvf.exteriorIndex())]);
+                }
+            }
+            faceOffset_ = std::move(faceOffset);
+            intrinsicPermeability_ = std::move(intrinsicPermeability);
+        }
+
+        materialLawParams_ = std::move(materialLawParams);
+        if (hasPorosity)
+            porosity_ = std::move(porosity);
+        if (hasTemperature)
+            temperature_ = std::move(temperature);
     }
+
+    bool enableSpatialParameterStore_;
+
+    // the spatial parameter store, indexed by the global index of the degrees of
+    // freedom respectively by the face offset of the element plus the face index
+    std::vector<Scalar> porosity_;
+    std::vector<DimMatrix> intrinsicPermeability_;
+    std::vector<const MaterialLawParams*> materialLawParams_;
+    std::vector<Scalar> temperature_;
+    std::vector<unsigned> faceOffset_;
+    std::vector<DimMatrix> faceIntrinsicPermeability_;
 };
 
 } // namespace Opm
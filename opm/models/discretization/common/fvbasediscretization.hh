@@ -55,7 +55,9 @@
 
 #include <opm/models/io/vtkprimaryvarsmodule.hh>
 
+#include <opm/models/parallel/firsttouchallocator.hh>
 #include <opm/models/parallel/gridcommhandles.hh>
+#include <opm/models/parallel/threadedentityiterator.hh>
 #include <opm/models/parallel/threadmanager.hh>
 
 #include <opm/models/utils/alignedallocator.hh>
@@ -67,9 +69,12 @@
 #include <opm/simulators/linalg/nullborderlistmanager.hh>
 
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <exception>
 #include <limits>
 #include <list>
+#include <mutex>
 #include <stdexcept>
 #include <sstream>
 #include <string>
@@ -328,7 +333,9 @@ class FvBaseDiscretization
         historySize = getPropValue<TypeTag, Properties::TimeDiscHistorySize>(),
     };
 
-    using IntensiveQuantitiesVector = std::vector<IntensiveQuantities, aligned_allocator<IntensiveQuantities, alignof(IntensiveQuantities)> >;
+    using IntensiveQuantitiesVector =
+        std::vector<IntensiveQuantities,
+                    FirstTouchAllocator<aligned_allocator<IntensiveQuantities, alignof(IntensiveQuantities)>>>;
 
     using Element = typename GridView::template Codim<0>::Entity;
     using ElementIterator = typename GridView::template Codim<0>::Iterator;
@@ -545,6 +552,9 @@ public:
     /*!
      * \brief Applies the initial solution for all degrees of freedom to which the model
      *        applies.
+     *
+     * The elements are processed by all threads, so the initial() method of the problem
+     * may be called concurrently.
      */
     void applyInitialSolution()
     {
@@ -552,32 +562,58 @@ public:
         SolutionVector& uCur = asImp_().solution(/*timeIdx=*/0);
         uCur = Scalar(0.0);
 
-        ElementContext elemCtx(simulator_);
-
-        // iterate through the grid and evaluate the initial condition
-        for (const auto& elem : elements(gridView_)) {
-            // ignore everything which is not in the interior if the
-            // current process' piece of the grid
-            if (elem.partitionType() != Dune::InteriorEntity)
-                continue;
-
-            // deal with the current element
-            elemCtx.updateStencil(elem);
+        // the DOFs of some discretizations are shared by several elements. these are
+        // assigned by the first thread which encounters them.
+        std::vector<std::atomic<bool>> dofAssigned(uCur.size());
 
-            // loop over all element vertices, i.e. sub control volumes
-            for (unsigned dofIdx = 0; dofIdx < elemCtx.numPrimaryDof(/*timeIdx=*/0); dofIdx++)
-            {
-                // map the local degree of freedom index to the global one
-                unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
 
-                // let the problem do the dirty work of nailing down
-                // the initial solution.
-                simulator_.problem().initial(uCur[globalIdx], elemCtx, dofIdx, /*timeIdx=*/0);
-                asImp_().supplementInitialSolution_(uCur[globalIdx], elemCtx, dofIdx, /*timeIdx=*/0);
-                uCur[globalIdx].checkDefined();
+        // iterate through the grid and evaluate the initial condition
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            ElementContext elemCtx(simulator_);
+            ElementIterator elemIt = threadedElemIt.beginParallel();
+            try {
+                for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                    // ignore everything which is not in the interior if the
+                    // current process' piece of the grid
+                    const Element& elem = *elemIt;
+                    if (elem.partitionType() != Dune::InteriorEntity)
+                        continue;
+
+                    // deal with the current element
+                    elemCtx.updateStencil(elem);
+
+                    // loop over all element vertices, i.e. sub control volumes
+                    for (unsigned dofIdx = 0; dofIdx < elemCtx.numPrimaryDof(/*timeIdx=*/0); dofIdx++)
+                    {
+                        // map the local degree of freedom index to the global one
+                        unsigned globalIdx = elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0);
+                        if (dofAssigned[globalIdx].exchange(true))
+                            continue;
+
+                        // let the problem do the dirty work of nailing down
+                        // the initial solution.
+                        simulator_.problem().initial(uCur[globalIdx], elemCtx, dofIdx, /*timeIdx=*/0);
+                        asImp_().supplementInitialSolution_(uCur[globalIdx], elemCtx, dofIdx, /*timeIdx=*/0);
+                        uCur[globalIdx].checkDefined();
+                    }
+                }
+            }
+            catch (...) {
+                std::lock_guard<std::mutex> take(exceptionLock);
+                exceptionPtr = std::current_exception();
+                threadedElemIt.setFinished();
             }
         }
 
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+
         // synchronize the ghost DOFs (if necessary)
         asImp_().syncOverlap();
 
@@ -1300,6 +1336,8 @@ public:
         updateTimer_ += newtonMethod_.updateTimer();
 
         prePostProcessTimer_.start();
+        if (converged)
+            converged = asImp_().updateConverged();
         if (converged)
             asImp_().updateSuccessful();
         else
@@ -1338,6 +1376,18 @@ public:
     void updateBegin()
     { }
 
+    /*!
+     * \brief Called by the update() method after the Newton method has converged.
+     *
+     * Models can overload this hook to apply operators which are split from the
+     * Newton method to the converged solution.
+     *
+     * \return false if the update failed nevertheless. updateFailed() is then called
+     *         instead of updateSuccessful().
+     */
+    bool updateConverged()
+    { return true; }
+
     /*!
      * \brief Called by the update() method if it was
      *        successful.
@@ -245,6 +245,64 @@ public:
         }
     }
 
+    /*!
+     * \brief Calculates the scalar product of the gradient of an arbitrary quantity
+     *        and the normal of a flux approximation point.
+     *
+     * For the two-point approximation this is the difference of the quantity at the
+     * two degrees of freedom times the geometric factor (d*n)/|d|^2, where d is the
+     * vector between the centers of the sub-control volumes. This avoids assembling
+     * the gradient vector if only its normal component is required.
+     *
+     * \param elemCtx The current execution context
+     * \param fapIdx The local index of the flux approximation point
+     *               in the current element's stencil.
+     * \param quantityCallback A callable object returning the value
+     *               of the quantity given the index of a degree of
+     *               freedom
+     */
+    template <class QuantityCallback>
+    void calculateNormalGradient(Evaluation& quantityGradNormal,
+                                 const ElementContext& elemCtx,
+                                 unsigned fapIdx,
+                                 const QuantityCallback& quantityCallback) const
+    {
+        const auto& stencil = elemCtx.stencil(/*timeIdx=*/0);
+        const auto& face = stencil.interiorFace(fapIdx);
+        const auto& normal = face.normal();
+
+        auto i = face.interiorIndex();
+        auto j = face.exteriorIndex();
+        auto focusIdx = elemCtx.focusDofIndex();
+
+        const auto& interiorPos = stencil.subControlVolume(i).globalPos();
+        const auto& exteriorPos = stencil.subControlVolume(j).globalPos();
+
+        Scalar distSquared = 0.0;
+        Scalar distNormal = 0.0;
+        for (unsigned dimIdx = 0; dimIdx < dimWorld; ++dimIdx) {
+            Scalar tmp = exteriorPos[dimIdx] - interiorPos[dimIdx];
+            distSquared += tmp*tmp;
+            distNormal += tmp*normal[dimIdx];
+        }
+        const Scalar factor = distNormal/distSquared;
+
+        if (i == focusIdx) {
+            quantityGradNormal =
+                (getValue(quantityCallback(j))
+                 - quantityCallback(i))*factor;
+        }
+        else if (j == focusIdx) {
+            quantityGradNormal =
+                (quantityCallback(j)
+                 - getValue(quantityCallback(i)))*factor;
+        }
+        else
+            quantityGradNormal =
+                (getValue(quantityCallback(j))
+                 - getValue(quantityCallback(i)))*factor;
+    }
+
     /*!
      * \brief Calculates the value of an arbitrary quantity at any
      *        flux approximation point on the grid boundary.
@@ -36,9 +36,12 @@
 #include <opm/grid/utility/SparseTable.hpp>
 
 #include <opm/models/parallel/gridcommhandles.hh>
+#include <opm/models/parallel/mpiutil.hh>
 #include <opm/models/parallel/threadmanager.hh>
 #include <opm/models/parallel/threadedentityiterator.hh>
 #include <opm/models/discretization/common/baseauxiliarymodule.hh>
+#include <opm/models/discretization/common/fvbaseparameters.hh>
+#include <opm/models/utils/parametersystem.hh>
 
 #include <dune/common/version.hh>
 #include <dune/common/fvector.hh>
@@ -48,7 +51,12 @@
 #include <iostream>
 #include <vector>
 #include <thread>
+#include <map>
 #include <set>
+#include <utility>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <exception>   // current_exception, rethrow_exception
 #include <mutex>
 
@@ -131,7 +139,11 @@ public:
      * \brief Register all run-time parameters for the Jacobian linearizer.
      */
     static void registerParameters()
-    { }
+    {
+        Parameters::Register<Parameters::LinearizeBorderFirst>
+            ("Linearize the elements which contribute to the matrix rows shared with "
+             "peer processes first and start their communication early.");
+    }
 
     /*!
      * \brief Initialize the linearizer.
@@ -153,6 +165,18 @@ public:
         }
         elementCtx_.resize(0);
         fullDomain_ = std::make_unique<FullDomain>(simulator.gridView());
+        borderFirst_ = Parameters::Get<Parameters::LinearizeBorderFirst>();
+
+        // the communication is started from within a parallel region, which requires
+        // MPI to be initialized with at least MPI_THREAD_FUNNELED. otherwise, the
+        // synchronous path is used.
+        if (borderFirst_ && ThreadManager::maxThreads() > 1 && !mpiSupportsFunneledThreads()) {
+            if (simulator.gridView().comm().rank() == 0)
+                std::cerr << "Warning: The MPI library does not support calls from the "
+                          << "master thread of a parallel region (MPI_THREAD_FUNNELED). "
+                          << "Linearizing the border elements first is disabled.\n";
+            borderFirst_ = false;
+        }
     }
 
     /*!
@@ -165,6 +189,12 @@ public:
     void eraseMatrix()
     {
         jacobian_.reset();
+        elementBlockOffset_.clear();
+        elementBlocks_.clear();
+        colorElements_.clear();
+        borderElements_.clear();
+        remainingElements_.clear();
+        elementListsValid_ = false;
     }
 
     /*!
@@ -217,7 +247,9 @@ public:
 
         int succeeded;
         try {
-            linearize_(domain);
+            linearizedBorderFirst_ = linearizeBorderFirst_(domain);
+            if (!linearizedBorderFirst_)
+                linearize_(domain);
             succeeded = 1;
         }
         catch (const std::exception& e)
@@ -240,6 +272,13 @@ public:
             throw NumericalProblem("A process did not succeed in linearizing the system");
     }
 
+    /*!
+     * \brief Returns true if the border elements were linearized first by the most
+     *        recent linearization of the domain.
+     */
+    bool linearizedBorderFirst() const
+    { return linearizedBorderFirst_; }
+
     void finalize()
     { jacobian_->finalize(); }
 
@@ -255,8 +294,13 @@ public:
 
         auto& model = model_();
         const auto& comm = simulator_().gridView().comm();
+        if (model.numAuxiliaryModules() == 0)
+            return;
+
+        // the auxiliary modules are independent of each other, so a single reduction
+        // is sufficient to find out whether all of them succeeded
+        bool succeeded = true;
         for (unsigned auxModIdx = 0; auxModIdx < model.numAuxiliaryModules(); ++auxModIdx) {
-            bool succeeded = true;
             try {
                 model.auxiliaryModule(auxModIdx)->linearize(*jacobian_, residual_);
             }
@@ -267,12 +311,12 @@ public:
                           << " caught an exception while linearizing:" << e.what()
                           << "\n"  << std::flush;
             }
+        }
 
-            succeeded = comm.min(succeeded);
+        succeeded = comm.min(succeeded);
 
-            if (!succeeded)
-                throw NumericalProblem("linearization of an auxiliary equation failed");
-        }
+        if (!succeeded)
+            throw NumericalProblem("linearization of an auxiliary equation failed");
     }
 
     /*!
@@ -418,26 +462,55 @@ private:
     void createMatrix_()
     {
         const auto& model = model_();
-        Stencil stencil(gridView_(), model_().dofMapper());
 
         // for the main model, find out the global indices of the neighboring degrees of
-        // freedom of each primary degree of freedom
-        sparsityPattern_.clear();
-        sparsityPattern_.resize(model.numTotalDof());
-
-        for (const auto& elem : elements(gridView_())) {
-            stencil.update(elem);
+        // freedom of each primary degree of freedom. each thread first collects the
+        // connections of its elements, sorted into buckets of contiguous row ranges...
+        using Connection = std::pair<unsigned, unsigned>;
+        const std::size_t numRows = model.numTotalDof();
+        const std::size_t numChunks = ThreadManager::maxThreads();
+        // the rows [numRows*i/numChunks, numRows*(i + 1)/numChunks) form the i-th range
+        const auto chunkOfRow = [numRows, numChunks](std::size_t rowIdx)
+        { return ((rowIdx + 1)*numChunks - 1)/numRows; };
+
+        std::vector<std::vector<std::vector<Connection>>>
+            threadConnections(numChunks, std::vector<std::vector<Connection>>(numChunks));
+        ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_());
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        {
+            Stencil stencil(gridView_(), model_().dofMapper());
+            auto& buckets = threadConnections[ThreadManager::threadId()];
+            ElementIterator elemIt = threadedElemIt.beginParallel();
+            for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
+                stencil.update(*elemIt);
 
-            for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
-                unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
+                for (unsigned primaryDofIdx = 0; primaryDofIdx < stencil.numPrimaryDof(); ++primaryDofIdx) {
+                    unsigned myIdx = stencil.globalSpaceIndex(primaryDofIdx);
+                    auto& connections = buckets[chunkOfRow(myIdx)];
 
-                for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
-                    unsigned neighborIdx = stencil.globalSpaceIndex(dofIdx);
-                    sparsityPattern_[myIdx].insert(neighborIdx);
+                    for (unsigned dofIdx = 0; dofIdx < stencil.numDof(); ++dofIdx) {
+                        unsigned neighborIdx = stencil.globalSpaceIndex(dofIdx);
+                        connections.emplace_back(myIdx, neighborIdx);
+                    }
                 }
             }
         }
 
+        // ... and then each thread inserts the connections of the buckets of one row
+        // range into the sparsity pattern
+        sparsityPattern_.clear();
+        sparsityPattern_.resize(numRows);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (int chunkIdx = 0; chunkIdx < static_cast<int>(numChunks); ++chunkIdx) {
+            for (const auto& buckets : threadConnections)
+                for (const auto& [rowIdx, colIdx] : buckets[chunkIdx])
+                    sparsityPattern_[rowIdx].insert(colIdx);
+        }
+
         // add the additional neighbors and degrees of freedom caused by the auxiliary
         // equations
         size_t numAuxMod = model.numAuxiliaryModules();
@@ -449,6 +522,86 @@ private:
 
         // create matrix structure based on sparsity pattern
         jacobian_->reserve(sparsityPattern_);
+
+        updateElementBlocks_();
+    }
+
+    // Determine the addresses of the matrix blocks to which each element contributes,
+    // so that the local Jacobians can be added to the global matrix without searching
+    // the matrix rows. If the elements share primary degrees of freedom, they are also
+    // grouped into colors, i.e., sets of elements which can be linearized concurrently
+    // without locking the global matrix.
+    void updateElementBlocks_()
+    {
+        const auto& elemMapper = elementMapper_();
+        const std::size_t numElems = gridView_().size(/*codim=*/0);
+        elementBlockOffset_.assign(numElems + 1, 0);
+        elementBlocks_.clear();
+        colorElements_.clear();
+
+        // the blocks of an element are ordered by the local index of the row DOF first
+        // and by the local index of the primary DOF second
+        Stencil stencil(gridView_(), dofMapper_());
+        for (const auto& elem : elements(gridView_())) {
+            stencil.update(elem);
+            const unsigned elemIdx = elemMapper.index(elem);
+            const unsigned numDof = stencil.numDof();
+            const unsigned numPrimaryDof = stencil.numPrimaryDof();
+            elementBlockOffset_[elemIdx + 1] = numDof*numPrimaryDof;
+        }
+        for (std::size_t elemIdx = 0; elemIdx < numElems; ++elemIdx)
+            elementBlockOffset_[elemIdx + 1] += elementBlockOffset_[elemIdx];
+        elementBlocks_.resize(elementBlockOffset_.back());
+
+        // greedy coloring, at most 64 colors are considered. if more are required, the
+        // elements are linearized in the conventional way.
+        constexpr unsigned maxColors = 64;
+        const bool colorElements = getPropValue<TypeTag, Properties::UseLinearizationLock>();
+        std::vector<std::uint64_t> dofColors(colorElements ? model_().numTotalDof() : 0, 0);
+        bool colorsExhausted = false;
+
+        for (const auto& elem : elements(gridView_())) {
+            stencil.update(elem);
+            const unsigned elemIdx = elemMapper.index(elem);
+            const unsigned numDof = stencil.numDof();
+            const unsigned numPrimaryDof = stencil.numPrimaryDof();
+            MatrixBlock** blocks = elementBlocks_.data() + elementBlockOffset_[elemIdx];
+            for (unsigned dofIdx = 0; dofIdx < numDof; ++dofIdx) {
+                const unsigned globJ = stencil.globalSpaceIndex(dofIdx);
+                for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++primaryDofIdx) {
+                    const unsigned globI = stencil.globalSpaceIndex(primaryDofIdx);
+                    blocks[dofIdx*numPrimaryDof + primaryDofIdx] = jacobian_->blockAddress(globJ, globI);
+                }
+            }
+
+            if (!colorElements || colorsExhausted)
+                continue;
+            if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
+                continue;
+
+            // two elements conflict if they write the residual and matrix columns of
+            // the same primary degree of freedom
+            std::uint64_t usedColors = 0;
+            for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++primaryDofIdx)
+                usedColors |= dofColors[stencil.globalSpaceIndex(primaryDofIdx)];
+
+            unsigned colorIdx = 0;
+            while (colorIdx < maxColors && (usedColors & (std::uint64_t{1} << colorIdx)))
+                ++colorIdx;
+            if (colorIdx == maxColors) {
+                colorsExhausted = true;
+                continue;
+            }
+
+            for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++primaryDofIdx)
+                dofColors[stencil.globalSpaceIndex(primaryDofIdx)] |= std::uint64_t{1} << colorIdx;
+            if (colorElements_.size() <= colorIdx)
+                colorElements_.resize(colorIdx + 1);
+            colorElements_[colorIdx].push_back(elem);
+        }
+
+        if (colorsExhausted)
+            colorElements_.clear();
     }
 
     // reset the global linear system of equations.
@@ -469,6 +622,10 @@ private:
 
         constraintsMap_.clear();
 
+        // the constraints are collected by each thread separately, because
+        // std::map cannot be modified concurrently
+        std::vector<std::map<unsigned, Constraints>> threadConstraints(ThreadManager::maxThreads());
+
         // loop over all elements...
         ThreadedEntityIterator<GridView, /*codim=*/0> threadedElemIt(gridView_());
 #ifdef _OPENMP
@@ -476,6 +633,7 @@ private:
 #endif
         {
             unsigned threadId = ThreadManager::threadId();
+            auto& constraintsMap = threadConstraints[threadId];
             ElementIterator elemIt = threadedElemIt.beginParallel();
             for (; !threadedElemIt.isFinished(elemIt); elemIt = threadedElemIt.increment()) {
                 // create an element context (the solution-based quantities are not
@@ -497,12 +655,15 @@ private:
                                                   /*timeIdx=*/0);
                     if (constraints.isActive()) {
                         unsigned globI = elemCtx.globalSpaceIndex(primaryDofIdx, /*timeIdx=*/0);
-                        constraintsMap_[globI] = constraints;
+                        constraintsMap[globI] = constraints;
                         continue;
                     }
                 }
             }
         }
+
+        for (auto& constraintsMap : threadConstraints)
+            constraintsMap_.merge(constraintsMap);
     }
 
     // linearize the whole or part of the system
@@ -523,6 +684,14 @@ private:
 
         applyConstraintsToSolution_();
 
+        if constexpr (std::is_same_v<SubDomainType, FullDomain>) {
+            if (!colorElements_.empty()) {
+                linearizeColored_();
+                applyConstraintsToLinearization_();
+                return;
+            }
+        }
+
         // to avoid a race condition if two threads handle an exception at the same time,
         // we use an explicit lock to control access to the exception storage object
         // amongst thread-local handlers
@@ -590,9 +759,171 @@ private:
     }
 
 
+    // linearize the elements color by color. the elements of a color do not share any
+    // primary degree of freedom, so the global matrix does not need to be locked.
+    void linearizeColored_()
+    {
+        std::mutex exceptionLock;
+        std::exception_ptr exceptionPtr = nullptr;
+        std::atomic<bool> failed{false};
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+        for (const auto& elems : colorElements_) {
+            const int numElems = elems.size();
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+            for (int i = 0; i < numElems; ++i) {
+                if (failed)
+                    continue;
+                try {
+                    if (i + 1 < numElems) {
+                        model_().prefetch(elems[i + 1]);
+                        problem_().prefetch(elems[i + 1]);
+                    }
+                    linearizeElement_(elems[i], /*lockMatrix=*/false);
+                }
+                catch (...) {
+                    std::lock_guard<std::mutex> take(exceptionLock);
+                    exceptionPtr = std::current_exception();
+                    failed = true;
+                }
+            }
+        }
+
+        if (exceptionPtr)
+            std::rethrow_exception(exceptionPtr);
+    }
+
+    // linearize the elements which contribute to the matrix rows that are sent to the
+    // peer processes first and let the linear solver start their communication before
+    // the remaining elements are linearized. returns false if this is not possible.
+    template <class SubDomainType>
+    bool linearizeBorderFirst_(const SubDomainType&)
+    {
+        if constexpr (!std::is_same_v<SubDomainType, FullDomain>)
+            return false;
+        else {
+            auto& linearSolver = model_().newtonMethod().linearSolver();
+            using LinearSolver = std::decay_t<decltype(linearSolver)>;
+            if constexpr (!HasEarlyMatrixSync_<LinearSolver>::value)
+                return false;
+            else {
+                // constraints and auxiliary equations modify the matrix rows after the
+                // elements have been linearized
+                const auto* sentRows = linearSolver.sentMatrixRows();
+                if (!borderFirst_
+                    || !sentRows
+                    || enableConstraints_()
+                    || model_().numAuxiliaryModules() > 0)
+                {
+                    // make sure that the linear solver does not use the rows of a
+                    // linearization which has not been solved
+                    if (sentRows)
+                        linearSolver.cancelMatrixSync();
+                    return false;
+                }
+
+                if (!elementListsValid_)
+                    updateBorderElements_(*sentRows);
+
+                std::mutex exceptionLock;
+                std::exception_ptr exceptionPtr = nullptr;
+                std::atomic<bool> failed{false};
+                auto linearizeElement = [&](const std::vector<Element>& elems, int i) {
+                    if (failed)
+                        return;
+                    try {
+                        if (i + 1 < static_cast<int>(elems.size())) {
+                            model_().prefetch(elems[i + 1]);
+                            problem_().prefetch(elems[i + 1]);
+                        }
+                        linearizeElement_(elems[i]);
+                    }
+                    catch (...) {
+                        std::lock_guard<std::mutex> take(exceptionLock);
+                        exceptionPtr = std::current_exception();
+                        failed = true;
+                    }
+                };
+
+                const int numBorder = borderElements_.size();
+                const int numRemaining = remainingElements_.size();
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+                {
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+                    for (int i = 0; i < numBorder; ++i)
+                        linearizeElement(borderElements_, i);
+
+                    // the communication is started by the master thread only. this is
+                    // done even if the linearization failed because the peer processes
+                    // expect the message.
+#ifdef _OPENMP
+#pragma omp master
+#endif
+                    {
+                        try {
+                            linearSolver.beginMatrixSync(*jacobian_);
+                        }
+                        catch (...) {
+                            std::lock_guard<std::mutex> take(exceptionLock);
+                            exceptionPtr = std::current_exception();
+                            failed = true;
+                        }
+                    }
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 16)
+#endif
+                    for (int i = 0; i < numRemaining; ++i)
+                        linearizeElement(remainingElements_, i);
+                }
+
+                if (exceptionPtr)
+                    std::rethrow_exception(exceptionPtr);
+
+                return true;
+            }
+        }
+    }
+
+    // determine the elements which contribute to a given set of matrix rows
+    void updateBorderElements_(const std::vector<unsigned>& rows)
+    {
+        std::vector<bool> isBorderRow(model_().numTotalDof(), false);
+        for (unsigned rowIdx : rows)
+            isBorderRow[rowIdx] = true;
+
+        borderElements_.clear();
+        remainingElements_.clear();
+        Stencil stencil(gridView_(), dofMapper_());
+        for (const auto& elem : elements(gridView_())) {
+            if (!linearizeNonLocalElements && elem.partitionType() != Dune::InteriorEntity)
+                continue;
+
+            // an element contributes to the rows of all degrees of freedom of its stencil
+            stencil.update(elem);
+            bool isBorder = false;
+            for (unsigned dofIdx = 0; dofIdx < stencil.numDof() && !isBorder; ++dofIdx)
+                isBorder = isBorderRow[stencil.globalSpaceIndex(dofIdx)];
+
+            if (isBorder)
+                borderElements_.push_back(elem);
+            else
+                remainingElements_.push_back(elem);
+        }
+
+        elementListsValid_ = true;
+    }
+
     // linearize an element in the interior of the process' grid partition
     template <class ElementType>
-    void linearizeElement_(const ElementType& elem)
+    void linearizeElement_(const ElementType& elem, bool lockMatrix = true)
     {
         unsigned threadId = ThreadManager::threadId();
 
@@ -602,11 +933,21 @@ private:
         // the actual work of linearization is done by the local linearizer class
         localLinearizer.linearize(*elementCtx, elem);
 
+        // the addresses of the matrix blocks of the element are only known for the
+        // elements of the grid view of the model
+        MatrixBlock* const* blocks = nullptr;
+        if constexpr (std::is_same_v<ElementType, Element>) {
+            if (!elementBlockOffset_.empty())
+                blocks = elementBlocks_.data() + elementBlockOffset_[elementMapper_().index(elem)];
+        }
+
         // update the right hand side and the Jacobian matrix
-        if (getPropValue<TypeTag, Properties::UseLinearizationLock>())
+        lockMatrix = lockMatrix && getPropValue<TypeTag, Properties::UseLinearizationLock>();
+        if (lockMatrix)
             globalMatrixMutex_.lock();
 
         size_t numPrimaryDof = elementCtx->numPrimaryDof(/*timeIdx=*/0);
+        size_t numDof = elementCtx->numDof(/*timeIdx=*/0);
         for (unsigned primaryDofIdx = 0; primaryDofIdx < numPrimaryDof; ++ primaryDofIdx) {
             unsigned globI = elementCtx->globalSpaceIndex(/*spaceIdx=*/primaryDofIdx, /*timeIdx=*/0);
 
@@ -614,14 +955,18 @@ private:
             residual_[globI] += localLinearizer.residual(primaryDofIdx);
 
             // update the global Jacobian matrix
-            for (unsigned dofIdx = 0; dofIdx < elementCtx->numDof(/*timeIdx=*/0); ++ dofIdx) {
-                unsigned globJ = elementCtx->globalSpaceIndex(/*spaceIdx=*/dofIdx, /*timeIdx=*/0);
+            for (unsigned dofIdx = 0; dofIdx < numDof; ++ dofIdx) {
+                if (blocks) {
+                    *blocks[dofIdx*numPrimaryDof + primaryDofIdx] += localLinearizer.jacobian(dofIdx, primaryDofIdx);
+                    continue;
+                }
 
+                unsigned globJ = elementCtx->globalSpaceIndex(/*spaceIdx=*/dofIdx, /*timeIdx=*/0);
                 jacobian_->addToBlock(globJ, globI, localLinearizer.jacobian(dofIdx, primaryDofIdx));
             }
         }
 
-        if (getPropValue<TypeTag, Properties::UseLinearizationLock>())
+        if (lockMatrix)
             globalMatrixMutex_.unlock();
     }
 
@@ -668,6 +1013,17 @@ private:
     static bool enableConstraints_()
     { return getPropValue<TypeTag, Properties::EnableConstraints>(); }
 
+    // checks whether a linear solver can start to synchronize the Jacobian matrix before
+    // it has been fully assembled
+    template <class LinearSolver, class = void>
+    struct HasEarlyMatrixSync_ : std::false_type {};
+
+    template <class LinearSolver>
+    struct HasEarlyMatrixSync_<LinearSolver,
+                               std::void_t<decltype(std::declval<LinearSolver&>()
+                                                    .beginMatrixSync(std::declval<const SparseMatrixAdapter&>()))>>
+        : std::true_type {};
+
     Simulator *simulatorPtr_;
     std::vector<ElementContext*> elementCtx_;
 
@@ -697,6 +1053,20 @@ private:
 
     std::vector<std::set<unsigned int>> sparsityPattern_;
 
+    // the addresses of the matrix blocks to which the elements contribute in
+    // compressed row format and the elements grouped into colors
+    std::vector<std::size_t> elementBlockOffset_;
+    std::vector<MatrixBlock*> elementBlocks_;
+    std::vector<std::vector<Element>> colorElements_;
+
+    // the elements which contribute to matrix rows that are shared with peer processes
+    // and all other elements which need to be linearized
+    bool borderFirst_{false};
+    bool linearizedBorderFirst_{false};
+    bool elementListsValid_{false};
+    std::vector<Element> borderElements_;
+    std::vector<Element> remainingElements_;
+
     struct FullDomain
     {
         explicit FullDomain(const GridView& v) : view (v) {}
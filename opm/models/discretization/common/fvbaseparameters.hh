@@ -105,6 +105,17 @@ struct EnableVtkOutput { static constexpr bool value = true; };
 template<class Scalar>
 struct MaxTimeStepSize { static constexpr Scalar value = std::numeric_limits<Scalar>::infinity(); };
 
+/*!
+ * \brief Linearize the elements which contribute to the matrix rows shared with peer
+ *        processes first.
+ *
+ * This allows the linear solver to start the communication of these rows while the
+ * remaining elements are still being linearized. It only has an effect if the linear
+ * solver supports it and if neither constraints nor auxiliary equations are used.
+ * With more than one thread per process, MPI must also provide MPI_THREAD_FUNNELED.
+ */
+struct LinearizeBorderFirst { static constexpr bool value = false; };
+
 /*!
  * \brief The maximum allowed number of timestep divisions for the
  *        Newton solver.
@@ -127,6 +138,16 @@ struct OutputDir { static constexpr auto value = ""; };
 //! \brief Number of threads per process.
 struct ThreadsPerProcess { static constexpr int value = 1; };
 
+/*!
+ * \brief How the threads of a process are bound to its CPUs.
+ *
+ * 'none' leaves the placement to the OpenMP runtime, 'compact' fills the NUMA nodes
+ * one after the other and 'scatter' distributes the threads round-robin over the
+ * NUMA nodes. This only affects the threads: the memory of the solution, the
+ * residual and the Jacobian is still placed by the thread which first writes to it.
+ */
+struct ThreadPinning { static constexpr auto value = "none"; };
+
 } // namespace Opm::Parameters
 
 #endif
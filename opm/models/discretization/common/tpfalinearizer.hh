@@ -40,10 +40,13 @@
 #include <opm/input/eclipse/EclipseState/Grid/FaceDir.hpp>
 #include <opm/input/eclipse/Schedule/BCProp.hpp>
 
+#include <opm/models/common/multiphasebaseproperties.hh>
 #include <opm/models/discretization/common/baseauxiliarymodule.hh>
 #include <opm/models/discretization/common/fvbaseproperties.hh>
 #include <opm/models/discretization/common/linearizationtype.hh>
 
+#include <algorithm>
+#include <array>
 #include <exception>   // current_exception, rethrow_exception
 #include <iostream>
 #include <numeric>
@@ -55,6 +58,11 @@ namespace Opm::Parameters {
 
 struct SeparateSparseSourceTerms { static constexpr bool value = false; };
 
+struct EnableAdaptiveImplicit { static constexpr bool value = false; };
+
+template<class Scalar>
+struct AdaptiveImplicitCflThreshold { static constexpr Scalar value = 0.5; };
+
 } // namespace Opm::Parameters
 
 namespace Opm {
@@ -91,6 +99,7 @@ class TpfaLinearizer
     using Stencil = GetPropType<TypeTag, Properties::Stencil>;
     using LocalResidual = GetPropType<TypeTag, Properties::LocalResidual>;
     using IntensiveQuantities = GetPropType<TypeTag, Properties::IntensiveQuantities>;
+    using Indices = GetPropType<TypeTag, Properties::Indices>;
 
     using Element = typename GridView::template Codim<0>::Entity;
     using ElementIterator = typename GridView::template Codim<0>::Iterator;
@@ -98,6 +107,7 @@ class TpfaLinearizer
     using Vector = GlobalEqVector;
 
     enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+    enum { numPhases = getPropValue<TypeTag, Properties::NumPhases>() };
     enum { historySize = getPropValue<TypeTag, Properties::TimeDiscHistorySize>() };
     enum { dimWorld = GridView::dimensionworld };
 
@@ -119,6 +129,8 @@ public:
     {
         simulatorPtr_ = 0;
         separateSparseSourceTerms_ = Parameters::Get<Parameters::SeparateSparseSourceTerms>();
+        enableAdaptiveImplicit_ = Parameters::Get<Parameters::EnableAdaptiveImplicit>();
+        adaptiveImplicitCflThreshold_ = Parameters::Get<Parameters::AdaptiveImplicitCflThreshold<Scalar>>();
     }
 
     ~TpfaLinearizer()
@@ -132,6 +144,12 @@ public:
     {
         Parameters::Register<Parameters::SeparateSparseSourceTerms>
             ("Treat well source terms all in one go, instead of on a cell by cell basis.");
+        Parameters::Register<Parameters::EnableAdaptiveImplicit>
+            ("Treat the mobilities of cells with a small CFL number explicitly "
+             "(adaptive implicit formulation).");
+        Parameters::Register<Parameters::AdaptiveImplicitCflThreshold<Scalar>>
+            ("Cells whose CFL number at the beginning of a time step is below this "
+             "threshold are treated explicitly by the adaptive implicit formulation.");
     }
 
     /*!
@@ -241,6 +259,9 @@ public:
             resetSystem_(domain);
         }
 
+        if (enableAdaptiveImplicit_ && model_().newtonMethod().numIterations() == 0)
+            updateAdaptiveImplicit_();
+
         linearize_(domain);
     }
 
@@ -358,6 +379,21 @@ public:
         }
     }
 
+    /*!
+     * \brief Returns the CFL numbers of the cells at the beginning of the time step.
+     *
+     * (This object is only non-empty if the adaptive implicit formulation is enabled.)
+     */
+    const std::vector<Scalar>& adaptiveImplicitCfl() const
+    { return cflNumber_; }
+
+    /*!
+     * \brief Returns the number of cells which are treated explicitly in the current
+     *        time step by the adaptive implicit formulation.
+     */
+    std::size_t numExplicitCells() const
+    { return std::count(explicitCell_.begin(), explicitCell_.end(), 1); }
+
     /*!
      * \brief Returns the map of constraint degrees of freedom.
      *
@@ -468,7 +504,16 @@ private:
                         const auto dirId = scvf.dirId();
                         auto faceDir = dirId < 0 ? FaceDir::DirEnum::Unknown
                                                  : FaceDir::FromIntersectionIndex(dirId);
-                        loc_nbinfo[dofIdx - 1] = NeighborInfo{neighborIdx, {trans, area, thpres, dZg, faceDir, Vin, Vex, inAlpha, outAlpha, diffusivity, dispersivity}, nullptr};
+                        // the face coefficients are set by updateFaceCoefficients() below
+                        loc_nbinfo[dofIdx - 1] = NeighborInfo{neighborIdx,
+                                                              {trans, area, thpres, dZg, faceDir, Vin, Vex,
+                                                               inAlpha, outAlpha, diffusivity, dispersivity,
+                                                               /*diffusion=*/{}, /*dispersion=*/{},
+                                                               /*convectiveMixing=*/{}, /*adaptiveImplicit=*/{}},
+                                                              nullptr};
+                        LocalResidual::updateFaceCoefficients(loc_nbinfo[dofIdx - 1].res_nbinfo,
+                                                              problem_().pvtRegionIndex(myIdx),
+                                                              problem_().pvtRegionIndex(neighborIdx));
 
                     }
                 }
@@ -639,6 +684,21 @@ public:
         }
     }
 
+    /*!
+     * \brief Add the values of an AD residual to a residual block and its
+     *        derivatives to a block of the Jacobian, both scaled by a factor.
+     */
+    static void addResAndJacobi(VectorBlock& res,
+                                MatrixBlock& bMat,
+                                const ADVectorBlock& resid,
+                                Scalar factor = 1.0)
+    {
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            res[eqIdx] += factor*resid[eqIdx].value();
+            addDerivatives_(bMat[eqIdx], resid[eqIdx], factor);
+        }
+    }
+
     void updateFlowsInfo() {
         OPM_TIMEBLOCK(updateFlows);
         const bool& enableFlows = simulator_().problem().eclWriter()->outputModule().hasFlows() ||
@@ -707,6 +767,128 @@ public:
     }
 
 private:
+    // The following kernels accumulate the derivatives of one equation into a row of
+    // a matrix block. The number of derivatives is a compile time constant and the
+    // rows of the blocks as well as the derivatives of the evaluations are stored
+    // contiguously, so the compiler can use vector loads and stores for whole rows
+    // instead of copying the derivatives into a temporary block first.
+    template <class BlockRow>
+    static void addDerivatives_(BlockRow& row, const Evaluation& eval, Scalar factor)
+    {
+        for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx)
+            row[pvIdx] += factor*eval.derivative(pvIdx);
+    }
+
+    // add the derivatives of the flux over a face, which are taken with regard to the
+    // primary variables of the cell globI, to the diagonal block of globI and subtract
+    // them from the block (globJ, globI) which couples the residual of the neighbor
+    // globJ to the primary variables of globI
+    static void addFluxDerivatives_(MatrixBlock& diagBlock,
+                                    MatrixBlock& offDiagBlock,
+                                    const ADVectorBlock& flux)
+    {
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            auto& diagRow = diagBlock[eqIdx];
+            auto& offDiagRow = offDiagBlock[eqIdx];
+            const auto& eval = flux[eqIdx];
+            for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx) {
+                const Scalar deriv = eval.derivative(pvIdx);
+                diagRow[pvIdx] += deriv;
+                offDiagRow[pvIdx] -= deriv;
+            }
+        }
+    }
+
+    // the same as addFluxDerivatives_(), but only for the derivatives with regard to
+    // the pressure primary variable
+    static void addPressureFluxDerivatives_(MatrixBlock& diagBlock,
+                                            MatrixBlock& offDiagBlock,
+                                            const ADVectorBlock& flux)
+    {
+        constexpr unsigned pressureIdx = Indices::pressureSwitchIdx;
+        for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+            const Scalar deriv = flux[eqIdx].derivative(pressureIdx);
+            diagBlock[eqIdx][pressureIdx] += deriv;
+            offDiagBlock[eqIdx][pressureIdx] -= deriv;
+        }
+    }
+
+    // Decide which cells are treated explicitly in the current time step.
+    //
+    // The CFL number of a cell is estimated from the largest in- or outflow of a
+    // phase over the time step relative to its pore volume. Cells below the
+    // threshold use the mobilities, formation volume factors and dissolution factors
+    // of the beginning of the time step for their outgoing fluxes, which removes all
+    // non-pressure derivatives of these fluxes from the Jacobian.
+    void updateAdaptiveImplicit_()
+    {
+        OPM_TIMEBLOCK(updateAdaptiveImplicit);
+        const unsigned numCells = model_().numTotalDof();
+        const Scalar dt = simulator_().timeStepSize();
+        cflNumber_.resize(numCells);
+        explicitCell_.resize(numCells);
+
+        // store the properties of the beginning of the time step, the fluxes below
+        // are thus computed fully implicitly
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (unsigned globI = 0; globI < numCells; ++globI) {
+            const IntensiveQuantities& intQuantsIn = model_().intensiveQuantities(globI, /*timeIdx*/ 0);
+            auto nbInfos = neighborInfo_[globI];
+            for (auto& nbInfo : nbInfos) {
+                const IntensiveQuantities& intQuantsEx = model_().intensiveQuantities(nbInfo.neighbor, /*timeIdx*/ 0);
+                LocalResidual::updateAdaptiveImplicitInfo(nbInfo.res_nbinfo,
+                                                          /*explicitIn=*/false,
+                                                          /*explicitEx=*/false,
+                                                          intQuantsIn,
+                                                          intQuantsEx);
+            }
+        }
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (unsigned globI = 0; globI < numCells; ++globI) {
+            std::array<Scalar, numPhases> volumeFlux;
+            std::array<Scalar, numPhases> outflow{};
+            std::array<Scalar, numPhases> inflow{};
+            const IntensiveQuantities& intQuantsIn = model_().intensiveQuantities(globI, /*timeIdx*/ 0);
+            for (const auto& nbInfo : neighborInfo_[globI]) {
+                const IntensiveQuantities& intQuantsEx = model_().intensiveQuantities(nbInfo.neighbor, /*timeIdx*/ 0);
+                LocalResidual::computeVolumeFluxes(volumeFlux, intQuantsIn, intQuantsEx, globI, nbInfo.neighbor,
+                                                   nbInfo.res_nbinfo, problem_().moduleParams());
+                for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx) {
+                    const Scalar rate = volumeFlux[phaseIdx];
+                    if (rate > 0.0)
+                        outflow[phaseIdx] += rate;
+                    else
+                        inflow[phaseIdx] -= rate;
+                }
+            }
+
+            Scalar maxRate = 0.0;
+            for (unsigned phaseIdx = 0; phaseIdx < numPhases; ++phaseIdx)
+                maxRate = std::max(maxRate, std::max(outflow[phaseIdx], inflow[phaseIdx]));
+            const Scalar poreVolume = model_().dofTotalVolume(globI)
+                * intQuantsIn.porosity().value();
+            cflNumber_[globI] = poreVolume > 0.0 ? dt*maxRate/poreVolume : 0.0;
+            explicitCell_[globI] = cflNumber_[globI] < adaptiveImplicitCflThreshold_;
+        }
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (unsigned globI = 0; globI < numCells; ++globI) {
+            auto nbInfos = neighborInfo_[globI];
+            for (auto& nbInfo : nbInfos) {
+                auto& aim = nbInfo.res_nbinfo.adaptiveImplicit;
+                aim.explicitIn = explicitCell_[globI];
+                aim.explicitEx = explicitCell_[nbInfo.neighbor];
+            }
+        }
+    }
+
     template <class SubDomainType>
     void linearize_(const SubDomainType& domain)
     {
@@ -735,8 +917,8 @@ private:
             OPM_TIMEBLOCK_LOCAL(linearizationForEachCell);
             const unsigned globI = domain.cells[ii];
             const auto& nbInfos = neighborInfo_[globI];
+            MatrixBlock& diagBlock = *diagMatAddress_[globI];
             VectorBlock res(0.0);
-            MatrixBlock bMat(0.0);
             ADVectorBlock adres(0.0);
             ADVectorBlock darcyFlux(0.0);
             const IntensiveQuantities& intQuantsIn = model_().intensiveQuantities(globI, /*timeIdx*/ 0);
@@ -749,8 +931,6 @@ private:
                 OPM_TIMEBLOCK_LOCAL(fluxCalculationForEachFace);
                 unsigned globJ = nbInfo.neighbor;
                 assert(globJ != globI);
-                res = 0.0;
-                bMat = 0.0;
                 adres = 0.0;
                 darcyFlux = 0.0;
                 const IntensiveQuantities& intQuantsEx = model_().intensiveQuantities(globJ, /*timeIdx*/ 0);
@@ -761,13 +941,17 @@ private:
                         velocityInfo_[globI][loc].velocity[phaseIdx] = darcyFlux[phaseIdx].value() / nbInfo.res_nbinfo.faceArea;
                     }
                 }
-                setResAndJacobi(res, bMat, adres);
-                residual_[globI] += res;
-                //SparseAdapter syntax:  jacobian_->addToBlock(globI, globI, bMat);
-                *diagMatAddress_[globI] += bMat;
-                bMat *= -1.0;
-                //SparseAdapter syntax: jacobian_->addToBlock(globJ, globI, bMat);
-                *nbInfo.matBlockAddress += bMat;
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    residual_[globI][eqIdx] += adres[eqIdx].value();
+                // corresponds to jacobian_->addToBlock(globI, globI, J) and
+                // jacobian_->addToBlock(globJ, globI, -J), where J is the block of the
+                // derivatives of adres. the fluxes between two explicit cells only
+                // depend on the pressure, so the remaining columns are skipped.
+                if (enableAdaptiveImplicit_ &&
+                    LocalResidual::fluxOnlyDependsOnPressure(nbInfo.res_nbinfo))
+                    addPressureFluxDerivatives_(diagBlock, *nbInfo.matBlockAddress, adres);
+                else
+                    addFluxDerivatives_(diagBlock, *nbInfo.matBlockAddress, adres);
                 ++loc;
             }
             }
@@ -781,7 +965,8 @@ private:
                 OPM_TIMEBLOCK_LOCAL(computeStorage);
                 LocalResidual::computeStorage(adres, intQuantsIn);
             }
-            setResAndJacobi(res, bMat, adres);
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                res[eqIdx] = adres[eqIdx].value();
             // Either use cached storage term, or compute it on the fly.
             if (model_().enableStorageCache()) {
                 // The cached storage for timeIdx 0 (current time) is not
@@ -819,26 +1004,22 @@ private:
                 res -= tmp;
             }
             res *= storefac;
-            bMat *= storefac;
             residual_[globI] += res;
-            //SparseAdapter syntax: jacobian_->addToBlock(globI, globI, bMat);
-            *diagMatAddress_[globI] += bMat;
+            // corresponds to jacobian_->addToBlock(globI, globI, storefac*J), where J
+            // is the block of the derivatives of adres
+            for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                addDerivatives_(diagBlock[eqIdx], adres[eqIdx], storefac);
 
             // Cell-wise source terms.
             // This will include well sources if SeparateSparseSourceTerms is false.
-            res = 0.0;
-            bMat = 0.0;
             adres = 0.0;
             if (separateSparseSourceTerms_) {
                 LocalResidual::computeSourceDense(adres, problem_(), globI, 0);
             } else {
                 LocalResidual::computeSource(adres, problem_(), globI, 0);
             }
-            adres *= -volume;
-            setResAndJacobi(res, bMat, adres);
-            residual_[globI] += res;
-            //SparseAdapter syntax: jacobian_->addToBlock(globI, globI, bMat);
-            *diagMatAddress_[globI] += bMat;
+            // corresponds to jacobian_->addToBlock(globI, globI, -volume*J)
+            addResAndJacobi(residual_[globI], diagBlock, adres, -volume);
         } // end of loop for cell globI.
 
         // Add sparse source terms. For now only wells.
@@ -851,17 +1032,12 @@ private:
             if (bdyInfo.bcdata.type == BCType::NONE)
                 continue;
 
-            VectorBlock res(0.0);
-            MatrixBlock bMat(0.0);
             ADVectorBlock adres(0.0);
             const unsigned globI = bdyInfo.cell;
             const IntensiveQuantities& insideIntQuants = model_().intensiveQuantities(globI, /*timeIdx*/ 0);
             LocalResidual::computeBoundaryFlux(adres, problem_(), bdyInfo.bcdata, insideIntQuants, globI);
-            adres *= bdyInfo.bcdata.faceArea;
-            setResAndJacobi(res, bMat, adres);
-            residual_[globI] += res;
-            ////SparseAdapter syntax: jacobian_->addToBlock(globI, globI, bMat);
-            *diagMatAddress_[globI] += bMat;
+            // corresponds to jacobian_->addToBlock(globI, globI, faceArea*J)
+            addResAndJacobi(residual_[globI], *diagMatAddress_[globI], adres, bdyInfo.bcdata.faceArea);
         }
     }
 
@@ -942,6 +1118,12 @@ private:
     };
     std::vector<BoundaryInfo> boundaryInfo_;
     bool separateSparseSourceTerms_ = false;
+
+    // adaptive implicit formulation
+    bool enableAdaptiveImplicit_ = false;
+    Scalar adaptiveImplicitCflThreshold_;
+    std::vector<Scalar> cflNumber_;
+    std::vector<unsigned char> explicitCell_;
     struct FullDomain
     {
         std::vector<int> cells;
@@ -37,6 +37,7 @@
 
 #include <opm/simulators/linalg/elementborderlistfromgrid.hh>
 #include <opm/models/discretization/common/fvbasediscretization.hh>
+#include <opm/models/parallel/gridhaloexchange.hh>
 
 #if HAVE_DUNE_FEM
 #include <opm/models/discretization/common/fvbasediscretizationfemadapt.hh>
@@ -188,17 +189,17 @@ public:
      */
     void syncOverlap()
     {
+        // the communication pattern only needs to be determined once per grid
+        const int gridSequenceNumber = this->simulator_.vanguard().gridSequenceNumber();
+        if (ghostSyncSequenceNumber_ != gridSequenceNumber) {
+            ghostSync_.template init</*commCodim=*/0>(this->gridView(),
+                                                      asImp_().dofMapper(),
+                                                      Dune::InteriorBorder_All_Interface);
+            ghostSyncSequenceNumber_ = gridSequenceNumber;
+        }
+
         // syncronize the solution on the ghost and overlap elements
-        using GhostSyncHandle = GridCommHandleGhostSync<PrimaryVariables,
-                                                        SolutionVector,
-                                                        DofMapper,
-                                                        /*commCodim=*/0>;
-
-        auto ghostSync = GhostSyncHandle(this->solution(/*timeIdx=*/0),
-                                         asImp_().dofMapper());
-        this->gridView().communicate(ghostSync,
-                                     Dune::InteriorBorder_All_Interface,
-                                     Dune::ForwardCommunication);
+        ghostSync_.copy(this->solution(/*timeIdx=*/0));
     }
 
     /*!
@@ -231,6 +232,9 @@ private:
     { return *static_cast<Implementation*>(this); }
     const Implementation& asImp_() const
     { return *static_cast<const Implementation*>(this); }
+
+    GridHaloExchange<PrimaryVariables> ghostSync_;
+    int ghostSyncSequenceNumber_{-1};
 };
 } // namespace Opm
 
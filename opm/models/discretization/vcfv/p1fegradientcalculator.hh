@@ -290,6 +290,54 @@ public:
             ParentType::calculateGradient(quantityGrad, elemCtx, fapIdx, quantityCallback);
     }
 
+    /*!
+     * \brief Calculates the scalar product of the gradient of an arbitrary quantity
+     *        and the normal of a flux approximation point.
+     *
+     * \param elemCtx The current execution context
+     * \param fapIdx The local index of the flux approximation point
+     *               in the current element's stencil.
+     * \param quantityCallback A callable object returning the value
+     *               of the quantity at an index of a degree of
+     *               freedom
+     */
+    template <class QuantityCallback>
+    void calculateNormalGradient([[maybe_unused]] Evaluation& quantityGradNormal,
+                                 [[maybe_unused]] const ElementContext& elemCtx,
+                                 [[maybe_unused]] unsigned fapIdx,
+                                 [[maybe_unused]] const QuantityCallback& quantityCallback) const
+    {
+        if (getPropValue<TypeTag, Properties::UseP1FiniteElementGradients>()) {
+#if !HAVE_DUNE_LOCALFUNCTIONS
+            // The dune-localfunctions module is required for P1 finite element gradients
+            throw std::logic_error("The dune-localfunctions module is required in oder to use"
+                                   " finite element gradients");
+#else
+            using QuantityConstType = typename std::remove_reference<typename QuantityCallback::ResultType>::type;
+            using QuantityType = typename std::remove_const<QuantityConstType>::type;
+
+            // project the gradients of the shape functions on the face normal first,
+            // so that the gradient vector of the quantity is never assembled
+            const auto& normal = elemCtx.stencil(/*timeIdx=*/0).interiorFace(fapIdx).normal();
+            quantityGradNormal = 0.0;
+            for (unsigned vertIdx = 0; vertIdx < elemCtx.numDof(/*timeIdx=*/0); ++vertIdx) {
+                const auto& tmp = p1Gradient_[fapIdx][vertIdx];
+                Scalar shapeGradNormal = 0.0;
+                for (int dimIdx = 0; dimIdx < dim; ++ dimIdx)
+                    shapeGradNormal += normal[dimIdx]*tmp[dimIdx];
+
+                if (std::is_same<QuantityType, Scalar>::value ||
+                    elemCtx.focusDofIndex() == vertIdx)
+                    quantityGradNormal += quantityCallback(vertIdx)*shapeGradNormal;
+                else
+                    quantityGradNormal += scalarValue(quantityCallback(vertIdx))*shapeGradNormal;
+            }
+#endif
+        }
+        else
+            ParentType::calculateNormalGradient(quantityGradNormal, elemCtx, fapIdx, quantityCallback);
+    }
+
     /*!
      * \brief Calculates the value of an arbitrary quantity at any
      *        flux approximation point on the grid boundary.
@@ -129,7 +129,7 @@ public:
         // compute the phase compositions, densities and pressures
         typename FluidSystem::template ParameterCache<Evaluation> paramCache;
         const MaterialLawParams& materialParams =
-            problem.materialLawParams(elemCtx, dofIdx, timeIdx);
+            problem.storedMaterialLawParams(elemCtx, dofIdx, timeIdx);
         FlashSolver::template solve<MaterialLaw>(fluidState_,
                                                  materialParams,
                                                  paramCache,
@@ -157,11 +157,11 @@ public:
         /////////////
 
         // porosity
-        porosity_ = problem.porosity(elemCtx, dofIdx, timeIdx);
+        porosity_ = problem.storedPorosity(elemCtx, dofIdx, timeIdx);
         Opm::Valgrind::CheckDefined(porosity_);
 
         // intrinsic permeability
-        intrinsicPerm_ = problem.intrinsicPermeability(elemCtx, dofIdx, timeIdx);
+        intrinsicPerm_ = problem.storedIntrinsicPermeability(elemCtx, dofIdx, timeIdx);
 
         // update the quantities specific for the velocity model
         FluxIntensiveQuantities::update_(elemCtx, dofIdx, timeIdx);
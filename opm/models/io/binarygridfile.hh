@@ -0,0 +1,344 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::BinaryGridFile
+ */
+#ifndef EWOMS_BINARY_GRID_FILE_HH
+#define EWOMS_BINARY_GRID_FILE_HH
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief A preprocessed binary representation of an unstructured grid which is
+ *        accessed by mapping the file into memory.
+ *
+ * The file stores the vertex coordinates, the vertex indices of the elements and
+ * the vertices of the fracture edges, so that a grid can be created using a grid
+ * factory without having to parse any text. It also stores a hash of the file it
+ * was created from, which allows to detect stale files.
+ *
+ * The file consists of a fixed-size header which is followed by the coordinates of
+ * the vertices (double), the offsets of the elements into the list of corners
+ * (uint64), the corners of all elements (uint32) and the pairs of vertices of the
+ * fracture edges (uint32). All data is stored in the native byte order.
+ */
+class BinaryGridFile
+{
+    struct Header_
+    {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t dim;
+        std::uint32_t dimWorld;
+        std::uint32_t reserved;
+        std::uint64_t sourceHash;
+        std::uint64_t numVertices;
+        std::uint64_t numElements;
+        std::uint64_t numCorners;
+        std::uint64_t numFractureEdges;
+    };
+
+    static constexpr char magic_[8] = { 'O', 'P', 'M', 'G', 'R', 'I', 'D', '\0' };
+    static constexpr std::uint32_t version_ = 1;
+
+public:
+    /*!
+     * \brief The data of a grid which is written to a binary grid file.
+     */
+    struct Data
+    {
+        unsigned dim = 0;
+        unsigned dimWorld = 0;
+
+        //! The coordinates of the vertices, dimWorld values per vertex
+        std::vector<double> vertexCoords;
+
+        //! Start of the corners of each element, has numElements + 1 entries
+        std::vector<std::uint64_t> elementOffsets{0};
+
+        //! The vertex indices of the corners of all elements
+        std::vector<std::uint32_t> elementCorners;
+
+        //! The vertex indices of the fracture edges, two values per edge
+        std::vector<std::uint32_t> fractureEdges;
+    };
+
+    /*!
+     * \brief Map a binary grid file into memory.
+     *
+     * If the file does not exist or is not a valid binary grid file, the object is
+     * still created but matches() will return false. This includes files which refer
+     * to vertices or corners that are not contained in the file.
+     */
+    explicit BinaryGridFile(const std::string& fileName)
+    {
+        const int fd = ::open(fileName.c_str(), O_RDONLY);
+        if (fd < 0)
+            return;
+
+        struct stat fileStat;
+        if (::fstat(fd, &fileStat) == 0 && fileStat.st_size >= static_cast<off_t>(sizeof(Header_))) {
+            void* addr = ::mmap(nullptr, static_cast<std::size_t>(fileStat.st_size),
+                                PROT_READ, MAP_PRIVATE, fd, /*offset=*/0);
+            if (addr != MAP_FAILED) {
+                data_ = static_cast<const char*>(addr);
+                size_ = static_cast<std::size_t>(fileStat.st_size);
+            }
+        }
+        // the mapping stays valid after the file descriptor has been closed
+        ::close(fd);
+
+        if (data_ && !(checkLayout_() && checkIndices_())) {
+            ::munmap(const_cast<char*>(data_), size_);
+            data_ = nullptr;
+            size_ = 0;
+        }
+    }
+
+    BinaryGridFile(const BinaryGridFile&) = delete;
+    BinaryGridFile& operator=(const BinaryGridFile&) = delete;
+
+    ~BinaryGridFile()
+    {
+        if (data_)
+            ::munmap(const_cast<char*>(data_), size_);
+    }
+
+    /*!
+     * \brief Returns true if the file is a valid binary grid file which has been
+     *        created from a source with the given hash for the given dimensions.
+     */
+    bool matches(std::uint64_t sourceHash, unsigned dim, unsigned dimWorld) const
+    {
+        return data_
+            && header_().sourceHash == sourceHash
+            && header_().dim == dim
+            && header_().dimWorld == dimWorld;
+    }
+
+    /*!
+     * \brief Returns the number of vertices of the grid.
+     */
+    std::size_t numVertices() const
+    { return header_().numVertices; }
+
+    /*!
+     * \brief Returns a pointer to the dimWorld coordinates of a vertex.
+     */
+    const double* vertex(std::size_t vertexIdx) const
+    { return vertexCoords_() + vertexIdx*header_().dimWorld; }
+
+    /*!
+     * \brief Returns the number of elements of the grid.
+     */
+    std::size_t numElements() const
+    { return header_().numElements; }
+
+    /*!
+     * \brief Returns the number of corners of an element.
+     */
+    std::size_t numCorners(std::size_t elemIdx) const
+    { return elementOffsets_()[elemIdx + 1] - elementOffsets_()[elemIdx]; }
+
+    /*!
+     * \brief Returns a pointer to the vertex indices of the corners of an element.
+     */
+    const std::uint32_t* corners(std::size_t elemIdx) const
+    { return elementCorners_() + elementOffsets_()[elemIdx]; }
+
+    /*!
+     * \brief Returns the number of fracture edges of the grid.
+     */
+    std::size_t numFractureEdges() const
+    { return header_().numFractureEdges; }
+
+    /*!
+     * \brief Returns a pointer to the two vertex indices of a fracture edge.
+     */
+    const std::uint32_t* fractureEdge(std::size_t edgeIdx) const
+    { return fractureEdges_() + 2*edgeIdx; }
+
+    /*!
+     * \brief Write a binary grid file.
+     *
+     * The file is first written to a temporary file which is then renamed, so that
+     * processes reading the file concurrently never see an incomplete file.
+     */
+    static void write(const std::string& fileName,
+                      std::uint64_t sourceHash,
+                      const Data& data)
+    {
+        Header_ header{};
+        std::memcpy(header.magic, magic_, sizeof(magic_));
+        header.version = version_;
+        header.dim = data.dim;
+        header.dimWorld = data.dimWorld;
+        header.sourceHash = sourceHash;
+        header.numVertices = data.dimWorld > 0 ? data.vertexCoords.size()/data.dimWorld : 0;
+        header.numElements = data.elementOffsets.size() - 1;
+        header.numCorners = data.elementCorners.size();
+        header.numFractureEdges = data.fractureEdges.size()/2;
+
+        const std::string tmpFileName = fileName + ".tmp";
+        {
+            std::ofstream os(tmpFileName, std::ios::binary);
+            if (!os)
+                throw std::runtime_error("Could not open file '" + tmpFileName + "' for writing");
+
+            writeArray_(os, &header, 1);
+            writeArray_(os, data.vertexCoords.data(), data.vertexCoords.size());
+            writeArray_(os, data.elementOffsets.data(), data.elementOffsets.size());
+            writeArray_(os, data.elementCorners.data(), data.elementCorners.size());
+            writeArray_(os, data.fractureEdges.data(), data.fractureEdges.size());
+
+            if (!os)
+                throw std::runtime_error("Could not write file '" + tmpFileName + "'");
+        }
+
+        if (std::rename(tmpFileName.c_str(), fileName.c_str()) != 0)
+            throw std::runtime_error("Could not rename '" + tmpFileName + "' to '" + fileName + "'");
+    }
+
+    /*!
+     * \brief Returns the 64 bit FNV-1a hash of a block of memory.
+     *
+     * The hash of a previous block can be passed as the seed to hash data which is
+     * split into several blocks.
+     */
+    static std::uint64_t hash(const char* data,
+                              std::size_t size,
+                              std::uint64_t seed = 14695981039346656037ULL)
+    {
+        std::uint64_t result = seed;
+        for (std::size_t i = 0; i < size; ++i) {
+            result ^= static_cast<unsigned char>(data[i]);
+            result *= 1099511628211ULL;
+        }
+        return result;
+    }
+
+    /*!
+     * \brief Returns the hash of the content of a file.
+     */
+    static std::uint64_t contentHash(const std::string& fileName)
+    {
+        std::ifstream is(fileName, std::ios::binary);
+        if (!is)
+            throw std::runtime_error("Could not open file '" + fileName + "'");
+
+        std::uint64_t result = hash(nullptr, 0);
+        std::vector<char> buffer(1 << 16);
+        while (is) {
+            is.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            result = hash(buffer.data(), static_cast<std::size_t>(is.gcount()), result);
+        }
+        return result;
+    }
+
+private:
+    template <class T>
+    static void writeArray_(std::ostream& os, const T* data, std::size_t size)
+    {
+        if (size > 0)
+            os.write(reinterpret_cast<const char*>(data),
+                     static_cast<std::streamsize>(size*sizeof(T)));
+    }
+
+    const Header_& header_() const
+    { return *reinterpret_cast<const Header_*>(data_); }
+
+    const double* vertexCoords_() const
+    { return reinterpret_cast<const double*>(data_ + sizeof(Header_)); }
+
+    const std::uint64_t* elementOffsets_() const
+    {
+        return reinterpret_cast<const std::uint64_t*>(vertexCoords_()
+                                                      + header_().numVertices*header_().dimWorld);
+    }
+
+    const std::uint32_t* elementCorners_() const
+    { return reinterpret_cast<const std::uint32_t*>(elementOffsets_() + header_().numElements + 1); }
+
+    const std::uint32_t* fractureEdges_() const
+    { return elementCorners_() + header_().numCorners; }
+
+    // check the header and whether the size of the file is consistent with it
+    bool checkLayout_() const
+    {
+        const Header_& header = header_();
+        if (std::memcmp(header.magic, magic_, sizeof(magic_)) != 0 || header.version != version_)
+            return false;
+
+        const std::size_t expectedSize =
+            sizeof(Header_)
+            + header.numVertices*header.dimWorld*sizeof(double)
+            + (header.numElements + 1)*sizeof(std::uint64_t)
+            + header.numCorners*sizeof(std::uint32_t)
+            + 2*header.numFractureEdges*sizeof(std::uint32_t);
+        return size_ == expectedSize
+            && elementOffsets_()[header.numElements] == header.numCorners;
+    }
+
+    // check that the element offsets are monotonic and that all vertex indices are
+    // valid, so that a corrupt file is never passed on to the grid factory
+    bool checkIndices_() const
+    {
+        const Header_& header = header_();
+        const std::uint64_t* offsets = elementOffsets_();
+        if (offsets[0] != 0)
+            return false;
+        for (std::size_t elemIdx = 0; elemIdx < header.numElements; ++elemIdx)
+            if (offsets[elemIdx + 1] < offsets[elemIdx])
+                return false;
+
+        const auto isValidVertex = [&header](std::uint32_t vertexIdx)
+        { return vertexIdx < header.numVertices; };
+        const std::uint32_t* corners = elementCorners_();
+        const std::uint32_t* edges = fractureEdges_();
+        return std::all_of(corners, corners + header.numCorners, isValidVertex)
+            && std::all_of(edges, edges + 2*header.numFractureEdges, isValidVertex);
+    }
+
+    const char* data_{nullptr};
+    std::size_t size_{0};
+};
+
+} // namespace Opm
+
+#endif
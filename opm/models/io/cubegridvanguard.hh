@@ -28,6 +28,7 @@
 #define EWOMS_CUBE_GRID_VANGUARD_HH
 
 #include <opm/models/io/basevanguard.hh>
+#include <opm/models/io/distributedcubegridfactory.hh>
 #include <opm/models/utils/basicparameters.hh>
 #include <opm/models/utils/basicproperties.hh>
 #include <opm/models/utils/propertysystem.hh>
@@ -73,6 +74,9 @@ public:
         Parameters::Register<Parameters::GridGlobalRefinements>
             ("The number of global refinements of the grid "
              "executed after it was loaded");
+        Parameters::Register<Parameters::DistributedGridConstruction>
+            ("Let each process create only its part of the grid instead of creating "
+             "the whole grid on the first process");
         Parameters::Register<Parameters::DomainSizeX<Scalar>>
             ("The size of the domain in x direction");
         Parameters::Register<Parameters::CellsX>
@@ -118,7 +122,10 @@ public:
         }
 
         unsigned numRefinements = Parameters::Get<Parameters::GridGlobalRefinements>();
-        cubeGrid_ = Dune::StructuredGridFactory<Grid>::createCubeGrid(lowerLeft, upperRight, cellRes);
+        if (Parameters::Get<Parameters::DistributedGridConstruction>())
+            cubeGrid_ = DistributedCubeGridFactory<Grid>::createCubeGrid(lowerLeft, upperRight, cellRes);
+        else
+            cubeGrid_ = Dune::StructuredGridFactory<Grid>::createCubeGrid(lowerLeft, upperRight, cellRes);
         cubeGrid_->globalRefine(static_cast<int>(numRefinements));
 
         this->finalizeInit_();
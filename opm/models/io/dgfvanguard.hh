@@ -27,17 +27,29 @@
 #ifndef EWOMS_DGF_GRID_VANGUARD_HH
 #define EWOMS_DGF_GRID_VANGUARD_HH
 
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/geometry/type.hh>
+#include <dune/grid/common/capabilities.hh>
+#include <dune/grid/common/gridfactory.hh>
 #include <dune/grid/io/file/dgfparser/dgfparser.hh>
 #include <dune/grid/common/mcmgmapper.hh>
 #include <opm/models/discretefracture/fracturemapper.hh>
 
 #include <opm/models/io/basevanguard.hh>
+#include <opm/models/io/binarygridfile.hh>
+#include <opm/models/utils/basicparameters.hh>
 #include <opm/models/utils/propertysystem.hh>
 #include <opm/models/utils/parametersystem.hh>
 
-
+#include <algorithm>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <set>
 #include <type_traits>
 #include <string>
+#include <vector>
 
 namespace Opm {
 
@@ -67,6 +79,9 @@ public:
         Parameters::Register<Parameters::GridGlobalRefinements>
             ("The number of global refinements of the grid "
              "executed after it was loaded");
+        Parameters::Register<Parameters::EnableGridCache>
+            ("Read the grid from the binary file '$GRID_FILE.bin' instead of parsing "
+             "the DGF file. The binary file is rebuilt if it is missing or stale");
     }
 
     /*!
@@ -78,16 +93,10 @@ public:
         const std::string dgfFileName = Parameters::Get<Parameters::GridFile>();
         unsigned numRefinments = Parameters::Get<Parameters::GridGlobalRefinements>();
 
-        {
-            // create DGF GridPtr from a dgf file
-            Dune::GridPtr< Grid > dgfPointer( dgfFileName );
-
-            // this is only implemented for 2d currently
-            addFractures_( dgfPointer );
-
-            // store pointer to dune grid
-            gridPtr_.reset( dgfPointer.release() );
-        }
+        if (Parameters::Get<Parameters::EnableGridCache>())
+            createGridCached_(dgfFileName);
+        else
+            createGrid_(dgfFileName);
 
         if (numRefinments > 0)
             gridPtr_->globalRefine(static_cast<int>(numRefinments));
@@ -134,6 +143,157 @@ public:
     { return fractureMapper_; }
 
 protected:
+    void createGrid_(const std::string& dgfFileName)
+    {
+        // create DGF GridPtr from a dgf file
+        Dune::GridPtr< Grid > dgfPointer( dgfFileName );
+
+        // this is only implemented for 2d currently
+        addFractures_( dgfPointer );
+
+        // store pointer to dune grid
+        gridPtr_.reset( dgfPointer.release() );
+    }
+
+    // create the grid from the binary grid file if it is up to date. If not, parse
+    // the DGF file and write a new binary grid file. The data is only read on the
+    // first process, i.e., the same processes have the grid as when parsing the
+    // DGF file.
+    void createGridCached_(const std::string& dgfFileName)
+    {
+        // structured grids cannot be created by a grid factory, but parsing their
+        // DGF files is cheap anyway
+        if constexpr (Dune::Capabilities::isCartesian<Grid>::v) {
+            createGrid_(dgfFileName);
+        }
+        else {
+            const auto& comm = Dune::MPIHelper::getCommunication();
+            const std::string cacheFileName = dgfFileName + ".bin";
+
+            std::uint64_t sourceHash = 0;
+            std::unique_ptr<BinaryGridFile> cacheFile;
+            int cacheValid = 0;
+            if (comm.rank() == 0) {
+                // if the DGF file cannot be read, the DGF parser reports the error
+                try {
+                    sourceHash = BinaryGridFile::contentHash(dgfFileName);
+                    cacheFile = std::make_unique<BinaryGridFile>(cacheFileName);
+                    cacheValid = cacheFile->matches(sourceHash, Grid::dimension, Grid::dimensionworld);
+                }
+                catch (const std::exception&) {
+                    cacheValid = 0;
+                }
+            }
+            comm.broadcast(&cacheValid, /*count=*/1, /*root=*/0);
+
+            if (!cacheValid) {
+                createGrid_(dgfFileName);
+                if (comm.rank() == 0 && cacheFile) {
+                    cacheFile.reset();
+                    try {
+                        writeGridCache_(cacheFileName, sourceHash);
+                    }
+                    catch (const std::exception& e) {
+                        // not being able to write the cache is not fatal
+                        std::cerr << "Warning: " << e.what() << std::endl;
+                    }
+                }
+                return;
+            }
+
+            Dune::GridFactory<Grid> factory;
+            if (comm.rank() == 0) {
+                Dune::FieldVector<typename Grid::ctype, Grid::dimensionworld> pos;
+                for (std::size_t vertexIdx = 0; vertexIdx < cacheFile->numVertices(); ++vertexIdx) {
+                    const double* coords = cacheFile->vertex(vertexIdx);
+                    for (unsigned i = 0; i < Grid::dimensionworld; ++i)
+                        pos[i] = coords[i];
+                    factory.insertVertex(pos);
+                }
+
+                std::vector<unsigned> corners;
+                for (std::size_t elemIdx = 0; elemIdx < cacheFile->numElements(); ++elemIdx) {
+                    const std::size_t numCorners = cacheFile->numCorners(elemIdx);
+                    const std::uint32_t* elemCorners = cacheFile->corners(elemIdx);
+                    corners.assign(elemCorners, elemCorners + numCorners);
+                    const auto geomType =
+                        (numCorners == Grid::dimension + 1)
+                        ? Dune::GeometryTypes::simplex(Grid::dimension)
+                        : Dune::GeometryTypes::cube(Grid::dimension);
+                    factory.insertElement(geomType, corners);
+                }
+            }
+            gridPtr_ = GridPointer(factory.createGrid());
+
+            if (comm.rank() == 0 && cacheFile->numFractureEdges() > 0) {
+                // the fracture edges are stored using the insertion indices of the
+                // vertices which are not necessarily the indices used by the grid
+                using LevelGridView = typename Grid::LevelGridView;
+                using VertexMapper = Dune::MultipleCodimMultipleGeomTypeMapper<LevelGridView>;
+                LevelGridView gridView = gridPtr_->levelGridView(/*level=*/0);
+                VertexMapper vertexMapper(gridView, Dune::mcmgVertexLayout());
+
+                std::vector<unsigned> vertexIndex(cacheFile->numVertices());
+                for (const auto& vertex : vertices(gridView))
+                    vertexIndex[factory.insertionIndex(vertex)] =
+                        static_cast<unsigned>(vertexMapper.index(vertex));
+
+                for (std::size_t edgeIdx = 0; edgeIdx < cacheFile->numFractureEdges(); ++edgeIdx) {
+                    const std::uint32_t* edge = cacheFile->fractureEdge(edgeIdx);
+                    fractureMapper_.addFractureEdge(vertexIndex[edge[0]], vertexIndex[edge[1]]);
+                }
+            }
+        }
+    }
+
+    // write the macro grid and the fractures to a binary grid file
+    void writeGridCache_(const std::string& cacheFileName, std::uint64_t sourceHash) const
+    {
+        using LevelGridView = typename Grid::LevelGridView;
+        using VertexMapper = Dune::MultipleCodimMultipleGeomTypeMapper<LevelGridView>;
+        LevelGridView gridView = gridPtr_->levelGridView(/*level=*/0);
+        VertexMapper vertexMapper(gridView, Dune::mcmgVertexLayout());
+
+        BinaryGridFile::Data data;
+        data.dim = Grid::dimension;
+        data.dimWorld = Grid::dimensionworld;
+
+        data.vertexCoords.resize(vertexMapper.size()*Grid::dimensionworld);
+        for (const auto& vertex : vertices(gridView)) {
+            const auto pos = vertex.geometry().corner(0);
+            const std::size_t vertexIdx = vertexMapper.index(vertex);
+            for (unsigned i = 0; i < Grid::dimensionworld; ++i)
+                data.vertexCoords[vertexIdx*Grid::dimensionworld + i] = pos[i];
+        }
+
+        // the fracture mapper does not allow to iterate over its edges, so we check
+        // all pairs of corners of each element. Since the edges are shared by the
+        // neighboring elements, they are collected in a set to store each one once.
+        std::set<std::pair<std::uint32_t, std::uint32_t>> fractureEdges;
+        for (const auto& element : elements(gridView)) {
+            const unsigned numCorners = element.subEntities(Grid::dimension);
+            std::vector<std::uint32_t> corners(numCorners);
+            for (unsigned i = 0; i < numCorners; ++i)
+                corners[i] = static_cast<std::uint32_t>(vertexMapper.subIndex(element, i, Grid::dimension));
+
+            for (unsigned i = 0; i < numCorners; ++i)
+                for (unsigned j = i + 1; j < numCorners; ++j)
+                    if (fractureMapper_.isFractureEdge(corners[i], corners[j]))
+                        fractureEdges.emplace(std::min(corners[i], corners[j]),
+                                              std::max(corners[i], corners[j]));
+
+            data.elementCorners.insert(data.elementCorners.end(), corners.begin(), corners.end());
+            data.elementOffsets.push_back(data.elementCorners.size());
+        }
+
+        for (const auto& [vertexIdx1, vertexIdx2] : fractureEdges) {
+            data.fractureEdges.push_back(vertexIdx1);
+            data.fractureEdges.push_back(vertexIdx2);
+        }
+
+        BinaryGridFile::write(cacheFileName, sourceHash, data);
+    }
+
     void addFractures_(Dune::GridPtr<Grid>& dgfPointer)
     {
         using LevelGridView = typename Grid::LevelGridView;
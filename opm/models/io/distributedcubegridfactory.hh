@@ -0,0 +1,306 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::DistributedCubeGridFactory
+ */
+#ifndef EWOMS_DISTRIBUTED_CUBE_GRID_FACTORY_HH
+#define EWOMS_DISTRIBUTED_CUBE_GRID_FACTORY_HH
+
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <dune/geometry/type.hh>
+
+#include <dune/grid/common/capabilities.hh>
+#include <dune/grid/common/gridfactory.hh>
+#include <dune/grid/utility/structuredgridfactory.hh>
+
+#include <array>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Creates a regular grid of cubes without assembling the whole grid on a
+ *        single process.
+ *
+ * The cells of the grid are distributed to the processes by a recursive coordinate
+ * bisection of the index box, i.e., the box is recursively split along its longest
+ * axis proportionally to the number of processes on each side. Every process then
+ * inserts only the vertices and elements of its sub-box into the grid factory. The
+ * vertices on the process borders are identified using global IDs which are
+ * computed analytically from the vertex lattice, so no communication is required
+ * to construct the grid.
+ *
+ * For simplex grids, each cube is split into dim! simplices along its main diagonal
+ * (Kuhn triangulation). Since all cubes are split in the same way, the resulting
+ * grid is conforming across the process borders as well.
+ *
+ * This requires a grid factory which accepts global vertex IDs (e.g., the one of
+ * ALUGrid). Since these IDs are unsigned integers, the number of vertices of the
+ * whole grid must be representable as an unsigned. For all other grids, the grid is created using
+ * Dune::StructuredGridFactory. Note that YaspGrid is always constructed in a
+ * distributed manner.
+ */
+template <class Grid>
+class DistributedCubeGridFactory
+{
+    enum {
+        dim = Grid::dimension,
+        dimWorld = Grid::dimensionworld,
+    };
+    using CoordScalar = typename Grid::ctype;
+    using GlobalPosition = Dune::FieldVector<CoordScalar, dimWorld>;
+    using IndexBox = std::pair<std::array<unsigned, dim>, std::array<unsigned, dim>>;
+
+    template <class Factory, class = void>
+    struct HasGlobalVertexIds_ : std::false_type {};
+
+    template <class Factory>
+    struct HasGlobalVertexIds_<Factory,
+                               std::void_t<decltype(std::declval<Factory&>()
+                                                    .insertVertex(std::declval<const GlobalPosition&>(),
+                                                                  0u))>>
+        : std::true_type {};
+
+public:
+    /*!
+     * \brief Returns true if the grid can be constructed in a distributed manner.
+     */
+    static constexpr bool supportsDistributedConstruction()
+    { return HasGlobalVertexIds_<Dune::GridFactory<Grid>>::value; }
+
+    /*!
+     * \brief Returns true if all elements of the grid are simplices.
+     */
+    static constexpr bool isSimplexGrid()
+    {
+        using Capability = Dune::Capabilities::hasSingleGeometryType<Grid>;
+        return Capability::v && Capability::topologyId == Dune::GeometryTypes::simplex(dim).id();
+    }
+
+    /*!
+     * \brief Create a regular grid of cubes.
+     *
+     * \param lowerLeft The lower left corner of the domain
+     * \param upperRight The upper right corner of the domain
+     * \param cellRes The number of cells in each direction
+     */
+    static std::unique_ptr<Grid> createCubeGrid(const GlobalPosition& lowerLeft,
+                                                const GlobalPosition& upperRight,
+                                                const std::array<unsigned, dim>& cellRes)
+    {
+        if constexpr (supportsDistributedConstruction())
+            return createDistributed_(lowerLeft, upperRight, cellRes, /*simplices=*/false);
+        else
+            return Dune::StructuredGridFactory<Grid>::createCubeGrid(lowerLeft, upperRight, cellRes);
+    }
+
+    /*!
+     * \brief Create a regular grid of simplices by splitting each cube into dim!
+     *        simplices.
+     *
+     * \param lowerLeft The lower left corner of the domain
+     * \param upperRight The upper right corner of the domain
+     * \param cellRes The number of cubes in each direction
+     */
+    static std::unique_ptr<Grid> createSimplexGrid(const GlobalPosition& lowerLeft,
+                                                   const GlobalPosition& upperRight,
+                                                   const std::array<unsigned, dim>& cellRes)
+    {
+        if constexpr (supportsDistributedConstruction())
+            return createDistributed_(lowerLeft, upperRight, cellRes, /*simplices=*/true);
+        else
+            return Dune::StructuredGridFactory<Grid>::createSimplexGrid(lowerLeft, upperRight, cellRes);
+    }
+
+    /*!
+     * \brief Returns the index box of the cells which are inserted by a given process.
+     *
+     * The box is half-open, i.e., the cells [first[d], second[d]) are contained in
+     * direction d. If there are more processes than cells, the box may be empty.
+     */
+    static IndexBox localBox(const std::array<unsigned, dim>& cellRes,
+                             int rank,
+                             int numRanks)
+    {
+        IndexBox box;
+        auto& [lower, upper] = box;
+        lower.fill(0);
+        upper = cellRes;
+
+        int rankBegin = 0;
+        int rankEnd = numRanks;
+        while (rankEnd - rankBegin > 1) {
+            unsigned axis = 0;
+            for (unsigned d = 1; d < dim; ++d)
+                if (upper[d] - lower[d] > upper[axis] - lower[axis])
+                    axis = d;
+
+            const int numBoxRanks = rankEnd - rankBegin;
+            const int numLowerRanks = numBoxRanks/2;
+            const unsigned split =
+                lower[axis]
+                + static_cast<unsigned>(static_cast<std::size_t>(upper[axis] - lower[axis])
+                                        *numLowerRanks/numBoxRanks);
+            if (rank < rankBegin + numLowerRanks) {
+                upper[axis] = split;
+                rankEnd = rankBegin + numLowerRanks;
+            }
+            else {
+                lower[axis] = split;
+                rankBegin += numLowerRanks;
+            }
+        }
+
+        return box;
+    }
+
+private:
+    static std::unique_ptr<Grid> createDistributed_(const GlobalPosition& lowerLeft,
+                                                    const GlobalPosition& upperRight,
+                                                    const std::array<unsigned, dim>& cellRes,
+                                                    bool simplices)
+    {
+        // the global vertex IDs of the grid factory are unsigned integers. this is
+        // checked for the whole grid, so all processes fail consistently.
+        const std::size_t maxNumVertices =
+            static_cast<std::size_t>(std::numeric_limits<unsigned>::max()) + 1;
+        std::size_t numVerticesTotal = 1;
+        for (unsigned d = 0; d < dim; ++d) {
+            const std::size_t numVerticesInDir = static_cast<std::size_t>(cellRes[d]) + 1;
+            if (numVerticesTotal > maxNumVertices/numVerticesInDir)
+                throw std::runtime_error("The cube grid has more than "
+                                         + std::to_string(maxNumVertices)
+                                         + " vertices, which cannot be identified by "
+                                         "the unsigned vertex IDs of the grid factory");
+            numVerticesTotal *= numVerticesInDir;
+        }
+
+        const auto& comm = Dune::MPIHelper::getCommunication();
+        const IndexBox box = localBox(cellRes, comm.rank(), comm.size());
+        const auto& [lower, upper] = box;
+
+        // the vertex lattice of the local sub-box
+        std::array<unsigned, dim> numLocalVertices;
+        std::size_t numLocalVerticesTotal = 1;
+        for (unsigned d = 0; d < dim; ++d) {
+            numLocalVertices[d] = (upper[d] > lower[d]) ? upper[d] - lower[d] + 1 : 0;
+            numLocalVerticesTotal *= numLocalVertices[d];
+        }
+
+        Dune::GridFactory<Grid> factory;
+        for (std::size_t localIdx = 0; localIdx < numLocalVerticesTotal; ++localIdx) {
+            std::size_t globalId = 0;
+            std::size_t globalStride = 1;
+            std::size_t remainder = localIdx;
+            GlobalPosition pos(0.0);
+            for (unsigned d = 0; d < dim; ++d) {
+                const unsigned idx = lower[d] + static_cast<unsigned>(remainder % numLocalVertices[d]);
+                remainder /= numLocalVertices[d];
+
+                pos[d] = lowerLeft[d] + (upperRight[d] - lowerLeft[d])*idx/cellRes[d];
+                globalId += idx*globalStride;
+                globalStride *= cellRes[d] + 1;
+            }
+            factory.insertVertex(pos, static_cast<unsigned>(globalId));
+        }
+
+        std::size_t numLocalCells = 1;
+        for (unsigned d = 0; d < dim; ++d)
+            numLocalCells *= upper[d] - lower[d];
+
+        std::vector<unsigned> corners(1 << dim);
+        std::vector<unsigned> simplexCorners(dim + 1);
+        for (std::size_t localIdx = 0; localIdx < numLocalCells; ++localIdx) {
+            // the local vertex index of the lower left corner of the cell
+            std::size_t baseVertexIdx = 0;
+            std::size_t vertexStride = 1;
+            std::size_t remainder = localIdx;
+            for (unsigned d = 0; d < dim; ++d) {
+                const unsigned cellsInDir = upper[d] - lower[d];
+                baseVertexIdx += (remainder % cellsInDir)*vertexStride;
+                remainder /= cellsInDir;
+                vertexStride *= numLocalVertices[d];
+            }
+
+            // the corners of a cube are numbered lexicographically in DUNE
+            for (unsigned cornerIdx = 0; cornerIdx < corners.size(); ++cornerIdx) {
+                std::size_t vertexIdx = baseVertexIdx;
+                std::size_t stride = 1;
+                for (unsigned d = 0; d < dim; ++d) {
+                    if (cornerIdx & (1 << d))
+                        vertexIdx += stride;
+                    stride *= numLocalVertices[d];
+                }
+                corners[cornerIdx] = static_cast<unsigned>(vertexIdx);
+            }
+
+            if (!simplices) {
+                factory.insertElement(Dune::GeometryTypes::cube(dim), corners);
+                continue;
+            }
+
+            // each permutation of the axes yields the simplex whose corners are
+            // reached by walking from the lower left to the upper right corner of
+            // the cube along the unit vectors in the order of the permutation. The
+            // simplices of odd permutations are negatively oriented, so two of their
+            // corners are swapped.
+            std::array<unsigned, dim> axes;
+            std::iota(axes.begin(), axes.end(), 0u);
+            do {
+                unsigned cornerBits = 0;
+                simplexCorners[0] = corners[cornerBits];
+                for (unsigned d = 0; d < dim; ++d) {
+                    cornerBits |= 1u << axes[d];
+                    simplexCorners[d + 1] = corners[cornerBits];
+                }
+
+                unsigned numInversions = 0;
+                for (unsigned d1 = 0; d1 < dim; ++d1)
+                    for (unsigned d2 = d1 + 1; d2 < dim; ++d2)
+                        numInversions += axes[d1] > axes[d2];
+                if (numInversions % 2 == 1)
+                    std::swap(simplexCorners[dim - 1], simplexCorners[dim]);
+
+                factory.insertElement(Dune::GeometryTypes::simplex(dim), simplexCorners);
+            } while (std::next_permutation(axes.begin(), axes.end()));
+        }
+
+        return std::unique_ptr<Grid>(factory.createGrid());
+    }
+};
+
+} // namespace Opm
+
+#endif
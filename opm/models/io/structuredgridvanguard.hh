@@ -28,6 +28,7 @@
 #define EWOMS_STRUCTURED_GRID_VANGUARD_HH
 
 #include <opm/models/io/basevanguard.hh>
+#include <opm/models/io/distributedcubegridfactory.hh>
 
 #include <opm/models/utils/basicparameters.hh>
 #include <opm/models/utils/basicproperties.hh>
@@ -45,7 +46,9 @@
 #include <dune/common/fvector.hh>
 #include <dune/common/version.hh>
 
+#include <array>
 #include <memory>
+#include <sstream>
 
 namespace Opm {
 
@@ -111,6 +114,9 @@ public:
         Parameters::Register<Parameters::GridGlobalRefinements>
             ("The number of global refinements of the grid "
              "executed after it was loaded");
+        Parameters::Register<Parameters::DistributedGridConstruction>
+            ("Let each process create only its part of the grid instead of creating "
+             "the whole grid on the first process");
         Parameters::Register<Parameters::DomainSizeX<Scalar>>
             ("The size of the domain in x direction");
         Parameters::Register<Parameters::CellsX>
@@ -151,21 +157,48 @@ public:
             cellRes[2] = Parameters::Get<Parameters::CellsZ>();
         }
 
-        std::stringstream dgffile;
-        dgffile << "DGF" << std::endl;
-        dgffile << "INTERVAL" << std::endl;
-        dgffile << lowerLeft  << std::endl;
-        dgffile << upperRight << std::endl;
-        dgffile << cellRes    << std::endl;
-        dgffile << "#" << std::endl;
-        dgffile << "GridParameter" << std::endl;
-        dgffile << "overlap 1" << std::endl;
-        dgffile << "#" << std::endl;
-        dgffile << "Simplex" << std::endl;
-        dgffile << "#" << std::endl;
-
-        // use DGF parser to create a grid from interval block
-        gridPtr_.reset( Dune::GridPtr< Grid >( dgffile ).release() );
+        // YaspGrid is always created in a distributed manner by the DGF parser, the
+        // grid factory of ALUGrid needs to be used explicitly to achieve this
+        if (DistributedCubeGridFactory<Grid>::supportsDistributedConstruction()
+            && Parameters::Get<Parameters::DistributedGridConstruction>())
+        {
+            using GlobalPosition = Dune::FieldVector<typename Grid::ctype, Grid::dimensionworld>;
+            GlobalPosition factoryLowerLeft(0.0);
+            GlobalPosition factoryUpperRight(0.0);
+            std::array<unsigned, dim> factoryCellRes;
+            for (unsigned i = 0; i < dim; ++i) {
+                factoryLowerLeft[i] = lowerLeft[i];
+                factoryUpperRight[i] = upperRight[i];
+                factoryCellRes[i] = static_cast<unsigned>(cellRes[i]);
+            }
+
+            using Factory = DistributedCubeGridFactory<Grid>;
+            if constexpr (Factory::isSimplexGrid())
+                gridPtr_ = Factory::createSimplexGrid(factoryLowerLeft,
+                                                      factoryUpperRight,
+                                                      factoryCellRes);
+            else
+                gridPtr_ = Factory::createCubeGrid(factoryLowerLeft,
+                                                   factoryUpperRight,
+                                                   factoryCellRes);
+        }
+        else {
+            std::stringstream dgffile;
+            dgffile << "DGF" << std::endl;
+            dgffile << "INTERVAL" << std::endl;
+            dgffile << lowerLeft  << std::endl;
+            dgffile << upperRight << std::endl;
+            dgffile << cellRes    << std::endl;
+            dgffile << "#" << std::endl;
+            dgffile << "GridParameter" << std::endl;
+            dgffile << "overlap 1" << std::endl;
+            dgffile << "#" << std::endl;
+            dgffile << "Simplex" << std::endl;
+            dgffile << "#" << std::endl;
+
+            // use DGF parser to create a grid from interval block
+            gridPtr_.reset( Dune::GridPtr< Grid >( dgffile ).release() );
+        }
 
         unsigned numRefinements = Parameters::Get<Parameters::GridGlobalRefinements>();
         gridPtr_->globalRefine(static_cast<int>(numRefinements));
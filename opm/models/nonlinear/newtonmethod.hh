@@ -41,6 +41,8 @@
 #include <opm/models/nonlinear/newtonmethodproperties.hh>
 #include <opm/models/nonlinear/nullconvergencewriter.hh>
 
+#include <opm/models/parallel/batchedreduction.hh>
+
 #include <opm/models/utils/timer.hh>
 #include <opm/models/utils/timerguard.hh>
 
@@ -48,6 +50,7 @@
 
 #include <iostream>
 #include <sstream>
+#include <string>
 
 #include <unistd.h>
 
@@ -114,6 +117,7 @@ public:
         , endIterMsgStream_(std::ostringstream::out)
         , linearSolver_(simulator)
         , comm_(Dune::MPIHelper::getCommunicator())
+        , iterationStatus_(comm_)
         , convergenceWriter_(asImp_())
     {
         lastError_ = 1e100;
@@ -299,6 +303,7 @@ public:
                 // something else in addition. TODO: should its costs be counted to
                 // the linearization or to the update?
                 updateTimer_.start();
+                asImp_().finishIterationStatus_();
                 asImp_().preSolve_(currentSolution, residual);
                 updateTimer_.stop();
 
@@ -325,9 +330,7 @@ public:
                 solveTimer_.start();
                 // solve A x = b, where b is the residual, A is its Jacobian and x is the
                 // update of the solution
-                linearSolver_.setMatrix(jacobian);
-                solutionUpdate = 0.0;
-                bool converged = linearSolver_.solve(solutionUpdate);
+                bool converged = asImp_().solveLinear_(solutionUpdate);
                 solveTimer_.stop();
 
                 if (!converged) {
@@ -367,7 +370,15 @@ public:
                 prePostProcessTimer_.start();
                 asImp_().endIteration_(nextSolution, currentSolution);
                 prePostProcessTimer_.stop();
+
+                // the failures of the update and of the post-processing make this
+                // iteration fail instead of being detected after the next
+                // linearization
+                asImp_().finishIterationStatus_();
             }
+
+            // check the status of the last iteration
+            asImp_().finishIterationStatus_();
         }
         catch (const Dune::Exception& e)
         {
@@ -478,6 +489,38 @@ public:
     void eraseMatrix()
     { linearSolver_.eraseMatrix(); }
 
+    /*!
+     * \brief Returns the object which reduces the status of a Newton iteration over
+     *        all processes.
+     *
+     * The values which are added before the linearization are reduced while the
+     * system is linearized, and their callbacks are called before the error of the
+     * iteration is computed. The values which are added after the linear system has
+     * been solved are reduced in a single collective operation at the end of the
+     * iteration.
+     */
+    BatchedReduction& iterationStatus()
+    { return iterationStatus_; }
+
+    /*!
+     * \brief Make the current iteration fail on all processes if a process did not
+     *        succeed in doing something.
+     *
+     * Instead of reducing the flag immediately, it is added to iterationStatus() and a
+     * NumericalProblem with the given message is thrown once the reduction is
+     * completed. This happens before the current iteration is finished, so the
+     * failure makes the current iteration fail.
+     */
+    void deferSuccessCheck(bool succeeded, const std::string& message)
+    {
+        iterationStatus_.min(succeeded ? 1.0 : 0.0,
+                             [this, message](double globalSucceeded)
+                             {
+                                 if (globalSucceeded < 1.0 && iterationFailure_.empty())
+                                     iterationFailure_ = message;
+                             });
+    }
+
     /*!
      * \brief Returns the linear solver backend object for external use.
      */
@@ -521,6 +564,10 @@ protected:
     {
         numIterations_ = 0;
 
+        // a reduction may still be pending if the last time step failed
+        iterationStatus_.discard();
+        iterationFailure_.clear();
+
         if (Parameters::Get<Parameters::NewtonWriteConvergence>()) {
             convergenceWriter_.beginTimeStep();
         }
@@ -533,7 +580,6 @@ protected:
     {
         // start with a clean message stream
         endIterMsgStream_.str("");
-        const auto& comm = simulator_.gridView().comm();
         bool succeeded = true;
         try {
             problem().beginIteration();
@@ -546,14 +592,46 @@ protected:
                       << "\n"  << std::flush;
         }
 
-        succeeded = comm.min(succeeded);
-
-        if (!succeeded)
-            throw NumericalProblem("pre processing of the problem failed");
+        // the status of the previous iteration and of the pre-processing is reduced
+        // while the linearization is done
+        deferSuccessCheck(succeeded, "pre processing of the problem failed");
+        iterationStatus_.start();
 
         lastError_ = error_;
     }
 
+    /*!
+     * \brief Complete the reduction of the iteration status and throw if a process
+     *        did not succeed.
+     */
+    void finishIterationStatus_()
+    {
+        iterationStatus_.finish();
+
+        if (!iterationFailure_.empty()) {
+            std::string message = std::move(iterationFailure_);
+            iterationFailure_.clear();
+            throw NumericalProblem(message);
+        }
+    }
+
+    /*!
+     * \brief Solve the linearized system of equations for the update of the
+     *        solution.
+     *
+     * The Jacobian matrix and the residual are the ones of the most recent
+     * linearization. The residual has already been passed to the linear solver.
+     *
+     * \param solutionUpdate The vector which receives the update of the solution
+     * \return true if the linear solver converged
+     */
+    bool solveLinear_(GlobalEqVector& solutionUpdate)
+    {
+        linearSolver_.setMatrix(model().linearizer().jacobian());
+        solutionUpdate = 0.0;
+        return linearSolver_.solve(solutionUpdate);
+    }
+
     /*!
      * \brief Linearize the global non-linear system of equations associated with the
      *        spatial domain.
@@ -625,7 +703,6 @@ protected:
         // loop over the auxiliary modules and ask them to post process the solution
         // vector.
         auto& model = simulator_.model();
-        const auto& comm = simulator_.gridView().comm();
         for (unsigned i = 0; i < model.numAuxiliaryModules(); ++i) {
             auto& auxMod = *model.auxiliaryModule(i);
 
@@ -641,10 +718,7 @@ protected:
                           << "\n"  << std::flush;
             }
 
-            succeeded = comm.min(succeeded);
-
-            if (!succeeded)
-                throw NumericalProblem("post processing of an auxilary equation failed");
+            deferSuccessCheck(succeeded, "post processing of an auxilary equation failed");
         }
     }
 
@@ -757,7 +831,6 @@ protected:
     {
         ++numIterations_;
 
-        const auto& comm = simulator_.gridView().comm();
         bool succeeded = true;
         try {
             problem().endIteration();
@@ -770,10 +843,7 @@ protected:
                       << "\n"  << std::flush;
         }
 
-        succeeded = comm.min(succeeded);
-
-        if (!succeeded)
-            throw NumericalProblem("post processing of the problem failed");
+        deferSuccessCheck(succeeded, "post processing of the problem failed");
 
         if (asImp_().verbose_()) {
             std::cout << "Newton iteration " << numIterations_ << ""
@@ -865,6 +935,10 @@ protected:
     // or MPI)
     CollectiveCommunication comm_;
 
+    // the global status of the Newton iterations which is reduced lazily
+    BatchedReduction iterationStatus_;
+    std::string iterationFailure_;
+
     // the object which writes the convergence behaviour of the Newton
     // method to disk
     ConvergenceWriter convergenceWriter_;
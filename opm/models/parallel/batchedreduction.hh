@@ -0,0 +1,221 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::BatchedReduction
+ */
+#ifndef EWOMS_BATCHED_REDUCTION_HH
+#define EWOMS_BATCHED_REDUCTION_HH
+
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Combines the global reductions of several scalar values into a single
+ *        non-blocking collective operation.
+ *
+ * The local values are added using min(), max() and sum(). Each of them takes a
+ * function which is called with the global value once the reduction has been
+ * completed. start() posts the reduction and finish() waits for it and calls the
+ * functions in the order in which the values have been added. Thus, the
+ * communication can be overlapped with other work, and the latency of the
+ * collective operation only needs to be paid once for all values.
+ *
+ * All processes must add the same kind of values in the same order and call start()
+ * and finish() at the same points of the program.
+ */
+class BatchedReduction
+{
+public:
+    using Callback = std::function<void(double)>;
+
+    template <class Communication>
+    explicit BatchedReduction([[maybe_unused]] const Communication& comm)
+    {
+#if HAVE_MPI
+        // sequential communication objects do not provide an MPI communicator
+        if constexpr (std::is_convertible_v<Communication, MPI_Comm>) {
+            if (comm.size() > 1)
+                mpiComm_ = comm;
+        }
+#endif
+    }
+
+    BatchedReduction(const BatchedReduction&) = delete;
+    BatchedReduction& operator=(const BatchedReduction&) = delete;
+
+    ~BatchedReduction()
+    { wait_(); }
+
+    /*!
+     * \brief Add a value for which the minimum over all processes is computed.
+     */
+    void min(double value, Callback callback)
+    { add_(-value, /*isSum=*/false, /*negate=*/true, std::move(callback)); }
+
+    /*!
+     * \brief Add a value for which the maximum over all processes is computed.
+     */
+    void max(double value, Callback callback)
+    { add_(value, /*isSum=*/false, /*negate=*/false, std::move(callback)); }
+
+    /*!
+     * \brief Add a value for which the sum over all processes is computed.
+     */
+    void sum(double value, Callback callback)
+    { add_(value, /*isSum=*/true, /*negate=*/false, std::move(callback)); }
+
+    /*!
+     * \brief Returns true if no values have been added since the last reduction.
+     */
+    bool empty() const
+    { return entries_.empty(); }
+
+    /*!
+     * \brief Returns true if the reduction has been started but not finished.
+     */
+    bool started() const
+    { return started_; }
+
+    /*!
+     * \brief Start the reduction of all values added so far.
+     *
+     * This is a collective operation. Values cannot be added until finish() has been
+     * called.
+     */
+    void start()
+    {
+        if (started_)
+            return;
+        started_ = true;
+
+#if HAVE_MPI
+        if (mpiComm_ == MPI_COMM_NULL)
+            return;
+
+        // minima are stored as negated maxima, so at most two reductions are required
+        if (!maxValues_.empty())
+            MPI_Iallreduce(MPI_IN_PLACE, maxValues_.data(), static_cast<int>(maxValues_.size()),
+                           MPI_DOUBLE, MPI_MAX, mpiComm_, &requests_[0]);
+        if (!sumValues_.empty())
+            MPI_Iallreduce(MPI_IN_PLACE, sumValues_.data(), static_cast<int>(sumValues_.size()),
+                           MPI_DOUBLE, MPI_SUM, mpiComm_, &requests_[1]);
+#endif
+    }
+
+    /*!
+     * \brief Complete the reduction and pass the global values to the callbacks.
+     *
+     * The reduction is started if this has not been done yet. Afterwards, new values
+     * can be added.
+     */
+    void finish()
+    {
+        start();
+        wait_();
+
+        // clear the batch before calling the callbacks, so that they may throw
+        auto entries = std::move(entries_);
+        auto maxValues = std::move(maxValues_);
+        auto sumValues = std::move(sumValues_);
+        clear_();
+
+        for (const auto& entry : entries) {
+            double value = entry.isSum ? sumValues[entry.index] : maxValues[entry.index];
+            entry.callback(entry.negate ? -value : value);
+        }
+    }
+
+    /*!
+     * \brief Complete a reduction which has been started and throw away all values
+     *        without calling the callbacks.
+     *
+     * This is required to get all processes into a consistent state again, e.g.
+     * after an exception.
+     */
+    void discard()
+    {
+        wait_();
+        clear_();
+    }
+
+private:
+    struct Entry
+    {
+        bool isSum;
+        bool negate;
+        std::size_t index;
+        Callback callback;
+    };
+
+    void add_(double value, bool isSum, bool negate, Callback callback)
+    {
+        if (started_)
+            throw std::logic_error("Values cannot be added to a batched reduction which "
+                                   "has already been started");
+
+        auto& values = isSum ? sumValues_ : maxValues_;
+        entries_.push_back(Entry{isSum, negate, values.size(), std::move(callback)});
+        values.push_back(value);
+    }
+
+    void wait_()
+    {
+#if HAVE_MPI
+        if (requests_[0] != MPI_REQUEST_NULL || requests_[1] != MPI_REQUEST_NULL)
+            MPI_Waitall(2, requests_, MPI_STATUSES_IGNORE);
+#endif
+    }
+
+    void clear_()
+    {
+        entries_.clear();
+        maxValues_.clear();
+        sumValues_.clear();
+        started_ = false;
+    }
+
+    std::vector<Entry> entries_;
+    std::vector<double> maxValues_;
+    std::vector<double> sumValues_;
+    bool started_{false};
+
+#if HAVE_MPI
+    MPI_Comm mpiComm_{MPI_COMM_NULL};
+    MPI_Request requests_[2]{MPI_REQUEST_NULL, MPI_REQUEST_NULL};
+#endif
+};
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,113 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::FirstTouchAllocator
+ */
+#ifndef EWOMS_FIRST_TOUCH_ALLOCATOR_HH
+#define EWOMS_FIRST_TOUCH_ALLOCATOR_HH
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <cstddef>
+#include <memory>
+
+namespace Opm {
+
+/*!
+ * \brief An allocator which lets all threads touch the memory of large arrays
+ *        before the array elements are constructed.
+ *
+ * On NUMA systems, a memory page is placed on the memory node of the thread which
+ * writes to it first. If the elements of a large array are constructed by the main
+ * thread, all of its pages end up on a single node and the memory bandwidth of the
+ * other nodes cannot be used when the array is accessed by all threads. This
+ * allocator forwards the allocation to another allocator and then writes to each
+ * page of the allocated memory using a static OpenMP schedule.
+ *
+ * Note that this only spreads the pages over the NUMA nodes. It does not place them
+ * on the node of the thread which later accesses them, because the element loops
+ * distribute the elements to the threads dynamically (see ThreadedEntityIterator).
+ */
+template <class Allocator>
+class FirstTouchAllocator : public Allocator
+{
+    using Traits = std::allocator_traits<Allocator>;
+
+public:
+    using value_type = typename Traits::value_type;
+    using pointer = typename Traits::pointer;
+    using size_type = typename Traits::size_type;
+
+    template <class U>
+    struct rebind
+    { using other = FirstTouchAllocator<typename Traits::template rebind_alloc<U>>; };
+
+    FirstTouchAllocator() noexcept = default;
+
+    template <class OtherAllocator>
+    FirstTouchAllocator(const FirstTouchAllocator<OtherAllocator>& other) noexcept
+        : Allocator(static_cast<const OtherAllocator&>(other))
+    {}
+
+    pointer allocate(size_type size)
+    {
+        pointer ptr = Allocator::allocate(size);
+        touch_(static_cast<void*>(ptr), size*sizeof(value_type));
+        return ptr;
+    }
+
+private:
+    static void touch_([[maybe_unused]] void* ptr, [[maybe_unused]] std::size_t numBytes)
+    {
+#ifdef _OPENMP
+        // for small arrays and inside of parallel regions, this is not worth the effort
+        constexpr std::size_t pageSize = 4096;
+        constexpr std::size_t minBytes = 256*pageSize;
+        if (numBytes < minBytes || omp_in_parallel() || omp_get_max_threads() < 2)
+            return;
+
+        // the memory is written through a volatile pointer to prevent the compiler
+        // from eliminating the stores
+        volatile char* bytes = static_cast<volatile char*>(ptr);
+        const long numPages = static_cast<long>((numBytes + pageSize - 1)/pageSize);
+#pragma omp parallel for schedule(static)
+        for (long pageIdx = 0; pageIdx < numPages; ++pageIdx)
+            bytes[pageIdx*pageSize] = 0;
+#endif
+    }
+};
+
+template <class Allocator1, class Allocator2>
+bool operator==(const FirstTouchAllocator<Allocator1>& a, const FirstTouchAllocator<Allocator2>& b) noexcept
+{ return static_cast<const Allocator1&>(a) == static_cast<const Allocator2&>(b); }
+
+template <class Allocator1, class Allocator2>
+bool operator!=(const FirstTouchAllocator<Allocator1>& a, const FirstTouchAllocator<Allocator2>& b) noexcept
+{ return !(a == b); }
+
+} // namespace Opm
+
+#endif
@@ -0,0 +1,325 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::GridHaloExchange
+ */
+#ifndef EWOMS_GRID_HALO_EXCHANGE_HH
+#define EWOMS_GRID_HALO_EXCHANGE_HH
+
+#include <dune/grid/common/datahandleif.hh>
+#include <dune/grid/common/gridenums.hh>
+#include <dune/common/version.hh>
+
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+
+/*!
+ * \brief Exchanges the values attached to the DOFs on the process borders using
+ *        precomputed index lists and persistent MPI requests.
+ *
+ * In contrast to the GridCommHandle* data handles, the grid's communicate() method
+ * is only used once to determine which DOFs are sent to and received from which
+ * peer process. After this, each exchange copies the values of the DOFs into
+ * contiguous buffers, starts the persistent requests of all peer processes at once
+ * and combines the received values with the ones of the DOFs. No mapper lookups and no calls of
+ * gather() and scatter() for individual entities are required.
+ *
+ * The values are sent as raw bytes. Like for Dune's message buffers, ValueType
+ * must thus be bitwise copyable.
+ *
+ * The communication pattern must be recreated by calling init() whenever the grid
+ * changes.
+ */
+template <class ValueType>
+class GridHaloExchange
+{
+public:
+    GridHaloExchange() = default;
+    GridHaloExchange(const GridHaloExchange&) = delete;
+    GridHaloExchange& operator=(const GridHaloExchange&) = delete;
+
+    ~GridHaloExchange()
+    { freeRequests_(); }
+
+    /*!
+     * \brief Determine the communication pattern for the DOFs of a grid view.
+     *
+     * This is a collective operation.
+     *
+     * \tparam commCodim The codimension of the entities to which the DOFs are attached
+     * \param gridView The grid view which is used for the communication
+     * \param mapper The mapper from the entities to the DOF indices
+     * \param interface The communication interface, e.g., InteriorBorder_All_Interface
+     */
+    template <int commCodim, class GridView, class EntityMapper>
+    void init(const GridView& gridView,
+              const EntityMapper& mapper,
+              Dune::InterfaceType interface)
+    {
+        freeRequests_();
+        sendPeers_.clear();
+        sendOffsets_.assign(1, 0);
+        sendIndices_.clear();
+        recvPeers_.clear();
+        recvOffsets_.assign(1, 0);
+        recvIndices_.clear();
+
+        const auto& comm = gridView.comm();
+        if (comm.size() == 1)
+            return;
+
+#if HAVE_MPI
+        // grids which are always sequential do not provide an MPI communicator
+        if constexpr (std::is_convertible_v<std::decay_t<decltype(comm)>, MPI_Comm>)
+            mpiComm_ = comm;
+        else
+            return;
+
+        // determine the local indices of the received DOFs and their indices on the
+        // sending process
+        IndexRecordHandle_<EntityMapper, commCodim> recordHandle(mapper, comm.rank());
+        gridView.communicate(recordHandle, interface, Dune::ForwardCommunication);
+
+        std::vector<int> numRecv(comm.size(), 0);
+        std::vector<int> numSend(comm.size(), 0);
+        for (const auto& [peerRank, indices] : recordHandle.received()) {
+            numRecv[peerRank] = static_cast<int>(indices.size());
+            recvPeers_.push_back(peerRank);
+            for (const auto& [peerIdx, localIdx] : indices)
+                recvIndices_.push_back(localIdx);
+            recvOffsets_.push_back(recvIndices_.size());
+        }
+        MPI_Alltoall(numRecv.data(), 1, MPI_INT, numSend.data(), 1, MPI_INT, mpiComm_);
+
+        for (int peerRank = 0; peerRank < comm.size(); ++peerRank) {
+            if (numSend[peerRank] == 0)
+                continue;
+            sendPeers_.push_back(peerRank);
+            sendOffsets_.push_back(sendOffsets_.back() + static_cast<std::size_t>(numSend[peerRank]));
+        }
+        sendIndices_.resize(sendOffsets_.back());
+
+        // tell each sending process which of its DOFs we receive in which order
+        std::vector<std::vector<int>> peerIndices;
+        std::vector<MPI_Request> setupRequests;
+        for (const auto& [peerRank, indices] : recordHandle.received()) {
+            auto& buffer = peerIndices.emplace_back();
+            for (const auto& [peerIdx, localIdx] : indices)
+                buffer.push_back(peerIdx);
+
+            MPI_Request& request = setupRequests.emplace_back();
+            MPI_Isend(buffer.data(), static_cast<int>(buffer.size()), MPI_INT,
+                      peerRank, setupTag_, mpiComm_, &request);
+        }
+        for (std::size_t i = 0; i < sendPeers_.size(); ++i) {
+            MPI_Request& request = setupRequests.emplace_back();
+            MPI_Irecv(sendIndices_.data() + sendOffsets_[i],
+                      static_cast<int>(sendOffsets_[i + 1] - sendOffsets_[i]), MPI_INT,
+                      sendPeers_[i], setupTag_, mpiComm_, &request);
+        }
+        MPI_Waitall(static_cast<int>(setupRequests.size()), setupRequests.data(), MPI_STATUSES_IGNORE);
+
+        // create the persistent requests. the buffers are never resized afterwards,
+        // so the addresses stay valid
+        sendBuffer_.resize(sendIndices_.size());
+        recvBuffer_.resize(recvIndices_.size());
+        for (std::size_t i = 0; i < sendPeers_.size(); ++i) {
+            MPI_Request& request = requests_.emplace_back();
+            MPI_Send_init(sendBuffer_.data() + sendOffsets_[i],
+                          static_cast<int>((sendOffsets_[i + 1] - sendOffsets_[i])*sizeof(ValueType)),
+                          MPI_BYTE, sendPeers_[i], exchangeTag_, mpiComm_, &request);
+        }
+        for (std::size_t i = 0; i < recvPeers_.size(); ++i) {
+            MPI_Request& request = requests_.emplace_back();
+            MPI_Recv_init(recvBuffer_.data() + recvOffsets_[i],
+                          static_cast<int>((recvOffsets_[i + 1] - recvOffsets_[i])*sizeof(ValueType)),
+                          MPI_BYTE, recvPeers_[i], exchangeTag_, mpiComm_, &request);
+        }
+#endif
+    }
+
+    /*!
+     * \brief Overwrite the values of the receiving DOFs by the ones of the sending
+     *        process, like GridCommHandleGhostSync.
+     *
+     * This is a collective operation.
+     */
+    template <class Container>
+    void copy(Container& container)
+    { exchange_(container, [](auto& local, const auto& remote) { local = remote; }); }
+
+    /*!
+     * \brief Add the values of the sending DOFs to the ones of the receiving DOFs,
+     *        like GridCommHandleSum.
+     *
+     * This is a collective operation.
+     */
+    template <class Container>
+    void sum(Container& container)
+    { exchange_(container, [](auto& local, const auto& remote) { local += remote; }); }
+
+    /*!
+     * \brief Take the maximum of the sending and receiving DOFs, like GridCommHandleMax.
+     *
+     * This is a collective operation.
+     */
+    template <class Container>
+    void max(Container& container)
+    { exchange_(container, [](auto& local, const auto& remote) { local = std::max(local, remote); }); }
+
+    /*!
+     * \brief Take the minimum of the sending and receiving DOFs, like GridCommHandleMin.
+     *
+     * This is a collective operation.
+     */
+    template <class Container>
+    void min(Container& container)
+    { exchange_(container, [](auto& local, const auto& remote) { local = std::min(local, remote); }); }
+
+    /*!
+     * \brief Returns the number of DOFs which are sent to other processes.
+     */
+    std::size_t numSendDof() const
+    { return sendIndices_.size(); }
+
+    /*!
+     * \brief Returns the number of DOFs which are received from other processes.
+     */
+    std::size_t numRecvDof() const
+    { return recvIndices_.size(); }
+
+private:
+    template <class Container, class Combine>
+    void exchange_([[maybe_unused]] Container& container,
+                   [[maybe_unused]] Combine combine)
+    {
+#if HAVE_MPI
+        if (requests_.empty())
+            return;
+
+        for (std::size_t i = 0; i < sendIndices_.size(); ++i)
+            sendBuffer_[i] = container[sendIndices_[i]];
+
+        MPI_Startall(static_cast<int>(requests_.size()), requests_.data());
+        MPI_Waitall(static_cast<int>(requests_.size()), requests_.data(), MPI_STATUSES_IGNORE);
+
+        for (std::size_t i = 0; i < recvIndices_.size(); ++i)
+            combine(container[recvIndices_[i]], recvBuffer_[i]);
+#endif
+    }
+
+#if HAVE_MPI
+    // sends the rank and the DOF index of each entity, so that the receiving
+    // process knows which entities are sent by which process.
+    template <class EntityMapper, int commCodim>
+    class IndexRecordHandle_
+        : public Dune::CommDataHandleIF<IndexRecordHandle_<EntityMapper, commCodim>, int>
+    {
+    public:
+        IndexRecordHandle_(const EntityMapper& mapper, int rank)
+            : mapper_(mapper), rank_(rank)
+        {}
+
+        bool contains(int, int codim) const
+        { return codim == commCodim; }
+
+#if DUNE_VERSION_LT(DUNE_GRID, 2, 8)
+        bool fixedsize(int, int) const
+#else
+        bool fixedSize(int, int) const
+#endif
+        { return true; }
+
+        template <class EntityType>
+        size_t size(const EntityType&) const
+        { return 2; }
+
+        template <class MessageBufferImp, class EntityType>
+        void gather(MessageBufferImp& buff, const EntityType& e) const
+        {
+            buff.write(rank_);
+            buff.write(static_cast<int>(mapper_.index(e)));
+        }
+
+        template <class MessageBufferImp, class EntityType>
+        void scatter(MessageBufferImp& buff, const EntityType& e, size_t)
+        {
+            int peerRank;
+            int peerIdx;
+            buff.read(peerRank);
+            buff.read(peerIdx);
+            received_[peerRank].emplace_back(peerIdx, static_cast<int>(mapper_.index(e)));
+        }
+
+        const std::map<int, std::vector<std::pair<int, int>>>& received() const
+        { return received_; }
+
+    private:
+        const EntityMapper& mapper_;
+        int rank_;
+        std::map<int, std::vector<std::pair<int, int>>> received_;
+    };
+
+    static constexpr int setupTag_ = 4711;
+    static constexpr int exchangeTag_ = 4712;
+#endif
+
+    void freeRequests_()
+    {
+#if HAVE_MPI
+        for (auto& request : requests_)
+            MPI_Request_free(&request);
+        requests_.clear();
+#endif
+    }
+
+    std::vector<int> sendPeers_;
+    std::vector<std::size_t> sendOffsets_{0};
+    std::vector<int> sendIndices_;
+    std::vector<ValueType> sendBuffer_;
+
+    std::vector<int> recvPeers_;
+    std::vector<std::size_t> recvOffsets_{0};
+    std::vector<int> recvIndices_;
+    std::vector<ValueType> recvBuffer_;
+
+#if HAVE_MPI
+    MPI_Comm mpiComm_{MPI_COMM_NULL};
+    std::vector<MPI_Request> requests_;
+#endif
+};
+
+} // namespace Opm
+
+#endif
@@ -81,15 +81,18 @@ public:
 
     /*!
      * \brief Send the buffer asyncronously to a peer process.
+     *
+     * Messages which may be in flight at the same time as other messages between the
+     * same pair of processes should use a distinct tag.
      */
-    void send([[maybe_unused]] unsigned peerRank)
+    void send([[maybe_unused]] unsigned peerRank, [[maybe_unused]] int tag = 0)
     {
 #if HAVE_MPI
         MPI_Isend(data_,
                   static_cast<int>(mpiDataSize_),
                   mpiDataType_,
                   static_cast<int>(peerRank),
-                  0, // tag
+                  tag,
                   MPI_COMM_WORLD,
                   &mpiRequest_);
 #endif
@@ -108,14 +111,14 @@ public:
     /*!
      * \brief Receive the buffer syncronously from a peer rank
      */
-    void receive([[maybe_unused]] unsigned peerRank)
+    void receive([[maybe_unused]] unsigned peerRank, [[maybe_unused]] int tag = 0)
     {
 #if HAVE_MPI
         MPI_Recv(data_,
                  static_cast<int>(mpiDataSize_),
                  mpiDataType_,
                  static_cast<int>(peerRank),
-                 0, // tag
+                 tag,
                  MPI_COMM_WORLD,
                  MPI_STATUS_IGNORE);
 #endif // HAVE_MPI
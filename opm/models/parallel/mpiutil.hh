@@ -30,6 +30,7 @@
 #include <dune/common/parallel/mpitraits.hh>
 
 #include <cassert>
+#include <cstdlib>
 #include <numeric>
 #include <string>
 #include <vector>
@@ -189,6 +190,45 @@ namespace Opm
         return ret;
     }
 
+    /// Returns true if the master thread of a process may call MPI while the other
+    /// threads are running, i.e., if MPI provides at least MPI_THREAD_FUNNELED.
+    inline bool mpiSupportsFunneledThreads()
+    {
+        int initialized = 0;
+        MPI_Initialized(&initialized);
+        if (!initialized) {
+            return true;
+        }
+
+        int provided = MPI_THREAD_SINGLE;
+        MPI_Query_thread(&provided);
+        return provided >= MPI_THREAD_FUNNELED;
+    }
+
+    /// Initializes MPI such that the master thread of a process may call MPI while
+    /// the other threads are running. Dune::MPIHelper uses MPI_Init, so this must be
+    /// called before it. If MPI is initialized here, it is also finalized on exit.
+    /// Returns true if the MPI library provides MPI_THREAD_FUNNELED.
+    inline bool initMpiFunneledThreads(int& argc, char**& argv)
+    {
+        int initialized = 0;
+        MPI_Initialized(&initialized);
+        if (initialized) {
+            return mpiSupportsFunneledThreads();
+        }
+
+        int provided = MPI_THREAD_SINGLE;
+        MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+        std::atexit([]() {
+            int finalized = 0;
+            MPI_Finalized(&finalized);
+            if (!finalized) {
+                MPI_Finalize();
+            }
+        });
+        return provided >= MPI_THREAD_FUNNELED;
+    }
+
 } // namespace Opm
 
 #else // HAVE_MPI
@@ -203,6 +243,16 @@ namespace Opm
             return { local_string };
         }
     }
+
+    inline bool mpiSupportsFunneledThreads()
+    {
+        return true;
+    }
+
+    inline bool initMpiFunneledThreads(int&, char**&)
+    {
+        return true;
+    }
 } // namespace Opm
 
 #endif // HAVE_MPI
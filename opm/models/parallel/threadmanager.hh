@@ -37,6 +37,23 @@
 
 #include <dune/common/version.hh>
 
+#ifdef __linux__
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#if HAVE_MPI
+#include <mpi.h>
+#endif
+
+#include <cstddef>
+#include <fstream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
 namespace Opm {
 
 /*!
@@ -63,6 +80,11 @@ public:
         Parameters::Register<Parameters::ThreadsPerProcess>
             ("The maximum number of threads to be instantiated per process "
              "('-1' means 'automatic')");
+        Parameters::Register<Parameters::ThreadPinning>
+            ("How the threads are bound to the CPUs of the process: 'none', 'compact' "
+             "(fill the NUMA nodes one after the other) or 'scatter' (distribute the "
+             "threads round-robin over the NUMA nodes). If the processes may run on "
+             "all CPUs of a node, the processes of a node use disjoint CPUs");
     }
 
     /*!
@@ -110,6 +132,37 @@ public:
         // get the number of threads which are used in the end.
         numThreads_ = omp_get_max_threads();
 #endif
+
+        detectTopology_();
+
+        if (queryCommandLineParameter) {
+            pinning_ = Parameters::Get<Parameters::ThreadPinning>();
+            if (pinning_ != "none" && pinning_ != "compact" && pinning_ != "scatter")
+                throw std::invalid_argument("Unknown thread pinning mode '"+pinning_+"'. "
+                                            "Valid values are 'none', 'compact' and 'scatter'");
+            if (pinning_ != "none")
+                pinThreads_();
+        }
+    }
+
+    /*!
+     * \brief Return the number of NUMA nodes which contain CPUs the process may run on.
+     */
+    static unsigned numNumaNodes()
+    { return static_cast<unsigned>(numaNodes_.size()); }
+
+    /*!
+     * \brief Print the detected NUMA topology and the placement of the threads.
+     */
+    static void printTopology(std::ostream& os)
+    {
+        os << "Thread topology: " << numThreads_ << " thread(s) on "
+           << numaNodes_.size() << " NUMA node(s), pinning: " << pinning_ << "\n";
+        for (std::size_t nodeIdx = 0; nodeIdx < numaNodes_.size(); ++nodeIdx)
+            os << "  NUMA node " << nodeIdx << ": CPUs " << cpuList_(numaNodes_[nodeIdx]) << "\n";
+        if (!threadCpus_.empty())
+            os << "  CPUs of the threads: " << cpuList_(threadCpus_, /*compress=*/false) << "\n";
+        os << std::flush;
     }
 
     /*!
@@ -131,11 +184,175 @@ public:
     }
 
 private:
+    // determine the CPUs the process may run on and group them by NUMA node
+    static void detectTopology_()
+    {
+        numaNodes_.clear();
+
+#ifdef __linux__
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0)
+            return;
+
+        // the NUMA nodes are not necessarily numbered contiguously
+        for (int nodeIdx = 0; nodeIdx < CPU_SETSIZE; ++nodeIdx) {
+            std::ifstream cpuListFile("/sys/devices/system/node/node"
+                                      + std::to_string(nodeIdx) + "/cpulist");
+            if (!cpuListFile)
+                continue;
+
+            std::string cpuList;
+            std::getline(cpuListFile, cpuList);
+            std::vector<int> nodeCpus;
+            for (int cpu : parseCpuList_(cpuList))
+                if (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed))
+                    nodeCpus.push_back(cpu);
+            if (!nodeCpus.empty())
+                numaNodes_.push_back(nodeCpus);
+        }
+
+        // without NUMA information, all CPUs belong to a single node
+        if (numaNodes_.empty()) {
+            std::vector<int> cpus;
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                if (CPU_ISSET(cpu, &allowed))
+                    cpus.push_back(cpu);
+            numaNodes_.push_back(cpus);
+        }
+#endif
+    }
+
+    // bind each thread of the OpenMP thread pool to a single CPU
+    static void pinThreads_()
+    {
+        threadCpus_.clear();
+#if defined(_OPENMP) && defined(__linux__)
+        // the node-local rank is determined by a collective operation, so it is
+        // queried on all processes
+        const std::size_t nodeLocalRank = nodeLocalRank_();
+        if (numaNodes_.empty())
+            return;
+
+        // the order in which the CPUs are assigned to the threads
+        std::vector<int> cpuOrder;
+        if (pinning_ == "compact") {
+            for (const auto& nodeCpus : numaNodes_)
+                cpuOrder.insert(cpuOrder.end(), nodeCpus.begin(), nodeCpus.end());
+        }
+        else {
+            for (std::size_t i = 0; cpuOrder.size() < numCpus_(); ++i)
+                for (const auto& nodeCpus : numaNodes_)
+                    if (i < nodeCpus.size())
+                        cpuOrder.push_back(nodeCpus[i]);
+        }
+
+        // if the launcher did not restrict the processes to different CPUs, the
+        // processes of a node would bind their threads to the same CPUs. In this
+        // case, the threads of each process start after the ones of the processes
+        // with a lower rank on the same node. If the inherited affinity mask is
+        // narrower than the node, the processes are already separated.
+        std::size_t offset = 0;
+        const long numOnlineCpus = sysconf(_SC_NPROCESSORS_ONLN);
+        if (numOnlineCpus > 0 && numCpus_() >= static_cast<std::size_t>(numOnlineCpus))
+            offset = nodeLocalRank*static_cast<std::size_t>(numThreads_);
+
+        threadCpus_.resize(numThreads_);
+        bool failed = false;
+#pragma omp parallel num_threads(numThreads_) reduction(||:failed)
+        {
+            const int cpu = cpuOrder[(offset + omp_get_thread_num()) % cpuOrder.size()];
+            cpu_set_t cpuSet;
+            CPU_ZERO(&cpuSet);
+            CPU_SET(cpu, &cpuSet);
+            failed = sched_setaffinity(0, sizeof(cpuSet), &cpuSet) != 0;
+            threadCpus_[omp_get_thread_num()] = cpu;
+        }
+
+        if (failed)
+            throw std::runtime_error("Could not bind the threads to the CPUs");
+#endif
+    }
+
+    // the rank of the process among the processes which run on the same node
+    static std::size_t nodeLocalRank_()
+    {
+#if HAVE_MPI
+        int initialized = 0;
+        MPI_Initialized(&initialized);
+        if (!initialized)
+            return 0;
+
+        MPI_Comm nodeComm;
+        MPI_Comm_split_type(MPI_COMM_WORLD, MPI_COMM_TYPE_SHARED, /*key=*/0,
+                            MPI_INFO_NULL, &nodeComm);
+        int nodeRank = 0;
+        MPI_Comm_rank(nodeComm, &nodeRank);
+        MPI_Comm_free(&nodeComm);
+        return static_cast<std::size_t>(nodeRank);
+#else
+        return 0;
+#endif
+    }
+
+    static std::size_t numCpus_()
+    {
+        std::size_t result = 0;
+        for (const auto& nodeCpus : numaNodes_)
+            result += nodeCpus.size();
+        return result;
+    }
+
+    // parse a CPU list in the format used by the Linux kernel, e.g. "0-15,32-47"
+    static std::vector<int> parseCpuList_(const std::string& cpuList)
+    {
+        std::vector<int> result;
+        std::istringstream iss(cpuList);
+        std::string range;
+        while (std::getline(iss, range, ',')) {
+            if (range.empty())
+                continue;
+            const auto dashPos = range.find('-');
+            const int first = std::stoi(range.substr(0, dashPos));
+            const int last = dashPos == std::string::npos ? first : std::stoi(range.substr(dashPos + 1));
+            for (int cpu = first; cpu <= last; ++cpu)
+                result.push_back(cpu);
+        }
+        return result;
+    }
+
+    // the inverse of parseCpuList_()
+    static std::string cpuList_(const std::vector<int>& cpus, bool compress = true)
+    {
+        std::string result;
+        for (std::size_t i = 0; i < cpus.size(); ++i) {
+            std::size_t j = i;
+            while (compress && j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1)
+                ++j;
+            if (!result.empty())
+                result += ",";
+            result += std::to_string(cpus[i]);
+            if (j > i)
+                result += "-" + std::to_string(cpus[j]);
+            i = j;
+        }
+        return result;
+    }
+
     static int numThreads_;
+    static std::string pinning_;
+    static std::vector<std::vector<int>> numaNodes_;
+    static std::vector<int> threadCpus_;
 };
 
 template <class TypeTag>
 int ThreadManager<TypeTag>::numThreads_ = 1;
+template <class TypeTag>
+std::string ThreadManager<TypeTag>::pinning_ = "none";
+template <class TypeTag>
+std::vector<std::vector<int>> ThreadManager<TypeTag>::numaNodes_;
+template <class TypeTag>
+std::vector<int> ThreadManager<TypeTag>::threadCpus_;
 } // namespace Opm
 
 #endif
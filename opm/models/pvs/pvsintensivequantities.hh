@@ -132,7 +132,7 @@ public:
 
         // calculate capillary pressure
         const MaterialLawParams& materialParams =
-            problem.materialLawParams(elemCtx, dofIdx, timeIdx);
+            problem.storedMaterialLawParams(elemCtx, dofIdx, timeIdx);
         EvalPhaseVector pC;
         MaterialLaw::capillaryPressures(pC, materialParams, fluidState_);
 
@@ -236,11 +236,11 @@ public:
                 relativePermeability_[phaseIdx] / fluidState().viscosity(phaseIdx);
 
         // porosity
-        porosity_ = problem.porosity(elemCtx, dofIdx, timeIdx);
+        porosity_ = problem.storedPorosity(elemCtx, dofIdx, timeIdx);
         Opm::Valgrind::CheckDefined(porosity_);
 
         // intrinsic permeability
-        intrinsicPerm_ = problem.intrinsicPermeability(elemCtx, dofIdx, timeIdx);
+        intrinsicPerm_ = problem.storedIntrinsicPermeability(elemCtx, dofIdx, timeIdx);
 
         // update the quantities specific for the velocity model
         FluxIntensiveQuantities::update_(elemCtx, dofIdx, timeIdx);
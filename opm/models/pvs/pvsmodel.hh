@@ -456,6 +456,10 @@ public:
     /*!
      * \brief Return true if the primary variables were switched for
      *        at least one vertex after the last timestep.
+     *
+     * The number of switched vertices is summed over all processes at the end of
+     * each Newton iteration, so this refers to the most recent completed iteration
+     * on all processes.
      */
     bool switched() const
     { return numSwitched_ > 0; }
@@ -505,7 +509,9 @@ public:
      */
     void switchPrimaryVars_()
     {
-        numSwitched_ = 0;
+        // numSwitched_ is only set to the global number of switched DOFs once the
+        // status of the iteration has been reduced
+        unsigned numLocalSwitched = 0;
 
         int succeeded;
         try {
@@ -542,7 +548,7 @@ public:
                                                  intQuants.fluidState(),
                                                  oldPhasePresence,
                                                  priVars);
-                        ++numSwitched_;
+                        ++numLocalSwitched;
                     }
                 }
             }
@@ -556,19 +562,23 @@ public:
                       << "\n"  << std::flush;
             succeeded = 0;
         }
-        succeeded = this->simulator_.gridView().comm().min(succeeded);
-
-        if (!succeeded)
-            throw NumericalProblem("A process did not succeed in adapting the primary variables");
+        // the flags are reduced together with the other status values of the Newton
+        // iteration while the next iteration is linearized
+        auto& newtonMethod = this->simulator_.model().newtonMethod();
+        newtonMethod.deferSuccessCheck(succeeded,
+                                       "A process did not succeed in adapting the primary variables");
 
         // make sure that if there was a variable switch in an
         // other partition we will also set the switch flag
         // for our partition.
-        numSwitched_ = this->gridView_.comm().sum(numSwitched_);
-
-        if (verbosity_ > 0)
-            this->simulator_.model().newtonMethod().endIterMsg()
-                << ", num switched=" << numSwitched_;
+        newtonMethod.iterationStatus().sum(numLocalSwitched,
+                                           [this](double globalNumSwitched)
+                                           {
+                                               numSwitched_ = static_cast<unsigned>(globalNumSwitched);
+                                               if (verbosity_ > 0)
+                                                   this->simulator_.model().newtonMethod().endIterMsg()
+                                                       << ", num switched=" << numSwitched_;
+                                           });
     }
 
     template <class FluidState>
@@ -45,6 +45,12 @@ struct DomainSizeY { static constexpr Scalar value = 1.0; };
 template<class Scalar>
 struct DomainSizeZ { static constexpr Scalar value = 1.0; };
 
+//! Construct structured grids in a distributed manner if the grid supports this
+struct DistributedGridConstruction { static constexpr bool value = false; };
+
+//! Read grid files from a preprocessed binary cache which is rebuilt if it is stale
+struct EnableGridCache { static constexpr bool value = false; };
+
 //! The default value for the simulation's end time
 template<class Scalar>
 struct EndTime { static constexpr Scalar value = -1e35; };
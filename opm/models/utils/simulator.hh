@@ -40,6 +40,8 @@
 
 #include <dune/common/parallel/mpihelper.hh>
 
+#include <sys/resource.h>
+
 #include <iostream>
 #include <fstream>
 #include <iomanip>
@@ -105,6 +107,7 @@ class Simulator
     using GridView = GetPropType<TypeTag, Properties::GridView>;
     using Model = GetPropType<TypeTag, Properties::Model>;
     using Problem = GetPropType<TypeTag, Properties::Problem>;
+    using ThreadManager = GetPropType<TypeTag, Properties::ThreadManager>;
 
     using MPIComm = typename Dune::MPIHelper::MPICommunicator;
     using Communication = Dune::Communication<MPIComm>;
@@ -152,6 +155,8 @@ public:
         if (verbose_)
             std::cout << "Allocating the simulation vanguard\n" << std::flush;
 
+        gridConstructionTimer_.start();
+
         int exceptionThrown = 0;
         std::string what;
 
@@ -198,8 +203,19 @@ public:
         checkParallelException("Could not distribute the vanguard data: ",
                                exceptionThrown, what);
 
+        gridConstructionTimer_.stop();
+        {
+            const double peakMemory = comm.max(peakMemoryUsage_());
+            if (verbose_)
+                std::cout << "Grid constructed and distributed on " << comm.size()
+                          << " process(es) in " << gridConstructionTimer_.realTimeElapsed()
+                          << " seconds, peak memory usage: " << peakMemory << " MiB\n"
+                          << std::flush;
+        }
+
         if (verbose_)
             std::cout << "Allocating the model\n" << std::flush;
+        modelInitTimer_.start();
         try {
             model_.reset(new Model(*this));
         }
@@ -208,10 +224,12 @@ public:
         }
         checkParallelException("Could not allocate model: ",
                                exceptionThrown, what);
+        modelInitTimer_.stop();
 
         if (verbose_)
             std::cout << "Allocating the problem\n" << std::flush;
 
+        problemInitTimer_.start();
         try {
             problem_.reset(new Problem(*this));
         }
@@ -220,10 +238,12 @@ public:
         }
         checkParallelException("Could not allocate the problem: ",
                                exceptionThrown, what);
+        problemInitTimer_.stop();
 
         if (verbose_)
             std::cout << "Initializing the model\n" << std::flush;
 
+        modelInitTimer_.start();
         try
         { model_->finishInit(); }
         catch (const std::exception& e) {
@@ -231,10 +251,12 @@ public:
         }
         checkParallelException("Could not initialize the  model: ",
                                exceptionThrown, what);
+        modelInitTimer_.stop();
 
         if (verbose_)
             std::cout << "Initializing the problem\n" << std::flush;
 
+        problemInitTimer_.start();
         try
         { problem_->finishInit(); }
         catch (const std::exception& e) {
@@ -242,6 +264,7 @@ public:
         }
         checkParallelException("Could not initialize the problem: ",
                                exceptionThrown, what);
+        problemInitTimer_.stop();
 
         setupTimer_.stop();
 
@@ -373,6 +396,34 @@ public:
     Scalar endTime() const
     { return endTime_; }
 
+    /*!
+     * \brief Returns a reference to the timer object which measures the time needed to
+     *        create and distribute the grid
+     */
+    const Timer& gridConstructionTimer() const
+    { return gridConstructionTimer_; }
+
+    /*!
+     * \brief Returns a reference to the timer object which measures the time needed to
+     *        allocate and initialize the model
+     */
+    const Timer& modelInitTimer() const
+    { return modelInitTimer_; }
+
+    /*!
+     * \brief Returns a reference to the timer object which measures the time needed to
+     *        allocate and initialize the problem
+     */
+    const Timer& problemInitTimer() const
+    { return problemInitTimer_; }
+
+    /*!
+     * \brief Returns a reference to the timer object which measures the time needed to
+     *        apply the initial solution
+     */
+    const Timer& initialSolutionTimer() const
+    { return initialSolutionTimer_; }
+
     /*!
      * \brief Returns a reference to the timer object which measures the time needed to
      *        set up and initialize the simulation
@@ -680,7 +731,9 @@ public:
             timeStepSize_ = 0.0;
             timeStepIdx_ = -1;
 
+            initialSolutionTimer_.start();
             EWOMS_CATCH_PARALLEL_EXCEPTIONS_FATAL(model_->applyInitialSolution());
+            initialSolutionTimer_.stop();
 
             // write initial condition
             if (problem_->shouldWriteOutput())
@@ -690,6 +743,7 @@ public:
             timeStepIdx_ = oldTimeStepIdx;
         }
         setupTimer_.stop();
+        printStartupTimes_();
 
         executionTimer_.start();
         bool episodeBegins = episodeIsOver() || (timeStepIdx_ == 0);
@@ -976,6 +1030,48 @@ public:
     }
 
 private:
+    // print how the time needed to set up the simulation is distributed
+    void printStartupTimes_() const
+    {
+        const double peakMemory = vanguard_->gridView().comm().max(peakMemoryUsage_());
+        if (!verbose_)
+            return;
+
+        const Scalar setupTime = setupTimer_.realTimeElapsed();
+        auto printTime = [setupTime](const std::string& name, Scalar time) {
+            std::cout << name << time << " seconds" << humanReadableTime(time)
+                      << ", " << time/setupTime*100 << "%\n";
+        };
+
+        std::cout << std::setprecision(3)
+                  << "\n"
+                  << "------------------------ Startup timing ------------------------\n";
+        printTime("Grid construction time: ", gridConstructionTimer_.realTimeElapsed());
+        printTime("Model initialization time: ", modelInitTimer_.realTimeElapsed());
+        printTime("Problem initialization time: ", problemInitTimer_.realTimeElapsed());
+        printTime("Initial solution time: ", initialSolutionTimer_.realTimeElapsed());
+        std::cout << "Total setup time: " << setupTime << " seconds" << humanReadableTime(setupTime) << "\n"
+                  << "Threads per process: " << ThreadManager::maxThreads() << "\n"
+                  << "Peak memory usage: " << peakMemory << " MiB\n"
+                  << "----------------------------------------------------------------\n"
+                  << std::endl;
+    }
+
+    // returns the maximum resident set size of the process so far in MiB
+    static double peakMemoryUsage_()
+    {
+        rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0)
+            return 0.0;
+#ifdef __APPLE__
+        // bytes on macOS
+        return static_cast<double>(usage.ru_maxrss)/(1024.0*1024.0);
+#else
+        // kibibytes on Linux
+        return static_cast<double>(usage.ru_maxrss)/1024.0;
+#endif
+    }
+
     std::unique_ptr<Vanguard> vanguard_;
     std::unique_ptr<Model> model_;
     std::unique_ptr<Problem> problem_;
@@ -984,6 +1080,10 @@ private:
     Scalar episodeStartTime_;
     Scalar episodeLength_;
 
+    Timer gridConstructionTimer_;
+    Timer modelInitTimer_;
+    Timer problemInitTimer_;
+    Timer initialSolutionTimer_;
     Timer setupTimer_;
     Timer executionTimer_;
     Timer prePostProcessTimer_;
@@ -34,6 +34,7 @@
 
 #include "parametersystem.hh"
 
+#include <opm/models/parallel/mpiutil.hh>
 #include <opm/models/utils/simulator.hh>
 #include <opm/models/utils/timer.hh>
 
@@ -304,9 +305,10 @@ static inline int start(int argc, char **argv,  bool registerParams=true)
         if (paramStatus == 2)
             return 0;
 
-        ThreadManager::init();
-
-        // initialize MPI, finalize is done automatically on exit
+        // initialize MPI, finalize is done automatically on exit. the border elements
+        // are linearized while the master thread communicates, which requires
+        // MPI_THREAD_FUNNELED, but the MPI helpers only request MPI_THREAD_SINGLE.
+        const bool funneledThreads = initMpiFunneledThreads(argc, argv);
 #if HAVE_DUNE_FEM
         Dune::Fem::MPIManager::initialize(argc, argv);
         myRank = Dune::Fem::MPIManager::rank();
@@ -314,6 +316,12 @@ static inline int start(int argc, char **argv,  bool registerParams=true)
         myRank = Dune::MPIHelper::instance(argc, argv).rank();
 #endif
 
+        ThreadManager::init();
+        if (!funneledThreads && ThreadManager::maxThreads() > 1 && myRank == 0)
+            std::cerr << "Warning: The MPI library does not provide MPI_THREAD_FUNNELED. "
+                      << "The communication of the processes is not overlapped with "
+                      << "the work of the threads.\n";
+
         // read the initial time step and the end time
         Scalar endTime = Parameters::Get<Parameters::EndTime<Scalar>>();
         if (endTime < -1e50) {
@@ -348,6 +356,8 @@ static inline int start(int argc, char **argv,  bool registerParams=true)
             else
                 std::cout << "opm models " << versionString
                           << " will now start the simulation. " << std::endl;
+
+            ThreadManager::printTopology(std::cout);
         }
 
         // print the parameters if requested
@@ -0,0 +1,729 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::GeometricMultigrid
+ */
+#ifndef EWOMS_GEOMETRIC_MULTIGRID_HH
+#define EWOMS_GEOMETRIC_MULTIGRID_HH
+
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/preconditioner.hh>
+#include <dune/istl/solvercategory.hh>
+
+#include <opm/simulators/linalg/matrixblock.hh>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+//! The number of points of a structured lattice in each direction
+using LatticeSize = std::array<int, 3>;
+
+/*!
+ * \brief Determine whether a set of points forms a complete tensor product lattice.
+ *
+ * If this is the case, the number of points in each direction is stored in \c size and
+ * the lexicographic index of each point (the first direction runs fastest) is stored in
+ * \c pointIdx.
+ *
+ * \return false if the points do not form a complete lattice
+ */
+template <class Position>
+bool detectLattice(const std::vector<Position>& positions,
+                   int dim,
+                   LatticeSize& size,
+                   std::vector<int>& pointIdx)
+{
+    const std::size_t numPoints = positions.size();
+    if (numPoints == 0 || dim < 1 || dim > 3)
+        return false;
+
+    // the tolerance used to decide whether two coordinates are the same
+    double extent = 0.0;
+    for (int d = 0; d < dim; ++d) {
+        const auto [minIt, maxIt] =
+            std::minmax_element(positions.begin(), positions.end(),
+                                [d](const Position& a, const Position& b)
+                                { return a[d] < b[d]; });
+        extent = std::max(extent, static_cast<double>((*maxIt)[d] - (*minIt)[d]));
+    }
+    const double tolerance = 1e-6*extent;
+
+    std::array<std::vector<double>, 3> axes;
+    std::size_t numLatticePoints = 1;
+    size = {1, 1, 1};
+    for (int d = 0; d < dim; ++d) {
+        std::vector<double> coords(numPoints);
+        for (std::size_t i = 0; i < numPoints; ++i)
+            coords[i] = static_cast<double>(positions[i][d]);
+        std::sort(coords.begin(), coords.end());
+
+        auto& axis = axes[d];
+        for (const double c : coords)
+            if (axis.empty() || c > axis.back() + tolerance)
+                axis.push_back(c);
+
+        size[d] = static_cast<int>(axis.size());
+        numLatticePoints *= axis.size();
+    }
+    if (numLatticePoints != numPoints)
+        return false;
+
+    pointIdx.resize(numPoints);
+    std::vector<bool> isUsed(numPoints, false);
+    for (std::size_t i = 0; i < numPoints; ++i) {
+        int idx = 0;
+        for (int d = dim - 1; d >= 0; --d) {
+            const double c = static_cast<double>(positions[i][d]);
+            const auto& axis = axes[d];
+            const auto it = std::lower_bound(axis.begin(), axis.end(), c - tolerance);
+            if (it == axis.end() || std::abs(*it - c) > tolerance)
+                return false;
+            idx = idx*size[d] + static_cast<int>(it - axis.begin());
+        }
+        if (isUsed[idx])
+            return false;
+        isUsed[idx] = true;
+        pointIdx[i] = idx;
+    }
+
+    return true;
+}
+
+/*!
+ * \ingroup Linear
+ *
+ * \brief A geometric multigrid preconditioner for linear systems whose degrees of
+ *        freedom are located on a structured lattice.
+ *
+ * The hierarchy is built by semi-coarsening: On each level, the lattice is coarsened
+ * by a factor of two in the directions in which the matrix couples the degrees of
+ * freedom strongly. Isotropic problems thus get standard coarsening, while for thin
+ * layers only the vertical direction is coarsened. The prolongation interpolates
+ * linearly between the centers of the coarse cells in the coarsened directions, the
+ * restriction is its transpose and the coarse operators are the Galerkin products.
+ * Unlike the piecewise constant prolongation of aggregation methods, this does not
+ * underestimate the smooth error components, so no over-correction is needed. Since
+ * the sparsity pattern of the coarse operators follows from the stencil, it is
+ * determined once and only the values are updated for each linear solve.
+ *
+ * Symmetric block Gauss-Seidel sweeps using the inverted diagonal blocks of the
+ * matrix are used as smoother. If the coarsening reaches the target size, the coarsest
+ * level is solved using a dense LU decomposition, else it is only smoothed. Rows which
+ * are not part of the lattice, e.g. those of auxiliary degrees of freedom or of the
+ * algebraic overlap, are only smoothed.
+ */
+template <class Matrix, class Vector>
+class GeometricMultigrid : public Dune::Preconditioner<Vector, Vector>
+{
+    using Block = typename Matrix::block_type;
+    using VectorBlock = typename Vector::block_type;
+    using LevelMatrix = Dune::BCRSMatrix<Block>;
+    using LevelVector = Dune::BlockVector<VectorBlock>;
+
+    // directions are coarsened if their coupling is at least this fraction of the
+    // strongest one
+    static constexpr double semiCoarseningThreshold = 0.5;
+
+    // the number of symmetric smoothing sweeps on the coarsest level if it is not
+    // solved directly
+    static constexpr int coarseSweeps = 10;
+
+    static constexpr int blockSize = Block::rows;
+
+    struct Level
+    {
+        LatticeSize size;
+        const LevelMatrix* matrix = nullptr;
+        std::unique_ptr<LevelMatrix> coarseMatrix;
+
+        // the lattice point of each row or -1 if the row is not part of the lattice
+        std::vector<int> rowPoint;
+
+        // the prolongation from the next coarser level in compressed row storage: the
+        // coarse rows from which each row is interpolated and their weights
+        std::vector<std::size_t> prolongationStart;
+        std::vector<int> prolongationRow;
+        std::vector<double> prolongationWeight;
+
+        // the transpose of the prolongation, i.e., the restriction to the next coarser
+        // level
+        std::vector<std::size_t> restrictionStart;
+        std::vector<int> restrictionRow;
+        std::vector<double> restrictionWeight;
+
+        std::vector<Block> diagInv;
+        LevelVector x;
+        LevelVector d;
+        LevelVector r;
+    };
+
+public:
+    using domain_type = Vector;
+    using range_type = Vector;
+    using field_type = typename Vector::field_type;
+
+    /*!
+     * \brief Create the multigrid preconditioner.
+     *
+     * \param size The number of lattice points in each direction
+     * \param rowPoint The lattice point of each row of the matrix or -1
+     * \param maxLevels The maximum number of levels of the hierarchy
+     * \param coarsenTarget The number of rows below which coarsening stops
+     * \param smoothingSteps The number of pre- and post-smoothing sweeps
+     */
+    GeometricMultigrid(const LatticeSize& size,
+                       std::vector<int> rowPoint,
+                       int maxLevels,
+                       std::size_t coarsenTarget,
+                       int smoothingSteps)
+        : size_(size)
+        , rowPoint_(std::move(rowPoint))
+        , maxLevels_(std::max(maxLevels, 1))
+        , coarsenTarget_(coarsenTarget)
+        , smoothingSteps_(std::max(smoothingSteps, 1))
+    {}
+
+    /*!
+     * \brief Update the preconditioner for new values of the matrix.
+     *
+     * The hierarchy is built by the first call. Afterwards, the matrix must keep its
+     * sparsity pattern.
+     */
+    void update(const Matrix& matrix)
+    {
+        if (levels_.empty() || levels_.front().matrix != &matrix) {
+            buildHierarchy_(matrix);
+            return;
+        }
+
+        for (std::size_t levelIdx = 0; levelIdx < levels_.size(); ++levelIdx) {
+            if (levelIdx + 1 < levels_.size())
+                updateGalerkinProduct_(levelIdx);
+            updateDiagonal_(levels_[levelIdx]);
+        }
+        updateCoarseSolver_();
+    }
+
+    //! Returns the number of levels of the hierarchy.
+    std::size_t numLevels() const
+    { return levels_.size(); }
+
+    //! Returns the number of rows of the matrix of a level.
+    std::size_t numRows(std::size_t levelIdx) const
+    { return levels_[levelIdx].matrix->N(); }
+
+    //! Returns the size of the lattice of a level.
+    const LatticeSize& latticeSize(std::size_t levelIdx) const
+    { return levels_[levelIdx].size; }
+
+    void pre(Vector&, Vector&) override
+    {}
+
+    /*!
+     * \brief Apply one V-cycle to the defect \c d.
+     */
+    void apply(Vector& v, const Vector& d) override
+    { cycle_(0, v, d); }
+
+    void post(Vector&) override
+    {}
+
+    Dune::SolverCategory::Category category() const override
+    { return Dune::SolverCategory::sequential; }
+
+private:
+    static std::array<int, 3> coords_(int point, const LatticeSize& size)
+    { return {point % size[0], (point/size[0]) % size[1], point/(size[0]*size[1])}; }
+
+    void buildHierarchy_(const Matrix& matrix)
+    {
+        levels_.clear();
+        levels_.reserve(maxLevels_);
+
+        levels_.emplace_back();
+        Level& fine = levels_.back();
+        fine.size = size_;
+        fine.matrix = &matrix;
+        fine.rowPoint = rowPoint_;
+        fine.rowPoint.resize(matrix.N(), -1);
+        updateDiagonal_(fine);
+
+        while (static_cast<int>(levels_.size()) < maxLevels_
+               && levels_.back().matrix->N() > coarsenTarget_)
+        {
+            if (!addCoarseLevel_())
+                break;
+        }
+
+        updateCoarseSolver_();
+    }
+
+    // the mean coupling strength of the connections in each lattice direction of a
+    // level. the mean is used because the number of connections differs between the
+    // directions if the lattice is small in some of them.
+    std::array<double, 3> couplingStrength_(const Level& level) const
+    {
+        std::array<double, 3> strength = {0.0, 0.0, 0.0};
+        std::array<std::size_t, 3> numConnections = {0, 0, 0};
+        const auto& matrix = *level.matrix;
+        for (auto row = matrix.begin(); row != matrix.end(); ++row) {
+            const int p = level.rowPoint[row.index()];
+            if (p < 0)
+                continue;
+
+            const auto pc = coords_(p, level.size);
+            for (auto col = row->begin(); col != row->end(); ++col) {
+                const int q = level.rowPoint[col.index()];
+                if (q < 0 || q == p)
+                    continue;
+
+                const auto qc = coords_(q, level.size);
+                int numDiff = 0;
+                int diffDir = 0;
+                for (int d = 0; d < 3; ++d) {
+                    if (pc[d] != qc[d]) {
+                        ++numDiff;
+                        diffDir = d;
+                    }
+                }
+                if (numDiff == 1 && std::abs(pc[diffDir] - qc[diffDir]) == 1) {
+                    strength[diffDir] += static_cast<double>(col->frobenius_norm());
+                    ++numConnections[diffDir];
+                }
+            }
+        }
+
+        for (int d = 0; d < 3; ++d)
+            if (numConnections[d] > 0)
+                strength[d] /= numConnections[d];
+
+        return strength;
+    }
+
+    bool addCoarseLevel_()
+    {
+        Level& fine = levels_.back();
+        const auto& fineMatrix = *fine.matrix;
+
+        // choose the directions to be coarsened
+        const auto strength = couplingStrength_(fine);
+        double maxStrength = 0.0;
+        for (int d = 0; d < 3; ++d)
+            if (fine.size[d] > 1)
+                maxStrength = std::max(maxStrength, strength[d]);
+
+        LatticeSize coarseSize = fine.size;
+        bool coarsened = false;
+        for (int d = 0; d < 3; ++d) {
+            if (fine.size[d] > 1 && strength[d] >= semiCoarseningThreshold*maxStrength) {
+                coarseSize[d] = (fine.size[d] + 1)/2;
+                coarsened = true;
+            }
+        }
+        if (!coarsened)
+            return false;
+
+        // the coarse lattice points which contain fine lattice points and their rows
+        const std::size_t numCoarsePoints =
+            static_cast<std::size_t>(coarseSize[0])*coarseSize[1]*coarseSize[2];
+        std::vector<int> pointToCoarseRow(numCoarsePoints, -1);
+        std::vector<int> coarseRowPoint;
+        for (std::size_t rowIdx = 0; rowIdx < fineMatrix.N(); ++rowIdx) {
+            const int p = fine.rowPoint[rowIdx];
+            if (p < 0)
+                continue;
+
+            auto c = coords_(p, fine.size);
+            for (int d = 0; d < 3; ++d)
+                if (coarseSize[d] != fine.size[d])
+                    c[d] /= 2;
+            const int coarsePoint = c[0] + coarseSize[0]*(c[1] + coarseSize[1]*c[2]);
+            if (pointToCoarseRow[coarsePoint] < 0) {
+                pointToCoarseRow[coarsePoint] = static_cast<int>(coarseRowPoint.size());
+                coarseRowPoint.push_back(coarsePoint);
+            }
+        }
+
+        const std::size_t numCoarseRows = coarseRowPoint.size();
+        if (numCoarseRows == 0 || numCoarseRows == fineMatrix.N())
+            return false;
+
+        // interpolate linearly between the centers of the coarse cells in each coarsened
+        // direction. in units of the fine lattice spacing, a coarse cell is centered
+        // between its two fine cells or, if the number of fine cells is odd, the last
+        // coarse cell is centered at its only fine cell.
+        const auto coarseCenter = [&fine](int d, int c)
+        { return (2*c + 1 < fine.size[d]) ? 2*c + 0.5 : 2.0*c; };
+        fine.prolongationStart.assign(1, 0);
+        fine.prolongationRow.clear();
+        fine.prolongationWeight.clear();
+        for (std::size_t rowIdx = 0; rowIdx < fineMatrix.N(); ++rowIdx) {
+            const int p = fine.rowPoint[rowIdx];
+            if (p >= 0) {
+                const auto fc = coords_(p, fine.size);
+                std::array<std::array<int, 2>, 3> coarseCoord;
+                std::array<std::array<double, 2>, 3> weight;
+                std::array<int, 3> numCoarse;
+                for (int d = 0; d < 3; ++d) {
+                    if (coarseSize[d] == fine.size[d]) {
+                        coarseCoord[d] = {fc[d], fc[d]};
+                        weight[d] = {1.0, 0.0};
+                        numCoarse[d] = 1;
+                        continue;
+                    }
+
+                    const int c = fc[d]/2;
+                    const double offset = fc[d] - coarseCenter(d, c);
+                    const int neighbor = (offset < 0.0) ? c - 1 : c + 1;
+                    if (offset == 0.0 || neighbor < 0 || neighbor >= coarseSize[d]) {
+                        coarseCoord[d] = {c, c};
+                        weight[d] = {1.0, 0.0};
+                        numCoarse[d] = 1;
+                    }
+                    else {
+                        const double neighborWeight =
+                            offset/(coarseCenter(d, neighbor) - coarseCenter(d, c));
+                        coarseCoord[d] = {c, neighbor};
+                        weight[d] = {1.0 - neighborWeight, neighborWeight};
+                        numCoarse[d] = 2;
+                    }
+                }
+
+                for (int k = 0; k < numCoarse[2]; ++k) {
+                    for (int j = 0; j < numCoarse[1]; ++j) {
+                        for (int i = 0; i < numCoarse[0]; ++i) {
+                            const int coarsePoint =
+                                coarseCoord[0][i]
+                                + coarseSize[0]*(coarseCoord[1][j] + coarseSize[1]*coarseCoord[2][k]);
+                            if (pointToCoarseRow[coarsePoint] < 0)
+                                continue;
+                            fine.prolongationRow.push_back(pointToCoarseRow[coarsePoint]);
+                            fine.prolongationWeight.push_back(weight[0][i]*weight[1][j]*weight[2][k]);
+                        }
+                    }
+                }
+            }
+            fine.prolongationStart.push_back(fine.prolongationRow.size());
+        }
+
+        // the restriction is the transpose of the prolongation
+        fine.restrictionStart.assign(numCoarseRows + 1, 0);
+        for (const int coarseRowIdx : fine.prolongationRow)
+            ++fine.restrictionStart[coarseRowIdx + 1];
+        std::partial_sum(fine.restrictionStart.begin(), fine.restrictionStart.end(),
+                         fine.restrictionStart.begin());
+        fine.restrictionRow.resize(fine.prolongationRow.size());
+        fine.restrictionWeight.resize(fine.prolongationRow.size());
+        std::vector<std::size_t> fillIdx(fine.restrictionStart.begin(),
+                                         fine.restrictionStart.end() - 1);
+        for (std::size_t rowIdx = 0; rowIdx < fineMatrix.N(); ++rowIdx) {
+            for (std::size_t k = fine.prolongationStart[rowIdx];
+                 k < fine.prolongationStart[rowIdx + 1]; ++k)
+            {
+                const std::size_t pos = fillIdx[fine.prolongationRow[k]]++;
+                fine.restrictionRow[pos] = static_cast<int>(rowIdx);
+                fine.restrictionWeight[pos] = fine.prolongationWeight[k];
+            }
+        }
+
+        // the sparsity pattern of the Galerkin product
+        std::vector<std::vector<int>> pattern(numCoarseRows);
+        for (std::size_t coarseRowIdx = 0; coarseRowIdx < numCoarseRows; ++coarseRowIdx) {
+            auto& cols = pattern[coarseRowIdx];
+            for (std::size_t k = fine.restrictionStart[coarseRowIdx];
+                 k < fine.restrictionStart[coarseRowIdx + 1]; ++k)
+            {
+                const auto& row = fineMatrix[fine.restrictionRow[k]];
+                for (auto col = row.begin(); col != row.end(); ++col)
+                    for (std::size_t l = fine.prolongationStart[col.index()];
+                         l < fine.prolongationStart[col.index() + 1]; ++l)
+                        cols.push_back(fine.prolongationRow[l]);
+            }
+            std::sort(cols.begin(), cols.end());
+            cols.erase(std::unique(cols.begin(), cols.end()), cols.end());
+        }
+
+        auto coarseMatrix = std::make_unique<LevelMatrix>(numCoarseRows, numCoarseRows,
+                                                          LevelMatrix::random);
+        for (std::size_t rowIdx = 0; rowIdx < numCoarseRows; ++rowIdx)
+            coarseMatrix->setrowsize(rowIdx, pattern[rowIdx].size());
+        coarseMatrix->endrowsizes();
+        for (std::size_t rowIdx = 0; rowIdx < numCoarseRows; ++rowIdx)
+            for (const int colIdx : pattern[rowIdx])
+                coarseMatrix->addindex(rowIdx, colIdx);
+        coarseMatrix->endindices();
+
+        fine.r.resize(fineMatrix.N());
+
+        levels_.emplace_back();
+        Level& coarse = levels_.back();
+        coarse.size = coarseSize;
+        coarse.matrix = coarseMatrix.get();
+        coarse.coarseMatrix = std::move(coarseMatrix);
+        coarse.rowPoint = std::move(coarseRowPoint);
+        coarse.x.resize(numCoarseRows);
+        coarse.d.resize(numCoarseRows);
+
+        updateGalerkinProduct_(levels_.size() - 2);
+        updateDiagonal_(coarse);
+
+        return true;
+    }
+
+    // A_c = P^T A P for the linear prolongation P
+    void updateGalerkinProduct_(std::size_t fineLevelIdx)
+    {
+        const Level& fine = levels_[fineLevelIdx];
+        const auto& matrix = *fine.matrix;
+        auto& coarseMatrix = *levels_[fineLevelIdx + 1].coarseMatrix;
+        coarseMatrix = 0.0;
+
+        // the blocks of the current coarse row by column index
+        std::vector<Block*> coarseBlock(coarseMatrix.N(), nullptr);
+        for (auto coarseRow = coarseMatrix.begin(); coarseRow != coarseMatrix.end(); ++coarseRow) {
+            const std::size_t coarseRowIdx = coarseRow.index();
+            for (auto col = coarseRow->begin(); col != coarseRow->end(); ++col)
+                coarseBlock[col.index()] = &(*col);
+
+            for (std::size_t k = fine.restrictionStart[coarseRowIdx];
+                 k < fine.restrictionStart[coarseRowIdx + 1]; ++k)
+            {
+                const double rowWeight = fine.restrictionWeight[k];
+                const auto& row = matrix[fine.restrictionRow[k]];
+                for (auto col = row.begin(); col != row.end(); ++col) {
+                    for (std::size_t l = fine.prolongationStart[col.index()];
+                         l < fine.prolongationStart[col.index() + 1]; ++l)
+                    {
+                        coarseBlock[fine.prolongationRow[l]]->axpy(rowWeight*fine.prolongationWeight[l],
+                                                                   *col);
+                    }
+                }
+            }
+        }
+    }
+
+    // invert the diagonal blocks for the smoother. rows without a diagonal block get a
+    // zero inverse, i.e., they are not changed by the smoother.
+    void updateDiagonal_(Level& level)
+    {
+        const auto& matrix = *level.matrix;
+        std::vector<std::size_t> diagRows;
+        std::vector<Block> diagBlocks;
+        diagRows.reserve(matrix.N());
+        diagBlocks.reserve(matrix.N());
+        for (auto row = matrix.begin(); row != matrix.end(); ++row) {
+            const std::size_t rowIdx = row.index();
+            for (auto col = row->begin(); col != row->end(); ++col) {
+                if (col.index() == rowIdx) {
+                    diagRows.push_back(rowIdx);
+                    diagBlocks.push_back(*col);
+                    break;
+                }
+            }
+        }
+        invertBlocks(diagBlocks);
+
+        Block zero;
+        zero = 0.0;
+        level.diagInv.assign(matrix.N(), zero);
+        for (std::size_t i = 0; i < diagRows.size(); ++i)
+            level.diagInv[diagRows[i]] = diagBlocks[i];
+    }
+
+    // factorize the matrix of the coarsest level using Gaussian elimination with
+    // partial pivoting if the coarsening reached its target. otherwise, or if the matrix
+    // is singular, the coarsest level is only smoothed.
+    void updateCoarseSolver_()
+    {
+        coarseLu_.clear();
+        const auto& matrix = *levels_.back().matrix;
+        if (levels_.size() < 2 || matrix.N() > coarsenTarget_)
+            return;
+
+        const std::size_t n = matrix.N()*blockSize;
+        std::vector<double> lu(n*n, 0.0);
+        for (auto row = matrix.begin(); row != matrix.end(); ++row)
+            for (auto col = row->begin(); col != row->end(); ++col)
+                for (int i = 0; i < blockSize; ++i)
+                    for (int j = 0; j < blockSize; ++j)
+                        lu[(row.index()*blockSize + i)*n + col.index()*blockSize + j] =
+                            static_cast<double>((*col)[i][j]);
+
+        coarsePivot_.resize(n);
+        for (std::size_t k = 0; k < n; ++k) {
+            std::size_t pivotRow = k;
+            for (std::size_t i = k + 1; i < n; ++i)
+                if (std::abs(lu[i*n + k]) > std::abs(lu[pivotRow*n + k]))
+                    pivotRow = i;
+            if (lu[pivotRow*n + k] == 0.0)
+                return;
+
+            coarsePivot_[k] = pivotRow;
+            if (pivotRow != k)
+                std::swap_ranges(lu.begin() + k*n, lu.begin() + (k + 1)*n, lu.begin() + pivotRow*n);
+
+            for (std::size_t i = k + 1; i < n; ++i) {
+                const double factor = (lu[i*n + k] /= lu[k*n + k]);
+                for (std::size_t j = k + 1; j < n; ++j)
+                    lu[i*n + j] -= factor*lu[k*n + j];
+            }
+        }
+
+        coarseLu_ = std::move(lu);
+    }
+
+    template <class X, class D>
+    void solveCoarse_(X& x, const D& d) const
+    {
+        const std::size_t n = coarsePivot_.size();
+        std::vector<double> y(n);
+        for (std::size_t rowIdx = 0; rowIdx < d.size(); ++rowIdx)
+            for (int i = 0; i < blockSize; ++i)
+                y[rowIdx*blockSize + i] = static_cast<double>(d[rowIdx][i]);
+
+        for (std::size_t k = 0; k < n; ++k)
+            std::swap(y[k], y[coarsePivot_[k]]);
+        for (std::size_t i = 0; i < n; ++i)
+            for (std::size_t j = 0; j < i; ++j)
+                y[i] -= coarseLu_[i*n + j]*y[j];
+        for (std::size_t i = n; i-- > 0;) {
+            for (std::size_t j = i + 1; j < n; ++j)
+                y[i] -= coarseLu_[i*n + j]*y[j];
+            y[i] /= coarseLu_[i*n + i];
+        }
+
+        for (std::size_t rowIdx = 0; rowIdx < x.size(); ++rowIdx)
+            for (int i = 0; i < blockSize; ++i)
+                x[rowIdx][i] = y[rowIdx*blockSize + i];
+    }
+
+    template <class X, class D>
+    void forwardSweep_(const Level& level, X& x, const D& d) const
+    {
+        const auto& matrix = *level.matrix;
+        VectorBlock rhs;
+        for (auto row = matrix.begin(); row != matrix.end(); ++row) {
+            const std::size_t rowIdx = row.index();
+            rhs = d[rowIdx];
+            for (auto col = row->begin(); col != row->end(); ++col)
+                if (col.index() != rowIdx)
+                    col->mmv(x[col.index()], rhs);
+            level.diagInv[rowIdx].mv(rhs, x[rowIdx]);
+        }
+    }
+
+    template <class X, class D>
+    void backwardSweep_(const Level& level, X& x, const D& d) const
+    {
+        const auto& matrix = *level.matrix;
+        VectorBlock rhs;
+        for (std::size_t rowIdx = matrix.N(); rowIdx-- > 0;) {
+            const auto& row = matrix[rowIdx];
+            rhs = d[rowIdx];
+            for (auto col = row.begin(); col != row.end(); ++col)
+                if (col.index() != rowIdx)
+                    col->mmv(x[col.index()], rhs);
+            level.diagInv[rowIdx].mv(rhs, x[rowIdx]);
+        }
+    }
+
+    template <class X, class D>
+    void cycle_(std::size_t levelIdx, X& x, const D& d)
+    {
+        Level& level = levels_[levelIdx];
+        x = 0.0;
+
+        if (levelIdx + 1 == levels_.size()) {
+            if (!coarseLu_.empty()) {
+                solveCoarse_(x, d);
+                return;
+            }
+
+            for (int sweepIdx = 0; sweepIdx < coarseSweeps; ++sweepIdx) {
+                forwardSweep_(level, x, d);
+                backwardSweep_(level, x, d);
+            }
+            return;
+        }
+
+        for (int stepIdx = 0; stepIdx < smoothingSteps_; ++stepIdx)
+            forwardSweep_(level, x, d);
+
+        // restrict the residual to the coarse level
+        const auto& matrix = *level.matrix;
+        for (auto row = matrix.begin(); row != matrix.end(); ++row) {
+            const std::size_t rowIdx = row.index();
+            level.r[rowIdx] = d[rowIdx];
+            for (auto col = row->begin(); col != row->end(); ++col)
+                col->mmv(x[col.index()], level.r[rowIdx]);
+        }
+
+        Level& coarse = levels_[levelIdx + 1];
+        for (std::size_t coarseRowIdx = 0; coarseRowIdx < coarse.d.size(); ++coarseRowIdx) {
+            coarse.d[coarseRowIdx] = 0.0;
+            for (std::size_t k = level.restrictionStart[coarseRowIdx];
+                 k < level.restrictionStart[coarseRowIdx + 1]; ++k)
+                coarse.d[coarseRowIdx].axpy(level.restrictionWeight[k],
+                                            level.r[level.restrictionRow[k]]);
+        }
+
+        cycle_(levelIdx + 1, coarse.x, coarse.d);
+
+        // prolongate the correction
+        for (std::size_t rowIdx = 0; rowIdx < matrix.N(); ++rowIdx)
+            for (std::size_t k = level.prolongationStart[rowIdx];
+                 k < level.prolongationStart[rowIdx + 1]; ++k)
+                x[rowIdx].axpy(level.prolongationWeight[k], coarse.x[level.prolongationRow[k]]);
+
+        for (int stepIdx = 0; stepIdx < smoothingSteps_; ++stepIdx)
+            backwardSweep_(level, x, d);
+    }
+
+    LatticeSize size_;
+    std::vector<int> rowPoint_;
+    int maxLevels_;
+    std::size_t coarsenTarget_;
+    int smoothingSteps_;
+
+    std::vector<Level> levels_;
+
+    // the dense LU decomposition of the coarsest matrix and its row permutation
+    std::vector<double> coarseLu_;
+    std::vector<std::size_t> coarsePivot_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
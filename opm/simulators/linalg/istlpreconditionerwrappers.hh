@@ -40,6 +40,10 @@
  * - \c SOR: A successive overrelaxation (SOR) preconditioner
  * - \c ILUn: An ILU(n) preconditioner
  * - \c ILU0: A specialized (and optimized) ILU(0) preconditioner
+ *
+ * The prepare() method of the wrappers returns whether the sequential preconditioner
+ * object has been (re-)created. Preconditioners which only reference the matrix are
+ * kept alive until cleanup() is called.
  */
 #ifndef EWOMS_ISTL_PRECONDITIONER_WRAPPERS_HH
 #define EWOMS_ISTL_PRECONDITIONER_WRAPPERS_HH
@@ -55,6 +59,8 @@
 #include <opm/simulators/linalg/ilufirstelement.hh> // definitions needed in next header
 #include <dune/istl/preconditioners.hh>
 
+#include <memory>
+
 namespace Opm {
 namespace Linear {
 #define EWOMS_WRAP_ISTL_PRECONDITIONER(PREC_NAME, ISTL_PREC_TYPE)               \
@@ -81,22 +87,32 @@ namespace Linear {
                 ("The relaxation factor of the preconditioner");                \
         }                                                                       \
                                                                                 \
-        void prepare(IstlMatrix& matrix)                                        \
+        bool prepare(IstlMatrix& matrix)                                        \
         {                                                                       \
+            /* the preconditioner only references the matrix */                 \
+            if (seqPreCond_ && matrix_ == &matrix)                              \
+                return false;                                                   \
+                                                                                \
             int order = Parameters::Get<Parameters::PreconditionerOrder>();     \
             Scalar relaxationFactor = Parameters::Get<Parameters::PreconditionerRelaxation<Scalar>>(); \
-            seqPreCond_ = new SequentialPreconditioner(matrix, order,           \
-                                                       relaxationFactor);       \
+            seqPreCond_ = std::make_unique<SequentialPreconditioner>(matrix, order, \
+                                                                     relaxationFactor); \
+            matrix_ = &matrix;                                                  \
+            return true;                                                        \
         }                                                                       \
                                                                                 \
         SequentialPreconditioner& get()                                         \
         { return *seqPreCond_; }                                                \
                                                                                 \
         void cleanup()                                                          \
-        { delete seqPreCond_; }                                                 \
+        {                                                                       \
+            seqPreCond_.reset();                                                \
+            matrix_ = nullptr;                                                  \
+        }                                                                       \
                                                                                 \
     private:                                                                    \
-        SequentialPreconditioner *seqPreCond_;                                  \
+        std::unique_ptr<SequentialPreconditioner> seqPreCond_;                  \
+        const IstlMatrix* matrix_ = nullptr;                                    \
     };
 
 // the same as the EWOMS_WRAP_ISTL_PRECONDITIONER macro, but without
@@ -122,22 +138,32 @@ namespace Linear {
                 ("The relaxation factor of the preconditioner");                \
         }                                                                       \
                                                                                 \
-        void prepare(OverlappingMatrix& matrix)                                 \
+        bool prepare(OverlappingMatrix& matrix)                                 \
         {                                                                       \
+            /* the preconditioner only references the matrix */                 \
+            if (seqPreCond_ && matrix_ == &matrix)                              \
+                return false;                                                   \
+                                                                                \
             Scalar relaxationFactor =                                           \
                 Parameters::Get<Parameters::PreconditionerRelaxation<Scalar>>();\
-            seqPreCond_ = new SequentialPreconditioner(matrix,                  \
-                                                       relaxationFactor);       \
+            seqPreCond_ = std::make_unique<SequentialPreconditioner>(matrix,    \
+                                                                     relaxationFactor); \
+            matrix_ = &matrix;                                                  \
+            return true;                                                        \
         }                                                                       \
                                                                                 \
         SequentialPreconditioner& get()                                         \
         { return *seqPreCond_; }                                                \
                                                                                 \
         void cleanup()                                                          \
-        { delete seqPreCond_; }                                                 \
+        {                                                                       \
+            seqPreCond_.reset();                                                \
+            matrix_ = nullptr;                                                  \
+        }                                                                       \
                                                                                 \
     private:                                                                    \
-        SequentialPreconditioner *seqPreCond_;                                  \
+        std::unique_ptr<SequentialPreconditioner> seqPreCond_;                  \
+        const OverlappingMatrix* matrix_ = nullptr;                             \
     };
 
 EWOMS_WRAP_ISTL_PRECONDITIONER(Jacobi, Dune::SeqJac)
@@ -171,22 +197,24 @@ public:
             ("The order of the preconditioner");
     }
 
-    void prepare(OverlappingMatrix& matrix)
+    bool prepare(OverlappingMatrix& matrix)
     {
         Scalar relaxationFactor = Parameters::Get<Parameters::PreconditionerRelaxation<Scalar>>();
 
-        // create the sequential preconditioner.
-        seqPreCond_ = new SequentialPreconditioner(matrix, relaxationFactor);
+        // create the sequential preconditioner. since the ILU decomposition is computed
+        // by the constructor, this needs to be done for every linear solve.
+        seqPreCond_ = std::make_unique<SequentialPreconditioner>(matrix, relaxationFactor);
+        return true;
     }
 
     SequentialPreconditioner& get()
     { return *seqPreCond_; }
 
     void cleanup()
-    { delete seqPreCond_; }
+    { seqPreCond_.reset(); }
 
 private:
-    SequentialPreconditioner *seqPreCond_;
+    std::unique_ptr<SequentialPreconditioner> seqPreCond_;
 };
 
 #undef EWOMS_WRAP_ISTL_PRECONDITIONER
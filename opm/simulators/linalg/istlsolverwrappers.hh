@@ -40,6 +40,8 @@
  * - \c BiCGStab: A stabilized bi-conjugated gradients solver
  * - \c MinRes: A solver based on the  minimized residual algorithm
  * - \c RestartedGMRes: A restarted GMRES solver
+ * - \c RecycledGMRes: A restarted GMRES solver which recycles a deflation subspace
+ *   between the linear solves
  */
 #ifndef EWOMS_ISTL_SOLVER_WRAPPERS_HH
 #define EWOMS_ISTL_SOLVER_WRAPPERS_HH
@@ -51,6 +53,11 @@
 
 #include <opm/simulators/linalg/linalgparameters.hh>
 #include <opm/simulators/linalg/linalgproperties.hh>
+#include <opm/simulators/linalg/recycledgmressolver.hh>
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
 
 namespace Opm::Linear {
 
@@ -77,7 +84,8 @@ namespace Opm::Linear {
         template <class LinearOperator, class ScalarProduct, class Preconditioner> \
         std::shared_ptr<RawSolver> get(LinearOperator& parOperator,                \
                                        ScalarProduct& parScalarProduct,            \
-                                       Preconditioner& parPreCond)                 \
+                                       Preconditioner& parPreCond,                 \
+                                       int /*gridSequenceNumber*/)                 \
         {                                                                          \
             Scalar tolerance = Parameters::Get<Parameters::LinearSolverTolerance<Scalar>>(); \
             int maxIter = Parameters::Get<Parameters::LinearSolverMaxIterations>();\
@@ -132,7 +140,8 @@ public:
     template <class LinearOperator, class ScalarProduct, class Preconditioner>
     std::shared_ptr<RawSolver> get(LinearOperator& parOperator,
                                    ScalarProduct& parScalarProduct,
-                                   Preconditioner& parPreCond)
+                                   Preconditioner& parPreCond,
+                                   int /*gridSequenceNumber*/)
     {
         Scalar tolerance = Parameters::Get<Parameters::LinearSolverTolerance<Scalar>>();
         int maxIter = Parameters::Get<Parameters::LinearSolverMaxIterations>();
@@ -159,6 +168,77 @@ private:
     std::shared_ptr<RawSolver> solver_;
 };
 
+/*!
+ * \brief Solver wrapper for the GMRES solver which recycles a deflation subspace.
+ *
+ * In contrast to the other wrappers, this one keeps state between the linear solves:
+ * The recycled vectors survive the cleanup() of the solver object. They are discarded
+ * if the sequence number of the grid changes.
+ */
+template <class TypeTag>
+class SolverWrapperRecycledGMRes
+{
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using OverlappingVector = GetPropType<TypeTag, Properties::OverlappingVector>;
+
+public:
+    using RawSolver = RecycledGMResSolver<OverlappingVector>;
+
+    SolverWrapperRecycledGMRes()
+    {}
+
+    static void registerParameters()
+    {
+        Parameters::Register<Parameters::GMResRestart>
+            ("Number of iterations after which the GMRES linear solver is restarted");
+        Parameters::Register<Parameters::GMResRecycleSize>
+            ("Number of vectors which the GMRES linear solver keeps between the "
+             "solves to deflate the slowly converging modes");
+    }
+
+    template <class LinearOperator, class ScalarProduct, class Preconditioner>
+    std::shared_ptr<RawSolver> get(LinearOperator& parOperator,
+                                   ScalarProduct& parScalarProduct,
+                                   Preconditioner& parPreCond,
+                                   int gridSequenceNumber)
+    {
+        Scalar tolerance = Parameters::Get<Parameters::LinearSolverTolerance<Scalar>>();
+        int maxIter = Parameters::Get<Parameters::LinearSolverMaxIterations>();
+
+        int verbosity = 0;
+        if (parOperator.overlap().myRank() == 0)
+            verbosity = Parameters::Get<Parameters::LinearSolverVerbosity>();
+        int restartAfter = Parameters::Get<Parameters::GMResRestart>();
+        int recycleSize = std::max(Parameters::Get<Parameters::GMResRecycleSize>(), 0);
+
+        // the recycled vectors are meaningless if the grid has changed
+        if (gridSequenceNumber != gridSequenceNumber_) {
+            recycleSpace_.clear();
+            gridSequenceNumber_ = gridSequenceNumber;
+        }
+
+        solver_ = std::make_shared<RawSolver>(parOperator,
+                                              parScalarProduct,
+                                              parPreCond,
+                                              tolerance,
+                                              restartAfter,
+                                              maxIter,
+                                              verbosity,
+                                              static_cast<std::size_t>(recycleSize),
+                                              recycleSpace_);
+
+        return solver_;
+    }
+
+    void cleanup()
+    { solver_.reset(); }
+
+private:
+    std::shared_ptr<RawSolver> solver_;
+    GMResRecycleSpace<OverlappingVector> recycleSpace_;
+    int gridSequenceNumber_ = -1;
+};
+
 #undef EWOMS_WRAP_ISTL_SOLVER
 
 } // namespace Opm::Linear
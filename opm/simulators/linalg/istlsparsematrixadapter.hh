@@ -122,9 +122,21 @@ public:
 
     /*!
      * \brief Set all matrix entries to zero.
+     *
+     * The rows are processed by all threads. Since this is also done directly after
+     * the matrix has been allocated, the memory pages of the matrix get distributed
+     * over the memory nodes of the threads.
      */
     void clear()
-    { (*istlMatrix_) = Scalar(0.0); }
+    {
+        const int numRows = static_cast<int>(istlMatrix_->N());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+        for (int rowIdx = 0; rowIdx < numRows; ++rowIdx)
+            for (auto& block : (*istlMatrix_)[rowIdx])
+                block = Scalar(0.0);
+    }
 
     /*!
      * \brief Set given row to zero except for the main-diagonal entry (if it exists).
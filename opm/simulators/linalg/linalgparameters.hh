@@ -34,6 +34,9 @@ namespace Opm::Parameters {
 //! number of iterations between solver restarts for the GMRES solver
 struct GMResRestart { static constexpr int value = 10; };
 
+//! number of vectors which are kept between the solves by the recycling GMRES solver
+struct GMResRecycleSize { static constexpr int value = 5; };
+
 /*!
  * \brief Maximum accepted error of the norm of the residual.
  */
@@ -55,6 +58,15 @@ struct LinearSolverMaxIterations { static constexpr int value = 1000; };
  */
 struct LinearSolverOverlapSize { static constexpr unsigned value = 2; };
 
+/*!
+ * \brief The maximum number of iterative refinement steps of the linear solver.
+ *
+ * In each step, the residual of the current solution is computed in extended precision
+ * and the linear system is solved again for a correction. Zero disables the iterative
+ * refinement.
+ */
+struct LinearSolverRefinementSteps { static constexpr int value = 0; };
+
 /*!
  * \brief Maximum accepted error of the solution of the linear solver.
  */
@@ -78,6 +78,85 @@ private:
     bool converged_;
 };
 
+/*!
+ * \brief Collects information about the objects which a linear solver backend keeps
+ *        alive between the linear solves.
+ *
+ * Most of these objects only need to be created if the structure of the linear system
+ * changes. The ILU preconditioners and the AMG hierarchy are still rebuilt for every
+ * linear solve, though, and are thus counted every time. The number of created objects
+ * counts the objects which had to be (re-)created, the setup timer measures the time
+ * spent for preparing the linear system and the preconditioner.
+ */
+class SolverSetupReport
+{
+public:
+    SolverSetupReport()
+    { reset(); }
+
+    void reset()
+    {
+        setupTimer_.halt();
+        numSolves_ = 0;
+        numStructureSetups_ = 0;
+        numCreatedObjects_ = 0;
+    }
+
+    const Opm::Timer& setupTimer() const
+    { return setupTimer_; }
+
+    Opm::Timer& setupTimer()
+    { return setupTimer_; }
+
+    //! The number of linear solves since the last reset
+    unsigned numSolves() const
+    { return numSolves_; }
+
+    void incrementSolves()
+    { ++numSolves_; }
+
+    //! The number of times the structure of the linear system has been set up
+    unsigned numStructureSetups() const
+    { return numStructureSetups_; }
+
+    void incrementStructureSetups()
+    { ++numStructureSetups_; }
+
+    //! The number of objects which were created by the setup of the linear solver
+    unsigned numCreatedObjects() const
+    { return numCreatedObjects_; }
+
+    //! Count an object which was created by the setup of the linear solver
+    void addCreatedObject()
+    { ++numCreatedObjects_; }
+
+    /*!
+     * \brief Count the object which is pointed to by a freshly created pointer and
+     *        return the pointer.
+     */
+    template <class Ptr>
+    Ptr created(Ptr ptr)
+    {
+        ++numCreatedObjects_;
+        return ptr;
+    }
+
+    template <class Stream>
+    void print(Stream& os) const
+    {
+        os << "Linear solver setup: " << numSolves_ << " solves, "
+           << numStructureSetups_ << " structure setups, "
+           << numCreatedObjects_ << " objects created, "
+           << setupTimer_.realTimeElapsed() << " seconds\n";
+    }
+
+private:
+    Opm::Timer setupTimer_;
+    unsigned numSolves_;
+    unsigned numStructureSetups_;
+    unsigned numCreatedObjects_;
+};
+
 }} // end namespace Linear, Opm
 
 #endif
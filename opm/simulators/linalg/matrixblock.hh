@@ -33,7 +33,11 @@
 
 #include <opm/common/Exceptions.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
 #include <limits>
+#include <vector>
 
 namespace Opm {
 namespace detail {
@@ -220,6 +224,165 @@ static inline void invertMatrix(Dune::DynamicMatrix<K>& matrix)
      matrix.invert();
 }
 
+/*!
+ * \brief A kernel which inverts a batch of square blocks of the same size at once.
+ *
+ * The entries of the blocks are stored as a structure of arrays, i.e., the same entry
+ * of all blocks of a batch is contiguous in memory. Since the innermost loops run over
+ * the blocks of the batch, they can be executed in SIMD lanes. No pivoting is done, so
+ * each block of a batch is subject to the same sequence of operations. To limit the
+ * growth of the entries during the elimination, a block is reported as failed as soon
+ * as one of its pivots is smaller than a fixed fraction of the largest entry below it
+ * in the same column, i.e., whenever partial pivoting would have to swap rows to keep
+ * the multipliers bounded by 1/pivotThreshold(). Failed blocks must be handled by the
+ * caller.
+ */
+template <class K, int n>
+class BlockBatch
+{
+public:
+    //! The number of blocks which are processed at once
+    static constexpr int width = 8;
+
+    //! Copy a block into a lane of the batch
+    template <class Block>
+    void load(int lane, const Block& block)
+    {
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j)
+                a_[i][j][lane] = block[i][j];
+    }
+
+    //! Make a lane of the batch the identity matrix
+    void loadIdentity(int lane)
+    {
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j)
+                a_[i][j][lane] = (i == j) ? 1.0 : 0.0;
+    }
+
+    //! Copy a lane of the batch into a block
+    template <class Block>
+    void store(int lane, Block& block) const
+    {
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j)
+                block[i][j] = a_[i][j][lane];
+    }
+
+    //! Returns true if the pivots of a lane were too small in the last operation
+    bool failed(int lane) const
+    { return failed_[lane]; }
+
+    //! The smallest ratio between a pivot and the largest entry below it
+    static constexpr K pivotThreshold()
+    { return 0.1; }
+
+    //! Invert all blocks of the batch using Gauss-Jordan elimination
+    void invert()
+    {
+        computeTolerance_();
+        for (int k = 0; k < n; ++k) {
+            checkPivots_(k);
+            K pivotInv[width];
+            for (int l = 0; l < width; ++l) {
+                pivotInv[l] = 1.0/a_[k][k][l];
+                a_[k][k][l] = 1.0;
+            }
+            for (int j = 0; j < n; ++j)
+                for (int l = 0; l < width; ++l)
+                    a_[k][j][l] *= pivotInv[l];
+
+            for (int i = 0; i < n; ++i) {
+                if (i == k)
+                    continue;
+                K factor[width];
+                for (int l = 0; l < width; ++l) {
+                    factor[l] = a_[i][k][l];
+                    a_[i][k][l] = 0.0;
+                }
+                for (int j = 0; j < n; ++j)
+                    for (int l = 0; l < width; ++l)
+                        a_[i][j][l] -= factor[l]*a_[k][j][l];
+            }
+        }
+    }
+
+private:
+    // the pivots must never be smaller than this fraction of the largest entry
+    static constexpr K relativePivotTolerance_()
+    { return 1e3*std::numeric_limits<K>::epsilon(); }
+
+    void computeTolerance_()
+    {
+        for (int l = 0; l < width; ++l) {
+            K maxEntry = 0.0;
+            for (int i = 0; i < n; ++i)
+                for (int j = 0; j < n; ++j)
+                    maxEntry = std::max(maxEntry, std::abs(a_[i][j][l]));
+            tolerance_[l] = relativePivotTolerance_()*maxEntry;
+            failed_[l] = false;
+        }
+    }
+
+    // check the pivots of the k-th column of all lanes
+    void checkPivots_(int k)
+    {
+        K maxBelow[width];
+        for (int l = 0; l < width; ++l)
+            maxBelow[l] = 0.0;
+        for (int i = k + 1; i < n; ++i)
+            for (int l = 0; l < width; ++l)
+                maxBelow[l] = std::max(maxBelow[l], std::abs(a_[i][k][l]));
+
+        for (int l = 0; l < width; ++l) {
+            K& pivot = a_[k][k][l];
+            if (std::abs(pivot) > tolerance_[l]
+                && std::abs(pivot) >= pivotThreshold()*maxBelow[l])
+                continue;
+
+            // continue with a harmless value, the result of the lane is discarded anyway
+            failed_[l] = true;
+            pivot = 1.0;
+        }
+    }
+
+    K a_[n][n][width];
+    K tolerance_[width];
+    bool failed_[width];
+};
+
+// apply a kernel of BlockBatch to a sequence of blocks. lanes which fail are passed to
+// the fallback function.
+template <class Block, class Kernel, class Fallback>
+void forEachBlockBatch(Block* const* blocks, std::size_t numBlocks, Kernel kernel, Fallback fallback)
+{
+    using Batch = BlockBatch<typename Block::field_type, Block::rows>;
+    constexpr int width = Batch::width;
+
+    Batch batch;
+    for (std::size_t first = 0; first < numBlocks; first += width) {
+        const int numLanes = static_cast<int>(std::min<std::size_t>(width, numBlocks - first));
+        for (int l = 0; l < numLanes; ++l)
+            batch.load(l, *blocks[first + l]);
+        for (int l = numLanes; l < width; ++l)
+            batch.loadIdentity(l);
+
+        kernel(batch);
+
+        for (int l = 0; l < numLanes; ++l) {
+            if (batch.failed(l))
+                fallback(*blocks[first + l]);
+            else
+                batch.store(l, *blocks[first + l]);
+        }
+    }
+}
+
+template <class Block>
+constexpr bool useBlockBatch()
+{ return Block::rows == Block::cols && Block::rows >= 5 && Block::rows <= 8; }
+
 } // namespace detail
 
 template <class Scalar, int n, int m>
@@ -250,6 +413,39 @@ public:
     { return static_cast<BaseType&>(*this); }
 };
 
+/*!
+ * \brief Invert a number of square blocks in place.
+ *
+ * Blocks of size 5x5 to 8x8 are inverted in batches whose entries are processed in
+ * SIMD lanes. Blocks which would need pivoting (see BlockBatch) and all other block
+ * sizes are inverted one by one using the same method as MatrixBlock::invert().
+ */
+template <class Block>
+void invertBlocks(Block* const* blocks, std::size_t numBlocks)
+{
+    auto invertSingle = [](Block& block) { detail::invertMatrix(block); };
+
+    if constexpr (detail::useBlockBatch<Block>())
+        detail::forEachBlockBatch(blocks, numBlocks,
+                                  [](auto& batch) { batch.invert(); },
+                                  invertSingle);
+    else
+        for (std::size_t i = 0; i < numBlocks; ++i)
+            invertSingle(*blocks[i]);
+}
+
+/*!
+ * \brief Invert all blocks of a vector in place.
+ */
+template <class Block>
+void invertBlocks(std::vector<Block>& blocks)
+{
+    std::vector<Block*> blockPtrs(blocks.size());
+    for (std::size_t i = 0; i < blocks.size(); ++i)
+        blockPtrs[i] = &blocks[i];
+    invertBlocks(blockPtrs.data(), blockPtrs.size());
+}
+
 } // namespace Opm
 
 namespace Dune {
@@ -60,6 +60,10 @@ public:
 private:
     using Entries = std::vector<std::set<Index> >;
 
+    // the entries may be sent by syncAddBegin() before other messages are exchanged
+    // between the processes, so they use their own tag
+    static constexpr int entryValuesTag_ = 1;
+
 public:
     using ColIterator = typename ParentType::ColIterator;
     using ConstColIterator = typename ParentType::ConstColIterator;
@@ -229,41 +233,77 @@ public:
                 continue; // row corresponds to a black-listed entry
             }
 
-            auto nativeColIt = nativeMatrix[nativeRowIdx].begin();
-            const auto& nativeColEndIt = nativeMatrix[nativeRowIdx].end();
-            for (; nativeColIt != nativeColEndIt; ++nativeColIt) {
-                Index domesticColIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeColIt.index()));
+            assignRowFromNative_(nativeMatrix, nativeRowIdx, domesticRowIdx);
+        }
+    }
 
-                // make sure to include all off-diagonal entries, even those which belong
-                // to DOFs which are managed by a peer process. For this, we have to
-                // re-map the column index of the black-listed index to a native one.
-                if (domesticColIdx < 0)
-                    domesticColIdx = overlap_->blackList().nativeToDomestic(static_cast<Index>(nativeColIt.index()));
+    /*!
+     * \brief Returns the native indices of the rows which are sent to peer processes
+     *        by syncAdd().
+     *
+     * If the native matrix rows returned by this method are final, the communication
+     * can be started using assignSentRowsFromNative() and syncAddBegin() while the
+     * remaining rows are still being assembled.
+     */
+    std::vector<unsigned> sentNativeRows() const
+    {
+        std::vector<unsigned> result;
+        for (unsigned nativeRowIdx = 0; nativeRowIdx < overlap_->numNative(); ++nativeRowIdx) {
+            Index domesticRowIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeRowIdx));
+            if (domesticRowIdx >= 0 && isSentRow_[static_cast<unsigned>(domesticRowIdx)])
+                result.push_back(nativeRowIdx);
+        }
+        return result;
+    }
 
-                if (domesticColIdx < 0)
-                    // there is no domestic index which corresponds to a black-listed
-                    // one. this can happen if the grid overlap is larger than the
-                    // algebraic one...
-                    continue;
+    /*!
+     * \brief Set the matrix to zero and copy only the rows which are sent to peer
+     *        processes from the native matrix.
+     *
+     * The remaining rows are assigned by assignUnsentRowsFromNative().
+     */
+    template <class NativeBCRSMatrix>
+    void assignSentRowsFromNative(const NativeBCRSMatrix& nativeMatrix)
+    {
+        BCRSMatrix::operator=(0.0);
 
-                // we need to copy the block matrices manually since it seems that (at
-                // least some versions of) Dune have an endless recursion bug when
-                // assigning dense matrices of different field type
-                const auto& src = *nativeColIt;
-                auto& dest = (*this)[static_cast<unsigned>(domesticRowIdx)][static_cast<unsigned>(domesticColIdx)];
-                for (unsigned i = 0; i < src.rows; ++i) {
-                    for (unsigned j = 0; j < src.cols; ++j) {
-                        dest[i][j] = static_cast<field_type>(src[i][j]);
-                    }
-                }
-            }
+        for (unsigned nativeRowIdx = 0; nativeRowIdx < nativeMatrix.N(); ++nativeRowIdx) {
+            Index domesticRowIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeRowIdx));
+            if (domesticRowIdx >= 0 && isSentRow_[static_cast<unsigned>(domesticRowIdx)])
+                assignRowFromNative_(nativeMatrix, nativeRowIdx, domesticRowIdx);
+        }
+    }
+
+    /*!
+     * \brief Copy the rows which are not sent to peer processes from the native matrix.
+     *
+     * Together with assignSentRowsFromNative() this is equivalent to assignFromNative().
+     */
+    template <class NativeBCRSMatrix>
+    void assignUnsentRowsFromNative(const NativeBCRSMatrix& nativeMatrix)
+    {
+        for (unsigned nativeRowIdx = 0; nativeRowIdx < nativeMatrix.N(); ++nativeRowIdx) {
+            Index domesticRowIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeRowIdx));
+            if (domesticRowIdx >= 0 && !isSentRow_[static_cast<unsigned>(domesticRowIdx)])
+                assignRowFromNative_(nativeMatrix, nativeRowIdx, domesticRowIdx);
         }
     }
 
     // communicates and adds up the contents of overlapping rows
     void syncAdd()
     {
-        // first, send all entries to the peers
+        syncAddBegin();
+        syncAddEnd();
+    }
+
+    /*!
+     * \brief Start adding up the contents of overlapping rows by sending the
+     *        entries of the rows to the peers.
+     *
+     * The rows sent must not be modified until syncAddEnd() has been called.
+     */
+    void syncAddBegin()
+    {
         const PeerSet& peerSet = overlap_->peerSet();
         typename PeerSet::const_iterator peerIt = peerSet.begin();
         typename PeerSet::const_iterator peerEndIt = peerSet.end();
@@ -272,17 +312,25 @@ public:
 
             sendEntries_(peerRank);
         }
+    }
 
-        // then, receive entries from the peers
-        peerIt = peerSet.begin();
+    /*!
+     * \brief Finish adding up the contents of overlapping rows by receiving the
+     *        entries of the peers.
+     */
+    void syncAddEnd()
+    {
+        // receive entries from the peers
+        const PeerSet& peerSet = overlap_->peerSet();
+        typename PeerSet::const_iterator peerIt = peerSet.begin();
+        typename PeerSet::const_iterator peerEndIt = peerSet.end();
         for (; peerIt != peerEndIt; ++peerIt) {
             ProcessRank peerRank = *peerIt;
 
             receiveAddEntries_(peerRank);
         }
 
-        // finally, make sure that everything which we send was
-        // received by the peers
+        // make sure that everything which we send was received by the peers
         peerIt = peerSet.begin();
         for (; peerIt != peerEndIt; ++peerIt) {
             ProcessRank peerRank = *peerIt;
@@ -333,6 +381,48 @@ private:
 
         // communicate the entries
         buildIndices_(nativeMatrix);
+
+        // remember which rows are sent to the peers
+        isSentRow_.assign(numDomestic, false);
+        for (const auto& [peerRank, rowIndices] : rowIndicesSendBuff_)
+            for (unsigned i = 0; i < rowIndices->size(); ++i)
+                if ((*rowIndices)[i] >= 0)
+                    isSentRow_[static_cast<unsigned>((*rowIndices)[i])] = true;
+    }
+
+    template <class NativeBCRSMatrix>
+    void assignRowFromNative_(const NativeBCRSMatrix& nativeMatrix,
+                              unsigned nativeRowIdx,
+                              Index domesticRowIdx)
+    {
+        auto nativeColIt = nativeMatrix[nativeRowIdx].begin();
+        const auto& nativeColEndIt = nativeMatrix[nativeRowIdx].end();
+        for (; nativeColIt != nativeColEndIt; ++nativeColIt) {
+            Index domesticColIdx = overlap_->nativeToDomestic(static_cast<Index>(nativeColIt.index()));
+
+            // make sure to include all off-diagonal entries, even those which belong
+            // to DOFs which are managed by a peer process. For this, we have to
+            // re-map the column index of the black-listed index to a native one.
+            if (domesticColIdx < 0)
+                domesticColIdx = overlap_->blackList().nativeToDomestic(static_cast<Index>(nativeColIt.index()));
+
+            if (domesticColIdx < 0)
+                // there is no domestic index which corresponds to a black-listed
+                // one. this can happen if the grid overlap is larger than the
+                // algebraic one...
+                continue;
+
+            // we need to copy the block matrices manually since it seems that (at
+            // least some versions of) Dune have an endless recursion bug when
+            // assigning dense matrices of different field type
+            const auto& src = *nativeColIt;
+            auto& dest = (*this)[static_cast<unsigned>(domesticRowIdx)][static_cast<unsigned>(domesticColIdx)];
+            for (unsigned i = 0; i < src.rows; ++i) {
+                for (unsigned j = 0; j < src.cols; ++j) {
+                    dest[i][j] = static_cast<field_type>(src[i][j]);
+                }
+            }
+        }
     }
 
     template <class NativeBCRSMatrix>
@@ -603,7 +693,7 @@ private:
             }
         }
 
-        mpiSendBuff.send(peerRank);
+        mpiSendBuff.send(peerRank, entryValuesTag_);
 #endif // HAVE_MPI
     }
 
@@ -616,7 +706,7 @@ private:
         auto &mpiRowSizesRecvBuff = *rowSizesRecvBuff_[peerRank];
         auto &mpiColIndicesRecvBuff = *entryColIndicesRecvBuff_[peerRank];
 
-        mpiRecvBuff.receive(peerRank);
+        mpiRecvBuff.receive(peerRank, entryValuesTag_);
 
         // retrieve the values from the receive buffer
         unsigned k = 0;
@@ -644,7 +734,7 @@ private:
         MpiBuffer<unsigned> &mpiRowSizesRecvBuff = *rowSizesRecvBuff_[peerRank];
         MpiBuffer<Index> &mpiColIndicesRecvBuff = *entryColIndicesRecvBuff_[peerRank];
 
-        mpiRecvBuff.receive(peerRank);
+        mpiRecvBuff.receive(peerRank, entryValuesTag_);
 
         // retrieve the values from the receive buffer
         unsigned k = 0;
@@ -684,6 +774,8 @@ private:
     std::map<ProcessRank, MpiBuffer<Index> *> rowIndicesRecvBuff_;
     std::map<ProcessRank, MpiBuffer<Index> *> entryColIndicesRecvBuff_;
     std::map<ProcessRank, MpiBuffer<block_type> *> entryValuesRecvBuff_;
+
+    std::vector<bool> isSentRow_;
 };
 
 } // namespace Linear
@@ -167,16 +167,17 @@ protected:
 #if HAVE_MPI
         // create and initialize DUNE's OwnerOverlapCopyCommunication
         // using the domestic overlap
-        istlComm_ = std::make_shared<OwnerOverlapCopyCommunication>(MPI_COMM_WORLD);
+        istlComm_ = this->setupReport_.created(std::make_shared<OwnerOverlapCopyCommunication>(MPI_COMM_WORLD));
         setupAmgIndexSet_(this->overlappingMatrix_->overlap(), istlComm_->indexSet());
         istlComm_->remoteIndices().template rebuild<false>();
 #endif
 
         // create the parallel scalar product and the parallel operator
 #if HAVE_MPI
-        fineOperator_ = std::make_shared<FineOperator>(*this->overlappingMatrix_, *istlComm_);
+        fineOperator_ =
+            this->setupReport_.created(std::make_shared<FineOperator>(*this->overlappingMatrix_, *istlComm_));
 #else
-        fineOperator_ = std::make_shared<FineOperator>(*this->overlappingMatrix_);
+        fineOperator_ = this->setupReport_.created(std::make_shared<FineOperator>(*this->overlappingMatrix_));
 #endif
 
         setupAmg_();
@@ -309,9 +310,11 @@ protected:
 
 // instantiate the AMG preconditioner
 #if HAVE_MPI
-        amg_ = std::make_shared<AMG>(*fineOperator_, coarsenCriterion, smootherArgs, *istlComm_);
+        amg_ = this->setupReport_.created(std::make_shared<AMG>(*fineOperator_, coarsenCriterion,
+                                                                smootherArgs, *istlComm_));
 #else
-        amg_ = std::make_shared<AMG>(*fineOperator_, coarsenCriterion, smootherArgs);
+        amg_ = this->setupReport_.created(std::make_shared<AMG>(*fineOperator_, coarsenCriterion,
+                                                                smootherArgs));
 #endif
     }
 
@@ -29,6 +29,7 @@
 
 #include <dune/common/fvector.hh>
 #include <dune/common/version.hh>
+#include <dune/istl/bvector.hh>
 
 #include <dune/grid/io/file/vtk/vtkwriter.hh>
 
@@ -42,6 +43,7 @@
 #include <opm/simulators/linalg/istlsparsematrixadapter.hh>
 #include <opm/simulators/linalg/linalgparameters.hh>
 #include <opm/simulators/linalg/linalgproperties.hh>
+#include <opm/simulators/linalg/linearsolverreport.hh>
 #include <opm/simulators/linalg/matrixblock.hh>
 #include <opm/simulators/linalg/overlappingbcrsmatrix.hh>
 #include <opm/simulators/linalg/overlappingblockvector.hh>
@@ -49,9 +51,14 @@
 #include <opm/simulators/linalg/overlappingpreconditioner.hh>
 #include <opm/simulators/linalg/overlappingscalarproduct.hh>
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <sstream>
+#include <type_traits>
+#include <vector>
 
 namespace Opm::Properties {
 
@@ -132,20 +139,41 @@ protected:
                                                               OverlappingVector>;
 
     enum { dimWorld = GridView::dimensionworld };
+    enum { numEq = getPropValue<TypeTag, Properties::NumEq>() };
+
+    // the floating point type in which the residuals of the iterative refinement are
+    // computed: the scalar type of the model or long double, whichever is more accurate
+    using RefinementScalar = std::conditional_t<(std::numeric_limits<Scalar>::digits
+                                                 >= std::numeric_limits<long double>::digits),
+                                                Scalar, long double>;
+    using RefinementVector = Opm::Linear::OverlappingBlockVector<Dune::FieldVector<RefinementScalar, numEq>,
+                                                                 Overlap>;
+    using RefinementNativeVector = Dune::BlockVector<Dune::FieldVector<RefinementScalar, numEq>>;
+    using NativeMatrix = typename SparseMatrixAdapter::IstlMatrix;
 
 public:
     ParallelBaseBackend(const Simulator& simulator)
         : simulator_(simulator)
         , gridSequenceNumber_( -1 )
         , lastIterations_( -1 )
+        , matrixSyncStarted_( false )
     {
         overlappingMatrix_ = nullptr;
         overlappingb_ = nullptr;
         overlappingx_ = nullptr;
+
+        printSetupReport_ = simulator.gridView().comm().rank() == 0
+            && Parameters::Get<Parameters::LinearSolverVerbosity>() > 0;
     }
 
     ~ParallelBaseBackend()
-    { cleanup_(); }
+    {
+        // report the setup of the linear solver once for the whole run
+        if (printSetupReport_)
+            setupReport_.print(std::cout);
+
+        cleanup_();
+    }
 
     /*!
      * \brief Register all run-time parameters for the linear solver.
@@ -162,6 +190,9 @@ public:
             ("The maximum number of iterations of the linear solver");
         Parameters::Register<Parameters::LinearSolverVerbosity>
             ("The verbosity level of the linear solver");
+        Parameters::Register<Parameters::LinearSolverRefinementSteps>
+            ("The maximum number of iterative refinement steps based on residuals "
+             "which are computed in extended precision");
 
         PreconditionerWrapper::registerParameters();
     }
@@ -194,17 +225,38 @@ public:
         BorderListCreator borderListCreator(simulator_.gridView(),
                                             simulator_.model().dofMapper());
 
+        TimerGuard setupTimerGuard(setupReport_.setupTimer());
+        setupReport_.setupTimer().start();
+        setupReport_.incrementStructureSetups();
+
         // create the overlapping Jacobian matrix
         unsigned overlapSize = Parameters::Get<Parameters::LinearSolverOverlapSize>();
-        overlappingMatrix_ = new OverlappingMatrix(M.istlMatrix(),
-                                                   borderListCreator.borderList(),
-                                                   borderListCreator.blackList(),
-                                                   overlapSize);
+        overlappingMatrix_ =
+            setupReport_.created(new OverlappingMatrix(M.istlMatrix(),
+                                                       borderListCreator.borderList(),
+                                                       borderListCreator.blackList(),
+                                                       overlapSize));
 
         // create the overlapping vectors for the residual and the
         // solution
-        overlappingb_ = new OverlappingVector(overlappingMatrix_->overlap());
-        overlappingx_ = new OverlappingVector(*overlappingb_);
+        overlappingb_ = setupReport_.created(new OverlappingVector(overlappingMatrix_->overlap()));
+        overlappingx_ = setupReport_.created(new OverlappingVector(*overlappingb_));
+
+        // the parallel scalar product and operator only reference the overlap and the
+        // matrix, so they can be kept until the structure of the linear system changes
+        parScalarProduct_ =
+            setupReport_.created(std::make_unique<ParallelScalarProduct>(overlappingMatrix_->overlap()));
+        parOperator_ = setupReport_.created(std::make_unique<ParallelOperator>(*overlappingMatrix_));
+
+        refinementSteps_ = Parameters::Get<Parameters::LinearSolverRefinementSteps>();
+        if (refinementSteps_ > 0) {
+            refinementx_ =
+                setupReport_.created(std::make_unique<RefinementVector>(overlappingMatrix_->overlap()));
+            refinementr_ =
+                setupReport_.created(std::make_unique<RefinementVector>(overlappingMatrix_->overlap()));
+        }
+
+        sentMatrixRows_ = overlappingMatrix_->sentNativeRows();
 
         // writeOverlapToVTK_();
     }
@@ -219,6 +271,10 @@ public:
         // copy the interior values of the non-overlapping residual vector to the
         // overlapping one
         overlappingb_->assignAddBorder(b);
+
+        // keep the residual in the precision of the model for the iterative refinement
+        if (refinementSteps_ > 0)
+            refinementNativeb_ = b;
     }
 
     /*!
@@ -240,10 +296,60 @@ public:
      */
     void setMatrix(const SparseMatrixAdapter& M)
     {
+        // the residuals of the iterative refinement are computed using the Jacobian in
+        // the precision of the model, not with the one of the linear solver
+        refinementMatrix_ = &M.istlMatrix();
+
+        if (matrixSyncStarted_) {
+            // the rows which are sent to the peers have already been assigned by
+            // beginMatrixSync()
+            overlappingMatrix_->assignUnsentRowsFromNative(M.istlMatrix());
+            overlappingMatrix_->syncAddEnd();
+            matrixSyncStarted_ = false;
+            return;
+        }
+
         overlappingMatrix_->assignFromNative(M.istlMatrix());
         overlappingMatrix_->syncAdd();
     }
 
+    /*!
+     * \brief Returns the native indices of the matrix rows which need to be sent to the
+     *        peer processes, or nullptr if the linear system has not been prepared yet.
+     */
+    const std::vector<unsigned>* sentMatrixRows() const
+    { return overlappingMatrix_ ? &sentMatrixRows_ : nullptr; }
+
+    /*!
+     * \brief Start to synchronize the Jacobian matrix with the peer processes before
+     *        it has been fully assembled.
+     *
+     * The rows returned by sentMatrixRows() must be final when this method is called.
+     * The next call to setMatrix() then only assigns the remaining rows and finishes
+     * the communication. This must be called on all processes.
+     */
+    void beginMatrixSync(const SparseMatrixAdapter& M)
+    {
+        // finish the synchronization of a linearization which was not solved
+        cancelMatrixSync();
+
+        overlappingMatrix_->assignSentRowsFromNative(M.istlMatrix());
+        overlappingMatrix_->syncAddBegin();
+        matrixSyncStarted_ = true;
+    }
+
+    /*!
+     * \brief Finish a synchronization started by beginMatrixSync() without using it.
+     */
+    void cancelMatrixSync()
+    {
+        if (!matrixSyncStarted_)
+            return;
+
+        overlappingMatrix_->syncAddEnd();
+        matrixSyncStarted_ = false;
+    }
+
     /*!
      * \brief Actually solve the linear system of equations.
      *
@@ -252,18 +358,21 @@ public:
     bool solve(Vector& x)
     {
         (*overlappingx_) = 0.0;
+        setupReport_.incrementSolves();
 
-        auto parPreCond = asImp_().preparePreconditioner_();
+        decltype(asImp_().preparePreconditioner_()) parPreCond;
+        {
+            TimerGuard setupTimerGuard(setupReport_.setupTimer());
+            setupReport_.setupTimer().start();
+            parPreCond = asImp_().preparePreconditioner_();
+        }
         auto precondCleanupFn = [this]() -> void
                                 { this->asImp_().cleanupPreconditioner_(); };
         auto precondCleanupGuard = Opm::make_guard(precondCleanupFn);
-        // create the parallel scalar product and the parallel operator
-        ParallelScalarProduct parScalarProduct(overlappingMatrix_->overlap());
-        ParallelOperator parOperator(*overlappingMatrix_);
 
         // retrieve the linear solver
-        auto solver = asImp_().prepareSolver_(parOperator,
-                                              parScalarProduct,
+        auto solver = asImp_().prepareSolver_(*parOperator_,
+                                              *parScalarProduct_,
                                               *parPreCond);
 
         auto cleanupSolverFn =
@@ -277,7 +386,12 @@ public:
         lastIterations_ = result.second;
 
         // copy the result back to the non-overlapping vector
-        overlappingx_->assignTo(x);
+        if (result.first && refinementSteps_ > 0) {
+            refineSolution_(solver);
+            refinementx_->assignTo(x);
+        }
+        else
+            overlappingx_->assignTo(x);
 
         // return the result of the solver
         return result.first;
@@ -289,6 +403,17 @@ public:
     size_t iterations () const
     { return lastIterations_; }
 
+    /*!
+     * \brief Return the report about the setup of the linear solver.
+     *
+     * The objects which are required by the linear solver are kept alive as long as the
+     * structure of the linear system of equations does not change. If the verbosity of
+     * the linear solver is positive, the report is printed once when the backend is
+     * destroyed.
+     */
+    const SolverSetupReport& setupReport() const
+    { return setupReport_; }
+
 protected:
     Implementation& asImp_()
     { return *static_cast<Implementation *>(this); }
@@ -298,6 +423,14 @@ protected:
 
     void cleanup_()
     {
+        cancelMatrixSync();
+
+        // the preconditioner, the operator and the scalar product reference the matrix
+        parPreCond_.reset();
+        precWrapper_.cleanup();
+        parOperator_.reset();
+        parScalarProduct_.reset();
+
         // create the overlapping Jacobian matrix and vectors
         delete overlappingMatrix_;
         delete overlappingb_;
@@ -306,14 +439,104 @@ protected:
         overlappingMatrix_ = 0;
         overlappingb_ = 0;
         overlappingx_ = 0;
+
+        refinementx_.reset();
+        refinementr_.reset();
+        refinementMatrix_ = nullptr;
+    }
+
+    // Improve the solution of the linear solver by iterative refinement: the residual
+    // of the current solution is computed in extended precision and the linear system
+    // is solved for a correction using the solver's own precision. The refinement
+    // stops if the residual does not decrease significantly anymore.
+    template <class LinearSolver>
+    void refineSolution_(LinearSolver& solver)
+    {
+        auto& x = *refinementx_;
+        const std::size_t numRows = x.size();
+        for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+            for (int eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                x[rowIdx][eqIdx] = (*overlappingx_)[rowIdx][eqIdx];
+
+        const auto& comm = simulator_.gridView().comm();
+        double lastResidualNorm = std::numeric_limits<double>::max();
+        for (int stepIdx = 0; stepIdx < refinementSteps_; ++stepIdx) {
+            const double residualNorm = comm.max(computeRefinementResidual_());
+            if (residualNorm == 0.0 || residualNorm > 0.5*lastResidualNorm)
+                break;
+            lastResidualNorm = residualNorm;
+
+            // solve for the correction
+            const auto& r = *refinementr_;
+            for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+                for (int eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    (*overlappingb_)[rowIdx][eqIdx] = static_cast<LinearSolverScalar>(r[rowIdx][eqIdx]);
+            (*overlappingx_) = 0.0;
+            auto result = asImp_().runSolver_(solver);
+            lastIterations_ += result.second;
+            if (!result.first)
+                break;
+
+            for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+                for (int eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    x[rowIdx][eqIdx] += (*overlappingx_)[rowIdx][eqIdx];
+        }
+    }
+
+    // compute r = b - A*x in extended precision and return the maximum norm of r for the
+    // rows of the process. A and b are the native Jacobian and residual in the precision
+    // of the model, so the refinement converges to the solution of the model's linear
+    // system rather than to the one of its rounded copy used by the linear solver.
+    double computeRefinementResidual_()
+    {
+        const auto& A = *refinementMatrix_;
+        const auto& b = refinementNativeb_;
+        auto& x = refinementNativex_;
+        auto& r = refinementNativer_;
+        refinementx_->assignTo(x);
+        r.resize(b.size());
+
+        const int numRows = static_cast<int>(A.N());
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+        for (int rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+            auto& rRow = r[rowIdx];
+            for (int eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                rRow[eqIdx] = b[rowIdx][eqIdx];
+            const auto& row = A[rowIdx];
+            for (auto colIt = row.begin(); colIt != row.end(); ++colIt) {
+                const auto& block = *colIt;
+                const auto& xCol = x[colIt.index()];
+                for (int eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    for (int pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                        rRow[eqIdx] -= RefinementScalar(block[eqIdx][pvIdx])*xCol[pvIdx];
+            }
+        }
+
+        // the rows of the native Jacobian and residual only contain the contributions
+        // of the local elements, so the residuals of the border rows are added up like
+        // the ones of the right hand side in setResidual()
+        auto& overlappingr = *refinementr_;
+        overlappingr.assignAddBorder(r);
+
+        double maxNorm = 0.0;
+        for (std::size_t rowIdx = 0; rowIdx < overlappingr.size(); ++rowIdx)
+            for (int eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+                using std::abs;
+                maxNorm = std::max(maxNorm, static_cast<double>(abs(overlappingr[rowIdx][eqIdx])));
+            }
+
+        return maxNorm;
     }
 
     std::shared_ptr<ParallelPreconditioner> preparePreconditioner_()
     {
         int preconditionerIsReady = 1;
+        bool recreated = false;
         try {
             // update sequential preconditioner
-            precWrapper_.prepare(*overlappingMatrix_);
+            recreated = precWrapper_.prepare(*overlappingMatrix_);
         }
         catch (const Dune::Exception& e) {
             std::cout << "Preconditioner threw exception \"" << e.what()
@@ -328,13 +551,20 @@ protected:
         if (!preconditionerIsReady)
             throw NumericalProblem("Creating the preconditioner failed");
 
-        // create the parallel preconditioner
-        return std::make_shared<ParallelPreconditioner>(precWrapper_.get(), overlappingMatrix_->overlap());
+        // create the parallel preconditioner if the sequential one has changed
+        if (recreated)
+            setupReport_.addCreatedObject();
+        if (recreated || !parPreCond_)
+            parPreCond_ =
+                setupReport_.created(std::make_shared<ParallelPreconditioner>(precWrapper_.get(),
+                                                                              overlappingMatrix_->overlap()));
+
+        return parPreCond_;
     }
 
     void cleanupPreconditioner_()
     {
-        precWrapper_.cleanup();
+        // the preconditioner is kept until the structure of the linear system changes
     }
 
     void writeOverlapToVTK_()
@@ -382,7 +612,25 @@ protected:
     OverlappingVector *overlappingb_;
     OverlappingVector *overlappingx_;
 
+    std::vector<unsigned> sentMatrixRows_;
+    bool matrixSyncStarted_;
+
+    // iterative refinement of the solution
+    int refinementSteps_{0};
+    std::unique_ptr<RefinementVector> refinementx_;
+    std::unique_ptr<RefinementVector> refinementr_;
+    const NativeMatrix* refinementMatrix_{nullptr};
+    Vector refinementNativeb_;
+    RefinementNativeVector refinementNativex_;
+    RefinementNativeVector refinementNativer_;
+
     PreconditionerWrapper precWrapper_;
+    std::shared_ptr<ParallelPreconditioner> parPreCond_;
+    std::unique_ptr<ParallelScalarProduct> parScalarProduct_;
+    std::unique_ptr<ParallelOperator> parOperator_;
+
+    SolverSetupReport setupReport_;
+    bool printSetupReport_;
 };
 }} // namespace Linear, Opm
 
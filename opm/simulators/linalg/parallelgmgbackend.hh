@@ -0,0 +1,326 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::ParallelGmgBackend
+ */
+#ifndef EWOMS_PARALLEL_GMG_BACKEND_HH
+#define EWOMS_PARALLEL_GMG_BACKEND_HH
+
+#include <dune/common/fvector.hh>
+#include <dune/grid/common/rangegenerators.hh>
+
+#include <opm/common/Exceptions.hpp>
+
+#include <opm/simulators/linalg/bicgstabsolver.hh>
+#include <opm/simulators/linalg/combinedcriterion.hh>
+#include <opm/simulators/linalg/geometricmultigrid.hh>
+#include <opm/simulators/linalg/istlsparsematrixadapter.hh>
+#include <opm/simulators/linalg/linalgparameters.hh>
+#include <opm/simulators/linalg/linalgproperties.hh>
+#include <opm/simulators/linalg/overlappingpreconditioner.hh>
+#include <opm/simulators/linalg/parallelbasebackend.hh>
+
+#include <iostream>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace Opm::Linear {
+
+template <class TypeTag>
+class ParallelGmgBackend;
+
+} // namespace Opm::Linear
+
+namespace Opm::Properties {
+
+// Create new type tags
+namespace TTag {
+
+struct ParallelGmgLinearSolver
+{ using InheritsFrom = std::tuple<ParallelBaseLinearSolver>; };
+
+} // end namespace TTag
+
+template<class TypeTag>
+struct LinearSolverBackend<TypeTag, TTag::ParallelGmgLinearSolver>
+{ using type = Opm::Linear::ParallelGmgBackend<TypeTag>; };
+
+} // namespace Opm::Properties
+
+namespace Opm::Parameters {
+
+//! The maximum number of levels of the geometric multi-grid hierarchy
+struct GmgMaxLevels { static constexpr int value = 10; };
+
+//! The number of rows below which the geometric multi-grid stops coarsening and solves
+//! the coarsest level directly
+struct GmgCoarsenTarget { static constexpr int value = 100; };
+
+//! The number of pre- and post-smoothing steps of the geometric multi-grid
+struct GmgSmoothingSteps { static constexpr int value = 1; };
+
+} // namespace Opm::Parameters
+
+namespace Opm::Linear {
+
+/*!
+ * \ingroup Linear
+ *
+ * \brief Provides a linear solver backend which uses a geometric multi-grid
+ *        preconditioner for structured grids.
+ *
+ * The lattice is determined from the positions of the degrees of freedom, so this
+ * works for any grid whose degrees of freedom form a tensor product, e.g., the ones
+ * of the CubeGridVanguard and the StructuredGridVanguard. Knowing the structure
+ * avoids the aggregation which the algebraic multi-grid of the ParallelAmgBackend
+ * has to do for every linear solve. If the degrees of freedom do not form a lattice,
+ * the preconditioner degenerates to a symmetric block Gauss-Seidel smoother.
+ *
+ * In parallel, each process builds the hierarchy for the lattice of its own degrees
+ * of freedom and the multi-grid acts as the subdomain solver of an overlapping
+ * Schwarz method. The coupling between the processes is left to the stabilized
+ * bi-conjugated gradients solver which is preconditioned by it. Since the coarse levels
+ * are not distributed, there is no global coarse grid correction and the number of
+ * iterations grows with the number of processes.
+ *
+ * The backend is chosen via
+ * \code
+ * template<class TypeTag>
+ * struct LinearSolverSplice<TypeTag, TTag::YourTypeTag>
+ * { using type = TTag::ParallelGmgLinearSolver; };
+ * \endcode
+ */
+template <class TypeTag>
+class ParallelGmgBackend : public ParallelBaseBackend<TypeTag>
+{
+    using ParentType = ParallelBaseBackend<TypeTag>;
+
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+    using Simulator = GetPropType<TypeTag, Properties::Simulator>;
+    using GridView = GetPropType<TypeTag, Properties::GridView>;
+    using ElementContext = GetPropType<TypeTag, Properties::ElementContext>;
+    using Overlap = GetPropType<TypeTag, Properties::Overlap>;
+    using OverlappingMatrix = GetPropType<TypeTag, Properties::OverlappingMatrix>;
+    using SparseMatrixAdapter = GetPropType<TypeTag, Properties::SparseMatrixAdapter>;
+
+    using ParallelOperator = typename ParentType::ParallelOperator;
+    using OverlappingVector = typename ParentType::OverlappingVector;
+    using ParallelScalarProduct = typename ParentType::ParallelScalarProduct;
+
+    using MatrixBlock = typename SparseMatrixAdapter::MatrixBlock;
+    using LevelMatrix = Dune::BCRSMatrix<typename OverlappingMatrix::block_type>;
+    using Multigrid = GeometricMultigrid<LevelMatrix, OverlappingVector>;
+    using ParallelMultigrid = OverlappingPreconditioner<Multigrid, Overlap>;
+
+    using RawLinearSolver = BiCGStabSolver<ParallelOperator,
+                                           OverlappingVector,
+                                           ParallelMultigrid>;
+
+    enum { dimWorld = GridView::dimensionworld };
+    using GlobalPosition = Dune::FieldVector<Scalar, dimWorld>;
+
+    static_assert(std::is_same<SparseMatrixAdapter, IstlSparseMatrixAdapter<MatrixBlock> >::value,
+                  "The ParallelGmgBackend linear solver backend requires the IstlSparseMatrixAdapter");
+
+public:
+    ParallelGmgBackend(const Simulator& simulator)
+        : ParentType(simulator)
+    { }
+
+    static void registerParameters()
+    {
+        ParentType::registerParameters();
+
+        Parameters::Register<Parameters::LinearSolverMaxError<Scalar>>
+            ("The maximum residual error which the linear solver tolerates "
+             "without giving up");
+        Parameters::Register<Parameters::GmgMaxLevels>
+            ("The maximum number of levels of the geometric multi-grid hierarchy");
+        Parameters::Register<Parameters::GmgCoarsenTarget>
+            ("The number of matrix rows below which the geometric multi-grid "
+             "stops coarsening and solves the coarsest level directly");
+        Parameters::Register<Parameters::GmgSmoothingSteps>
+            ("The number of pre- and post-smoothing steps of the geometric multi-grid");
+    }
+
+protected:
+    friend ParentType;
+
+    void cleanup_()
+    {
+        parMultigrid_.reset();
+        multigrid_.reset();
+        hierarchyReported_ = false;
+
+        ParentType::cleanup_();
+    }
+
+    std::shared_ptr<ParallelMultigrid> preparePreconditioner_()
+    {
+        if (!multigrid_)
+            createMultigrid_();
+
+        // the hierarchy is built by the first update, afterwards only the values of
+        // the coarse matrices and of the smoothers are updated
+        int preconditionerIsReady = 1;
+        try {
+            multigrid_->update(*this->overlappingMatrix_);
+        }
+        catch (const Dune::Exception& e) {
+            std::cout << "Geometric multi-grid threw exception \"" << e.what()
+                      << " on rank " << this->overlappingMatrix_->overlap().myRank()
+                      << "\n"  << std::flush;
+            preconditionerIsReady = 0;
+        }
+
+        preconditionerIsReady = this->simulator_.gridView().comm().min(preconditionerIsReady);
+        if (!preconditionerIsReady)
+            throw NumericalProblem("Updating the geometric multi-grid failed");
+
+        if (!hierarchyReported_) {
+            reportHierarchy_();
+            hierarchyReported_ = true;
+        }
+
+        return parMultigrid_;
+    }
+
+    void cleanupPreconditioner_()
+    { /* nothing to do */ }
+
+    std::shared_ptr<RawLinearSolver> prepareSolver_(ParallelOperator& parOperator,
+                                                    ParallelScalarProduct& parScalarProduct,
+                                                    ParallelMultigrid& parPreCond)
+    {
+        const auto& gridView = this->simulator_.gridView();
+        using CCC = CombinedCriterion<OverlappingVector, decltype(gridView.comm())>;
+
+        Scalar linearSolverTolerance = Parameters::Get<Parameters::LinearSolverTolerance<Scalar>>();
+        Scalar linearSolverAbsTolerance = Parameters::Get<Parameters::LinearSolverAbsTolerance<Scalar>>();
+        if (linearSolverAbsTolerance < 0.0)
+            linearSolverAbsTolerance = this->simulator_.model().newtonMethod().tolerance()/100.0;
+
+        convCrit_.reset(new CCC(gridView.comm(),
+                                /*residualReductionTolerance=*/linearSolverTolerance,
+                                /*absoluteResidualTolerance=*/linearSolverAbsTolerance,
+                                Parameters::Get<Parameters::LinearSolverMaxError<Scalar>>()));
+
+        auto bicgstabSolver =
+            std::make_shared<RawLinearSolver>(parPreCond, *convCrit_, parScalarProduct);
+
+        int verbosity = 0;
+        if (parOperator.overlap().myRank() == 0)
+            verbosity = Parameters::Get<Parameters::LinearSolverVerbosity>();
+        bicgstabSolver->setVerbosity(verbosity);
+        bicgstabSolver->setMaxIterations(Parameters::Get<Parameters::LinearSolverMaxIterations>());
+        bicgstabSolver->setLinearOperator(&parOperator);
+        bicgstabSolver->setRhs(this->overlappingb_);
+
+        return bicgstabSolver;
+    }
+
+    std::pair<bool,int> runSolver_(std::shared_ptr<RawLinearSolver> solver)
+    {
+        bool converged = solver->apply(*this->overlappingx_);
+        return std::make_pair(converged, int(solver->report().iterations()));
+    }
+
+    void cleanupSolver_()
+    { /* nothing to do */ }
+
+    // determine the lattice of the degrees of freedom of the grid and map it to the
+    // rows of the overlapping matrix
+    void createMultigrid_()
+    {
+        const auto& simulator = this->simulator_;
+        const auto& model = simulator.model();
+        const auto& overlap = this->overlappingMatrix_->overlap();
+        const std::size_t numGridDof = model.numGridDof();
+
+        std::vector<GlobalPosition> dofPos(numGridDof);
+        ElementContext elemCtx(simulator);
+        for (const auto& elem : elements(simulator.gridView())) {
+            elemCtx.updatePrimaryStencil(elem);
+            for (unsigned dofIdx = 0; dofIdx < elemCtx.numPrimaryDof(/*timeIdx=*/0); ++dofIdx)
+                dofPos[elemCtx.globalSpaceIndex(dofIdx, /*timeIdx=*/0)] =
+                    elemCtx.pos(dofIdx, /*timeIdx=*/0);
+        }
+
+        LatticeSize size;
+        std::vector<int> dofPoint;
+        const bool isStructured = detectLattice(dofPos, dimWorld, size, dofPoint);
+        if (!isStructured)
+            std::cout << "The degrees of freedom on rank " << overlap.myRank()
+                      << " do not form a structured lattice. The geometric multi-grid "
+                      << "only uses the smoother there.\n" << std::flush;
+
+        const Index numDomestic = static_cast<Index>(overlap.numDomestic());
+        std::vector<int> rowPoint(numDomestic, -1);
+        if (isStructured) {
+            for (Index domIdx = 0; domIdx < numDomestic; ++domIdx) {
+                const Index nativeIdx = overlap.domesticToNative(domIdx);
+                if (nativeIdx >= 0 && static_cast<std::size_t>(nativeIdx) < numGridDof)
+                    rowPoint[domIdx] = dofPoint[nativeIdx];
+            }
+        }
+        else
+            size = {1, 1, 1};
+
+        auto& report = this->setupReport_;
+        multigrid_ =
+            report.created(std::make_unique<Multigrid>(size,
+                                                       std::move(rowPoint),
+                                                       Parameters::Get<Parameters::GmgMaxLevels>(),
+                                                       Parameters::Get<Parameters::GmgCoarsenTarget>(),
+                                                       Parameters::Get<Parameters::GmgSmoothingSteps>()));
+        parMultigrid_ = report.created(std::make_shared<ParallelMultigrid>(*multigrid_, overlap));
+    }
+
+    void reportHierarchy_() const
+    {
+        if (this->overlappingMatrix_->overlap().myRank() != 0
+            || Parameters::Get<Parameters::LinearSolverVerbosity>() < 1)
+            return;
+
+        std::cout << "Geometric multi-grid hierarchy on rank 0:\n";
+        for (std::size_t levelIdx = 0; levelIdx < multigrid_->numLevels(); ++levelIdx) {
+            const auto& size = multigrid_->latticeSize(levelIdx);
+            std::cout << "  level " << levelIdx << ": "
+                      << multigrid_->numRows(levelIdx) << " rows, lattice "
+                      << size[0] << "x" << size[1] << "x" << size[2] << "\n";
+        }
+        std::cout << std::flush;
+    }
+
+    std::unique_ptr<ConvergenceCriterion<OverlappingVector> > convCrit_;
+
+    std::unique_ptr<Multigrid> multigrid_;
+    std::shared_ptr<ParallelMultigrid> parMultigrid_;
+    bool hierarchyReported_{false};
+};
+
+} // namespace Opm::Linear
+
+#endif
@@ -61,6 +61,7 @@ namespace Opm::Linear {
  * - \c BiCGStab: A stabilized bi-conjugated gradients solver
  * - \c MinRes: A solver based on the  minimized residual algorithm
  * - \c RestartedGMRes: A restarted GMRES solver
+ * - \c RecycledGMRes: A restarted GMRES solver which recycles a deflation subspace
  *
  * Chosing the preconditioner works in an analogous way:
  * \code
@@ -122,7 +123,8 @@ protected:
     {
         return solverWrapper_.get(parOperator,
                                   parScalarProduct,
-                                  parPreCond);
+                                  parPreCond,
+                                  this->gridSequenceNumber_);
     }
 
     void cleanupSolver_()
@@ -0,0 +1,634 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::RecycledGMResSolver
+ */
+#ifndef EWOMS_RECYCLED_GMRES_SOLVER_HH
+#define EWOMS_RECYCLED_GMRES_SOLVER_HH
+
+#include <dune/common/ftraits.hh>
+#include <dune/common/timer.hh>
+
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioner.hh>
+#include <dune/istl/scalarproducts.hh>
+#include <dune/istl/solver.hh>
+#include <dune/istl/solvercategory.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+namespace detail {
+
+/*!
+ * \brief Solves a small dense system of equations using Gaussian elimination with
+ *        partial pivoting.
+ *
+ * The matrix is stored row-wise in \c a and gets overwritten. Vanishing pivots are
+ * replaced by a tiny value, so that the result is usable for inverse iteration.
+ */
+template <class Scalar>
+void solveDense(std::vector<std::complex<Scalar>>& a,
+                std::vector<std::complex<Scalar>>& x,
+                std::size_t n)
+{
+    Scalar matrixNorm = 0.0;
+    for (const auto& value : a)
+        matrixNorm = std::max(matrixNorm, std::abs(value));
+    const Scalar tinyPivot = std::max(matrixNorm, Scalar{1.0})*std::numeric_limits<Scalar>::epsilon();
+
+    for (std::size_t k = 0; k < n; ++k) {
+        std::size_t pivotRow = k;
+        for (std::size_t i = k + 1; i < n; ++i)
+            if (std::abs(a[i*n + k]) > std::abs(a[pivotRow*n + k]))
+                pivotRow = i;
+        if (pivotRow != k) {
+            for (std::size_t j = 0; j < n; ++j)
+                std::swap(a[k*n + j], a[pivotRow*n + j]);
+            std::swap(x[k], x[pivotRow]);
+        }
+        if (std::abs(a[k*n + k]) < tinyPivot)
+            a[k*n + k] = tinyPivot;
+
+        for (std::size_t i = k + 1; i < n; ++i) {
+            const std::complex<Scalar> factor = a[i*n + k]/a[k*n + k];
+            for (std::size_t j = k + 1; j < n; ++j)
+                a[i*n + j] -= factor*a[k*n + j];
+            x[i] -= factor*x[k];
+        }
+    }
+
+    for (std::size_t k = n; k-- > 0;) {
+        for (std::size_t j = k + 1; j < n; ++j)
+            x[k] -= a[k*n + j]*x[j];
+        x[k] /= a[k*n + k];
+    }
+}
+
+/*!
+ * \brief Computes the eigenvalues of a small upper Hessenberg matrix using the QR
+ *        algorithm with Wilkinson shifts.
+ *
+ * The matrix is stored row-wise in \c a and gets overwritten.
+ *
+ * \return false if the QR iterations did not converge
+ */
+template <class Scalar>
+bool hessenbergEigenvalues(std::vector<std::complex<Scalar>>& a,
+                           std::vector<std::complex<Scalar>>& eigenvalues,
+                           std::size_t n)
+{
+    using Complex = std::complex<Scalar>;
+    const Scalar eps = std::numeric_limits<Scalar>::epsilon();
+    const auto at = [&a, n](std::size_t i, std::size_t j) -> Complex& { return a[i*n + j]; };
+
+    eigenvalues.clear();
+    std::size_t last = n;
+    int numIterations = 0;
+    while (last > 0) {
+        const std::size_t l = last - 1;
+
+        // find the beginning of the unreduced block which ends at row l
+        std::size_t k = l;
+        while (k > 0) {
+            const Scalar scale = std::abs(at(k, k)) + std::abs(at(k - 1, k - 1));
+            if (std::abs(at(k, k - 1)) <= eps*scale) {
+                at(k, k - 1) = 0.0;
+                break;
+            }
+            --k;
+        }
+
+        if (k == l) {
+            eigenvalues.push_back(at(l, l));
+            --last;
+            numIterations = 0;
+            continue;
+        }
+
+        if (++numIterations > 100)
+            return false;
+
+        // the eigenvalue of the trailing 2x2 block which is closer to its last
+        // diagonal entry. every tenth iteration an exceptional shift is used.
+        Complex shift;
+        if (numIterations % 10 == 0)
+            shift = at(l, l) + std::abs(at(l, l - 1));
+        else {
+            const Complex halfTrace = (at(l - 1, l - 1) + at(l, l))/Scalar{2.0};
+            const Complex det = at(l - 1, l - 1)*at(l, l) - at(l - 1, l)*at(l, l - 1);
+            const Complex disc = std::sqrt(halfTrace*halfTrace - det);
+            const Complex mu1 = halfTrace + disc;
+            const Complex mu2 = halfTrace - disc;
+            shift = (std::abs(mu1 - at(l, l)) < std::abs(mu2 - at(l, l))) ? mu1 : mu2;
+        }
+
+        // one QR step on the block [k, l] using Givens rotations
+        for (std::size_t i = k; i <= l; ++i)
+            at(i, i) -= shift;
+
+        std::vector<Complex> cosines(l - k);
+        std::vector<Complex> sines(l - k);
+        for (std::size_t j = k; j < l; ++j) {
+            const Complex x = at(j, j);
+            const Complex y = at(j + 1, j);
+            const Scalar r = std::hypot(std::abs(x), std::abs(y));
+            const Complex c = (r > 0.0) ? x/r : Complex{1.0};
+            const Complex s = (r > 0.0) ? y/r : Complex{0.0};
+            cosines[j - k] = c;
+            sines[j - k] = s;
+            for (std::size_t col = j; col <= l; ++col) {
+                const Complex u = at(j, col);
+                const Complex v = at(j + 1, col);
+                at(j, col) = std::conj(c)*u + std::conj(s)*v;
+                at(j + 1, col) = -s*u + c*v;
+            }
+        }
+        for (std::size_t j = k; j < l; ++j) {
+            const Complex c = cosines[j - k];
+            const Complex s = sines[j - k];
+            for (std::size_t row = k; row <= j + 1; ++row) {
+                const Complex u = at(row, j);
+                const Complex v = at(row, j + 1);
+                at(row, j) = u*c + v*s;
+                at(row, j + 1) = -u*std::conj(s) + v*std::conj(c);
+            }
+        }
+
+        for (std::size_t i = k; i <= l; ++i)
+            at(i, i) += shift;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief Computes the real bases of the harmonic Ritz vectors of a GMRES cycle which
+ *        belong to the harmonic Ritz values of smallest magnitude.
+ *
+ * \c hessenberg is the (n + 1) x n Hessenberg matrix of the Arnoldi process. The
+ * harmonic Ritz pairs are the eigenpairs of H_n + h_{n+1,n}^2 (H_n^{-T} e_n) e_n^T.
+ * For complex pairs, the real and imaginary parts of the eigenvector are used. At
+ * most \c maxVectors vectors of length n are returned.
+ */
+template <class Scalar>
+std::vector<std::vector<Scalar>>
+harmonicRitzVectors(const std::vector<std::vector<Scalar>>& hessenberg,
+                    std::size_t n,
+                    std::size_t maxVectors)
+{
+    using Complex = std::complex<Scalar>;
+
+    std::vector<std::vector<Scalar>> result;
+    if (n == 0 || maxVectors == 0)
+        return result;
+
+    // f = H_n^{-T} e_n
+    std::vector<Complex> ht(n*n);
+    for (std::size_t i = 0; i < n; ++i)
+        for (std::size_t j = 0; j < n; ++j)
+            ht[i*n + j] = hessenberg[j][i];
+    std::vector<Complex> f(n, 0.0);
+    f[n - 1] = 1.0;
+    solveDense(ht, f, n);
+
+    const Scalar h = hessenberg[n][n - 1];
+    std::vector<Complex> g(n*n);
+    for (std::size_t i = 0; i < n; ++i) {
+        for (std::size_t j = 0; j < n; ++j)
+            g[i*n + j] = hessenberg[i][j];
+        g[i*n + n - 1] += h*h*f[i];
+    }
+
+    std::vector<Complex> eigenvalues;
+    std::vector<Complex> work(g);
+    if (!hessenbergEigenvalues(work, eigenvalues, n))
+        return result;
+
+    std::vector<std::size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&eigenvalues](std::size_t i, std::size_t j)
+              { return std::abs(eigenvalues[i]) < std::abs(eigenvalues[j]); });
+
+    Scalar gNorm = 0.0;
+    for (const auto& value : g)
+        gNorm = std::max(gNorm, std::abs(value));
+    const Scalar eps = std::numeric_limits<Scalar>::epsilon();
+
+    for (std::size_t idx = 0; idx < n && result.size() < maxVectors; ++idx) {
+        const Complex theta = eigenvalues[order[idx]];
+        const bool isComplex = std::abs(theta.imag()) > std::sqrt(eps)*std::abs(theta);
+        // the conjugate eigenvector is covered by the real and imaginary parts
+        if (isComplex && theta.imag() < 0.0)
+            continue;
+
+        // inverse iteration with a slightly perturbed shift
+        const Complex shift = theta + Complex{eps*std::max(gNorm, Scalar{1.0})};
+        std::vector<Complex> p(n, 1.0);
+        for (int iterIdx = 0; iterIdx < 3; ++iterIdx) {
+            std::vector<Complex> shifted(g);
+            for (std::size_t i = 0; i < n; ++i)
+                shifted[i*n + i] -= shift;
+            solveDense(shifted, p, n);
+
+            Scalar pNorm = 0.0;
+            for (const auto& value : p)
+                pNorm = std::max(pNorm, std::abs(value));
+            if (!std::isfinite(pNorm) || pNorm == 0.0)
+                break;
+            for (auto& value : p)
+                value /= pNorm;
+        }
+
+        std::vector<Scalar> realPart(n);
+        std::vector<Scalar> imagPart(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            realPart[i] = p[i].real();
+            imagPart[i] = p[i].imag();
+        }
+        result.push_back(std::move(realPart));
+        if (isComplex && result.size() < maxVectors)
+            result.push_back(std::move(imagPart));
+    }
+
+    return result;
+}
+
+} // namespace detail
+
+/*!
+ * \brief The vectors which are recycled by the RecycledGMResSolver.
+ *
+ * This object outlives the individual solver objects, so that the subspace which was
+ * found during a linear solve can be used by the next one.
+ */
+template <class X>
+class GMResRecycleSpace
+{
+public:
+    //! Returns the number of recycled vectors.
+    std::size_t size() const
+    { return vectors_.size(); }
+
+    //! Forget about all recycled vectors.
+    void clear()
+    { vectors_.clear(); }
+
+    std::vector<X>& vectors()
+    { return vectors_; }
+
+private:
+    std::vector<X> vectors_;
+};
+
+/*!
+ * \ingroup Linear
+ *
+ * \brief A restarted GMRES solver which recycles a deflation subspace between
+ *        subsequent solves.
+ *
+ * The solver follows the idea of GCRO-DR (Parks et al., 2006): after each GMRES cycle,
+ * the harmonic Ritz vectors which belong to the harmonic Ritz values of smallest
+ * magnitude are added to the vectors U of a GMResRecycleSpace. For the current matrix,
+ * C = A U is computed and orthonormalized and the residual is projected onto the
+ * complement of the range of C. The GMRES iterations are then done for the deflated
+ * operator (I - C C^T) A. Since the recycle space outlives the solver object, the
+ * slowly converging modes do not need to be rediscovered by every linear solve of a
+ * Newton-Raphson method. The price are the additional applications of the operator to
+ * the recycled vectors at the beginning of each cycle.
+ *
+ * The preconditioner is applied from the right and its results are stored, so that it
+ * may change between the iterations.
+ */
+template <class X>
+class RecycledGMResSolver : public Dune::InverseOperator<X, X>
+{
+    using field_type = typename X::field_type;
+    using real_type = typename Dune::FieldTraits<field_type>::real_type;
+    using DenseMatrix = std::vector<std::vector<field_type>>;
+
+public:
+    RecycledGMResSolver(Dune::LinearOperator<X, X>& op,
+                        Dune::ScalarProduct<X>& scalarProduct,
+                        Dune::Preconditioner<X, X>& preconditioner,
+                        real_type reduction,
+                        int restart,
+                        int maxIterations,
+                        int verbosity,
+                        std::size_t recycleSize,
+                        GMResRecycleSpace<X>& recycleSpace)
+        : op_(op)
+        , scalarProduct_(scalarProduct)
+        , preconditioner_(preconditioner)
+        , reduction_(reduction)
+        , restart_(std::max(restart, 1))
+        , maxIterations_(maxIterations)
+        , verbosity_(verbosity)
+        , recycleSize_(recycleSize)
+        , recycleSpace_(recycleSpace)
+    {}
+
+    void apply(X& x, X& b, Dune::InverseOperatorResult& res) override
+    { apply(x, b, reduction_, res); }
+
+    void apply(X& x, X& b, double reduction, Dune::InverseOperatorResult& res) override
+    {
+        Dune::Timer watch;
+        res.clear();
+        operatorApplications_ = 0;
+
+        auto& U = recycleSpace_.vectors();
+        if (!U.empty() && U.front().size() != b.size())
+            U.clear();
+
+        preconditioner_.pre(x, b);
+
+        X w(b);
+        X r(b);
+        applyOperator_(x, w);
+        r -= w;
+        const real_type def0 = scalarProduct_.norm(r);
+
+        std::vector<X> C;
+        computeDeflationSpace_(C);
+        project_(C, x, r);
+        real_type def = scalarProduct_.norm(r);
+
+        if (verbosity_ > 0)
+            std::cout << "=== RecycledGMResSolver: " << C.size()
+                      << " deflation vectors, defect " << def0
+                      << " -> " << def << " after deflation\n";
+
+        std::vector<X> V;
+        std::vector<X> Z;
+        V.reserve(restart_ + 1);
+        Z.reserve(restart_);
+        DenseMatrix H(restart_ + 1, std::vector<field_type>(restart_, 0.0));
+        DenseMatrix R(restart_ + 1, std::vector<field_type>(restart_, 0.0));
+        DenseMatrix E(C.size(), std::vector<field_type>(restart_, 0.0));
+        std::vector<field_type> cs(restart_);
+        std::vector<field_type> sn(restart_);
+        std::vector<field_type> g(restart_ + 1);
+
+        int iterations = 0;
+        bool converged = !(def > reduction*def0);
+        while (!converged && iterations < maxIterations_) {
+            V.clear();
+            Z.clear();
+            V.push_back(r);
+            V[0] *= 1.0/def;
+            std::fill(g.begin(), g.end(), 0.0);
+            g[0] = def;
+
+            std::size_t n = 0;
+            while (n < static_cast<std::size_t>(restart_) && iterations < maxIterations_) {
+                const std::size_t j = n;
+                Z.push_back(b);
+                Z[j] = 0.0;
+                preconditioner_.apply(Z[j], V[j]);
+                applyOperator_(Z[j], w);
+
+                // deflate and orthogonalize against the Krylov basis
+                for (std::size_t i = 0; i < C.size(); ++i) {
+                    E[i][j] = scalarProduct_.dot(C[i], w);
+                    w.axpy(-E[i][j], C[i]);
+                }
+                for (std::size_t i = 0; i <= j; ++i) {
+                    H[i][j] = scalarProduct_.dot(V[i], w);
+                    w.axpy(-H[i][j], V[i]);
+                }
+                H[j + 1][j] = scalarProduct_.norm(w);
+
+                // update the QR decomposition of the Hessenberg matrix
+                for (std::size_t i = 0; i <= j + 1; ++i)
+                    R[i][j] = H[i][j];
+                for (std::size_t i = 0; i < j; ++i) {
+                    const field_type tmp = cs[i]*R[i][j] + sn[i]*R[i + 1][j];
+                    R[i + 1][j] = -sn[i]*R[i][j] + cs[i]*R[i + 1][j];
+                    R[i][j] = tmp;
+                }
+                const real_type rho = std::hypot(R[j][j], R[j + 1][j]);
+                cs[j] = (rho > 0.0) ? R[j][j]/rho : field_type{1.0};
+                sn[j] = (rho > 0.0) ? R[j + 1][j]/rho : field_type{0.0};
+                R[j][j] = rho;
+                R[j + 1][j] = 0.0;
+                g[j + 1] = -sn[j]*g[j];
+                g[j] = cs[j]*g[j];
+
+                ++n;
+                ++iterations;
+                def = std::abs(g[n]);
+                if (verbosity_ > 1)
+                    std::cout << "=== RecycledGMResSolver: iteration " << iterations
+                              << ", defect " << def << "\n";
+
+                if (!(def > reduction*def0) || !(H[j + 1][j] > 0.0))
+                    break;
+
+                V.push_back(w);
+                V[n] *= 1.0/H[j + 1][j];
+            }
+
+            // solve the least squares problem and update the solution
+            std::vector<field_type> y(g.begin(), g.begin() + n);
+            for (std::size_t i = n; i-- > 0;) {
+                for (std::size_t k = i + 1; k < n; ++k)
+                    y[i] -= R[i][k]*y[k];
+                y[i] /= R[i][i];
+            }
+
+            w = 0.0;
+            for (std::size_t k = 0; k < n; ++k)
+                w.axpy(y[k], Z[k]);
+            for (std::size_t i = 0; i < C.size(); ++i) {
+                field_type e = 0.0;
+                for (std::size_t k = 0; k < n; ++k)
+                    e += E[i][k]*y[k];
+                w.axpy(-e, U[i]);
+            }
+            x += w;
+
+            // augment the deflation space by the harmonic Ritz vectors of this cycle
+            // and use the true residual for the next cycle
+            updateRecycleSpace_(H, E, Z, n);
+            computeDeflationSpace_(C);
+            E.resize(C.size(), std::vector<field_type>(restart_, 0.0));
+            applyOperator_(x, w);
+            r = b;
+            r -= w;
+            project_(C, x, r);
+            def = scalarProduct_.norm(r);
+            converged = !(def > reduction*def0);
+        }
+
+        preconditioner_.post(x);
+
+        res.iterations = iterations;
+        res.reduction = (def0 > 0.0) ? static_cast<double>(def/def0) : 0.0;
+        res.converged = converged;
+        res.conv_rate = (iterations > 0) ? std::pow(res.reduction, 1.0/iterations) : 0.0;
+        res.elapsed = watch.elapsed();
+
+        if (verbosity_ > 0)
+            std::cout << "=== RecycledGMResSolver: " << (converged ? "converged" : "failed")
+                      << " after " << iterations << " iterations and "
+                      << operatorApplications_ << " operator applications, reduction "
+                      << res.reduction << ", " << recycleSpace_.size()
+                      << " vectors recycled\n";
+    }
+
+    Dune::SolverCategory::Category category() const override
+    { return Dune::SolverCategory::category(op_); }
+
+    /*!
+     * \brief Returns the number of times the operator was applied by the last solve.
+     *
+     * In contrast to the number of iterations reported by the InverseOperatorResult,
+     * this includes the applications to the recycled vectors at the beginning of each
+     * cycle and the ones for the true residuals, i.e., it is a measure for the actual
+     * costs of the solve.
+     */
+    int operatorApplications() const
+    { return operatorApplications_; }
+
+private:
+    void applyOperator_(const X& x, X& y)
+    {
+        op_.apply(x, y);
+        ++operatorApplications_;
+    }
+
+    // compute C = A U for the current matrix and orthonormalize C using modified
+    // Gram-Schmidt. U is transformed alongside, so that C = A U still holds. Vectors
+    // which have become linearly dependent are dropped.
+    void computeDeflationSpace_(std::vector<X>& C)
+    {
+        auto& U = recycleSpace_.vectors();
+        const real_type dropTolerance = std::sqrt(std::numeric_limits<real_type>::epsilon());
+
+        C.clear();
+        std::size_t numKept = 0;
+        for (std::size_t i = 0; i < U.size(); ++i) {
+            X c(U[i]);
+            applyOperator_(U[i], c);
+            const real_type origNorm = scalarProduct_.norm(c);
+            for (std::size_t j = 0; j < numKept; ++j) {
+                const field_type alpha = scalarProduct_.dot(C[j], c);
+                c.axpy(-alpha, C[j]);
+                U[i].axpy(-alpha, U[j]);
+            }
+
+            const real_type norm = scalarProduct_.norm(c);
+            if (!(norm > dropTolerance*origNorm))
+                continue;
+
+            c *= 1.0/norm;
+            U[i] *= 1.0/norm;
+            if (i != numKept)
+                std::swap(U[numKept], U[i]);
+            C.push_back(std::move(c));
+            ++numKept;
+        }
+        U.resize(numKept);
+    }
+
+    // x += U C^T r, r -= C C^T r
+    void project_(const std::vector<X>& C, X& x, X& r)
+    {
+        const auto& U = recycleSpace_.vectors();
+        for (std::size_t i = 0; i < C.size(); ++i) {
+            const field_type alpha = scalarProduct_.dot(C[i], r);
+            x.axpy(alpha, U[i]);
+            r.axpy(-alpha, C[i]);
+        }
+    }
+
+    // replace the oldest recycled vectors by the harmonic Ritz vectors of a GMRES
+    // cycle
+    void updateRecycleSpace_(const DenseMatrix& H,
+                             const DenseMatrix& E,
+                             const std::vector<X>& Z,
+                             std::size_t n)
+    {
+        auto& U = recycleSpace_.vectors();
+        if (recycleSize_ == 0) {
+            U.clear();
+            return;
+        }
+        if (n == 0)
+            return;
+
+        std::vector<std::vector<double>> hessenberg(n + 1, std::vector<double>(n));
+        for (std::size_t i = 0; i <= n; ++i)
+            for (std::size_t j = 0; j < n; ++j)
+                hessenberg[i][j] = static_cast<double>(H[i][j]);
+        const auto ritzVectors = detail::harmonicRitzVectors(hessenberg, n, recycleSize_);
+
+        std::vector<X> newVectors;
+        newVectors.reserve(recycleSize_);
+        for (const auto& p : ritzVectors) {
+            X u(Z[0]);
+            u = 0.0;
+            for (std::size_t k = 0; k < n; ++k)
+                u.axpy(static_cast<field_type>(p[k]), Z[k]);
+            for (std::size_t i = 0; i < E.size(); ++i) {
+                field_type e = 0.0;
+                for (std::size_t k = 0; k < n; ++k)
+                    e += E[i][k]*static_cast<field_type>(p[k]);
+                u.axpy(-e, U[i]);
+            }
+            newVectors.push_back(std::move(u));
+        }
+
+        for (std::size_t i = 0; i < U.size() && newVectors.size() < recycleSize_; ++i)
+            newVectors.push_back(std::move(U[i]));
+        U = std::move(newVectors);
+    }
+
+    Dune::LinearOperator<X, X>& op_;
+    Dune::ScalarProduct<X>& scalarProduct_;
+    Dune::Preconditioner<X, X>& preconditioner_;
+    real_type reduction_;
+    int restart_;
+    int maxIterations_;
+    int verbosity_;
+    std::size_t recycleSize_;
+    GMResRecycleSpace<X>& recycleSpace_;
+    int operatorApplications_ = 0;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
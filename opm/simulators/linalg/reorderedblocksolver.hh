@@ -0,0 +1,333 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ * \copydoc Opm::Linear::ReorderedBlockSolver
+ */
+#ifndef EWOMS_REORDERED_BLOCK_SOLVER_HH
+#define EWOMS_REORDERED_BLOCK_SOLVER_HH
+
+#include <opm/simulators/linalg/matrixblock.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace Opm {
+namespace Linear {
+
+/*!
+ * \ingroup Linear
+ *
+ * \brief Solves block-sparse linear systems of equations whose dependency graph is
+ *        (almost) acyclic by processing the rows in topological order.
+ *
+ * Row i depends on row j if the off-diagonal block (i, j) of the matrix is non-zero.
+ * For the transport equations of upwind discretizations with a fixed pressure, this
+ * graph is given by the upwind directions of the fluxes and is mostly free of cycles.
+ *
+ * The strongly connected components of the dependency graph are determined using
+ * Tarjan's algorithm. Components which consist of a single row are solved directly
+ * using the inverse of the diagonal block, larger ones are solved by block
+ * Gauss-Seidel iterations. Components which do not depend on each other are grouped
+ * into levels and the components of a level are processed in parallel.
+ */
+template <class Matrix, class Vector>
+class ReorderedBlockSolver
+{
+    using Block = typename Matrix::block_type;
+    using VectorBlock = typename Vector::block_type;
+    using Scalar = typename Block::field_type;
+
+public:
+    ReorderedBlockSolver(Scalar tolerance, int maxIterations)
+        : tolerance_(tolerance)
+        , maxIterations_(maxIterations)
+    {}
+
+    /*!
+     * \brief Set the matrix of the linear system and determine the order in which
+     *        the rows are processed.
+     *
+     * The matrix must stay alive and unchanged until solve() has been called.
+     */
+    void setMatrix(const Matrix& matrix)
+    {
+        const std::size_t numRows = matrix.N();
+
+        // extract the dependency graph and the inverse diagonal blocks
+        adjStart_.assign(numRows + 1, 0);
+        adjCol_.clear();
+        adjBlock_.clear();
+        diagInv_.resize(numRows);
+        std::vector<Block*> diagBlocks;
+        diagBlocks.reserve(numRows);
+        for (auto row = matrix.begin(); row != matrix.end(); ++row) {
+            const std::size_t rowIdx = row.index();
+            for (auto col = row->begin(); col != row->end(); ++col) {
+                if (col.index() == rowIdx) {
+                    diagInv_[rowIdx] = *col;
+                    diagBlocks.push_back(&diagInv_[rowIdx]);
+                }
+                else if (isNonZero_(*col)) {
+                    adjCol_.push_back(col.index());
+                    adjBlock_.push_back(&(*col));
+                }
+            }
+            adjStart_[rowIdx + 1] = adjCol_.size();
+        }
+        invertBlocks(diagBlocks.data(), diagBlocks.size());
+
+        computeComponents_(numRows);
+        computeLevels_();
+    }
+
+    /*!
+     * \brief Solve the linear system for a given right hand side.
+     *
+     * \return false if the Gauss-Seidel iterations of a strongly connected component
+     *         did not converge
+     */
+    bool solve(Vector& x, const Vector& b) const
+    {
+        x = 0.0;
+        bool converged = true;
+        for (std::size_t levelIdx = 0; levelIdx + 1 < levelStart_.size(); ++levelIdx) {
+            const int begin = levelStart_[levelIdx];
+            const int end = levelStart_[levelIdx + 1];
+#ifdef _OPENMP
+#pragma omp parallel for reduction(&&:converged)
+#endif
+            for (int i = begin; i < end; ++i)
+                converged = solveComponent_(componentsByLevel_[i], x, b) && converged;
+        }
+
+        return converged;
+    }
+
+    /*!
+     * \brief Returns the number of strongly connected components of the dependency
+     *        graph.
+     */
+    std::size_t numComponents() const
+    { return compStart_.size() - 1; }
+
+    /*!
+     * \brief Returns the number of rows of the largest strongly connected component.
+     */
+    std::size_t maxComponentSize() const
+    {
+        std::size_t result = 0;
+        for (std::size_t compIdx = 0; compIdx + 1 < compStart_.size(); ++compIdx)
+            result = std::max(result, compStart_[compIdx + 1] - compStart_[compIdx]);
+        return result;
+    }
+
+    /*!
+     * \brief Returns the number of levels, i.e., the length of the longest chain of
+     *        components which depend on each other.
+     */
+    std::size_t numLevels() const
+    { return levelStart_.size() - 1; }
+
+private:
+    static bool isNonZero_(const Block& block)
+    {
+        for (const auto& row : block)
+            for (const auto& value : row)
+                if (value != 0.0)
+                    return true;
+        return false;
+    }
+
+    // compute the residual of a row using the current approximation of the solution
+    void rowRhs_(VectorBlock& rhs, std::size_t rowIdx, const Vector& x, const Vector& b) const
+    {
+        rhs = b[rowIdx];
+        for (std::size_t k = adjStart_[rowIdx]; k < adjStart_[rowIdx + 1]; ++k)
+            adjBlock_[k]->mmv(x[adjCol_[k]], rhs);
+    }
+
+    bool solveComponent_(std::size_t compIdx, Vector& x, const Vector& b) const
+    {
+        VectorBlock rhs;
+        const std::size_t begin = compStart_[compIdx];
+        const std::size_t end = compStart_[compIdx + 1];
+        if (end - begin == 1) {
+            const std::size_t rowIdx = compRows_[begin];
+            rowRhs_(rhs, rowIdx, x, b);
+            diagInv_[rowIdx].mv(rhs, x[rowIdx]);
+            return true;
+        }
+
+        // block Gauss-Seidel iterations for components with cycles
+        VectorBlock newValue;
+        for (int iterIdx = 0; iterIdx < maxIterations_; ++iterIdx) {
+            Scalar maxDelta = 0.0;
+            Scalar maxValue = 0.0;
+            for (std::size_t k = begin; k < end; ++k) {
+                const std::size_t rowIdx = compRows_[k];
+                rowRhs_(rhs, rowIdx, x, b);
+                diagInv_[rowIdx].mv(rhs, newValue);
+
+                for (std::size_t i = 0; i < newValue.size(); ++i) {
+                    maxDelta = std::max(maxDelta, std::abs(newValue[i] - x[rowIdx][i]));
+                    maxValue = std::max(maxValue, std::abs(newValue[i]));
+                }
+                x[rowIdx] = newValue;
+            }
+
+            if (maxDelta <= tolerance_*maxValue)
+                return true;
+        }
+
+        return false;
+    }
+
+    // Tarjan's algorithm without recursion. The components are found in an order in
+    // which each component only depends on components which have been found before.
+    void computeComponents_(std::size_t numRows)
+    {
+        constexpr int unvisited = -1;
+        std::vector<int> index(numRows, unvisited);
+        std::vector<int> lowLink(numRows, 0);
+        std::vector<bool> onStack(numRows, false);
+        std::vector<std::size_t> stack;
+        std::vector<std::pair<std::size_t, std::size_t>> callStack;
+
+        compStart_.assign(1, 0);
+        compRows_.clear();
+        compIdx_.assign(numRows, 0);
+
+        int nextIndex = 0;
+        for (std::size_t startRow = 0; startRow < numRows; ++startRow) {
+            if (index[startRow] != unvisited)
+                continue;
+
+            callStack.emplace_back(startRow, adjStart_[startRow]);
+            index[startRow] = lowLink[startRow] = nextIndex++;
+            stack.push_back(startRow);
+            onStack[startRow] = true;
+
+            while (!callStack.empty()) {
+                auto& [rowIdx, edgeIdx] = callStack.back();
+                const std::size_t v = rowIdx;
+                bool descended = false;
+                for (; edgeIdx < adjStart_[v + 1]; ++edgeIdx) {
+                    const std::size_t w = adjCol_[edgeIdx];
+                    if (index[w] == unvisited) {
+                        ++edgeIdx;
+                        index[w] = lowLink[w] = nextIndex++;
+                        stack.push_back(w);
+                        onStack[w] = true;
+                        callStack.emplace_back(w, adjStart_[w]);
+                        descended = true;
+                        break;
+                    }
+                    else if (onStack[w])
+                        lowLink[v] = std::min(lowLink[v], index[w]);
+                }
+                if (descended)
+                    continue;
+
+                // all dependencies of v have been visited
+                if (lowLink[v] == index[v]) {
+                    const std::size_t compIdx = compStart_.size() - 1;
+                    std::size_t w;
+                    do {
+                        w = stack.back();
+                        stack.pop_back();
+                        onStack[w] = false;
+                        compIdx_[w] = compIdx;
+                        compRows_.push_back(w);
+                    } while (w != v);
+                    compStart_.push_back(compRows_.size());
+                }
+
+                callStack.pop_back();
+                if (!callStack.empty()) {
+                    const std::size_t u = callStack.back().first;
+                    lowLink[u] = std::min(lowLink[u], lowLink[v]);
+                }
+            }
+        }
+    }
+
+    // group the components into levels of mutually independent components
+    void computeLevels_()
+    {
+        const std::size_t numComps = compStart_.size() - 1;
+        std::vector<int> level(numComps, 0);
+        int maxLevel = -1;
+        for (std::size_t compIdx = 0; compIdx < numComps; ++compIdx) {
+            int compLevel = 0;
+            for (std::size_t k = compStart_[compIdx]; k < compStart_[compIdx + 1]; ++k) {
+                const std::size_t rowIdx = compRows_[k];
+                for (std::size_t e = adjStart_[rowIdx]; e < adjStart_[rowIdx + 1]; ++e) {
+                    const std::size_t depComp = compIdx_[adjCol_[e]];
+                    if (depComp != compIdx)
+                        compLevel = std::max(compLevel, level[depComp] + 1);
+                }
+            }
+            level[compIdx] = compLevel;
+            maxLevel = std::max(maxLevel, compLevel);
+        }
+
+        // bucket sort of the components by their level
+        levelStart_.assign(maxLevel + 2, 0);
+        for (std::size_t compIdx = 0; compIdx < numComps; ++compIdx)
+            ++levelStart_[level[compIdx] + 1];
+        for (std::size_t levelIdx = 1; levelIdx < levelStart_.size(); ++levelIdx)
+            levelStart_[levelIdx] += levelStart_[levelIdx - 1];
+
+        componentsByLevel_.resize(numComps);
+        std::vector<int> pos(levelStart_.begin(), levelStart_.end() - 1);
+        for (std::size_t compIdx = 0; compIdx < numComps; ++compIdx)
+            componentsByLevel_[pos[level[compIdx]]++] = compIdx;
+    }
+
+    Scalar tolerance_;
+    int maxIterations_;
+
+    // dependency graph in compressed row format
+    std::vector<std::size_t> adjStart_;
+    std::vector<std::size_t> adjCol_;
+    std::vector<const Block*> adjBlock_;
+    std::vector<Block> diagInv_;
+
+    // strongly connected components in compressed format
+    std::vector<std::size_t> compStart_;
+    std::vector<std::size_t> compRows_;
+    std::vector<std::size_t> compIdx_;
+
+    // components sorted by level
+    std::vector<int> levelStart_;
+    std::vector<std::size_t> componentsByLevel_;
+};
+
+} // namespace Linear
+} // namespace Opm
+
+#endif
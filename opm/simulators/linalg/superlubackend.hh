@@ -39,8 +39,13 @@
 
 #include <opm/models/utils/parametersystem.hh>
 
+#include <opm/simulators/linalg/linalgparameters.hh>
 #include <opm/simulators/linalg/linalgproperties.hh>
 
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
 namespace Opm::Properties::TTag {
 
 struct SuperLULinearSolver {};
@@ -75,6 +80,9 @@ public:
     {
         Parameters::Register<Parameters::LinearSolverVerbosity>
             ("The verbosity level of the linear solver");
+        Parameters::Register<Parameters::LinearSolverRefinementSteps>
+            ("The number of iterative refinement steps based on residuals which are "
+             "computed in extended precision");
     }
 
     /*!
@@ -119,6 +127,17 @@ public:
         Dune::SuperLU<Matrix> solver(A, verbosity > 0);
         solver.apply(x, bTmp, result);
 
+        // iterative refinement: the factorization is reused to solve for corrections
+        // whose residuals are computed in extended precision
+        const int refinementSteps = Parameters::Get<Parameters::LinearSolverRefinementSteps>();
+        for (int stepIdx = 0; result.converged && stepIdx < refinementSteps; ++stepIdx) {
+            computeResidual_(A, x, b, bTmp);
+            Vector dx(x.size());
+            dx = 0.0;
+            solver.apply(dx, bTmp, result);
+            x += dx;
+        }
+
         if (result.converged) {
             // make sure that the result only contains finite values.
             Scalar tmp = 0;
@@ -132,12 +151,40 @@ public:
 
         return result.converged;
     }
+
+private:
+    using ExtendedScalar = std::conditional_t<(std::numeric_limits<Scalar>::digits
+                                               >= std::numeric_limits<long double>::digits),
+                                              Scalar, long double>;
+
+    // compute r = b - A*x with the products summed up in extended precision
+    static void computeResidual_(const Matrix& A, const Vector& x, const Vector& b, Vector& r)
+    {
+        constexpr int numEq = Vector::block_type::dimension;
+        r.resize(b.size());
+        for (auto rowIt = A.begin(); rowIt != A.end(); ++rowIt) {
+            const auto rowIdx = rowIt.index();
+            ExtendedScalar rRow[numEq];
+            for (int eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                rRow[eqIdx] = b[rowIdx][eqIdx];
+            for (auto colIt = rowIt->begin(); colIt != rowIt->end(); ++colIt) {
+                const auto& block = *colIt;
+                const auto& xCol = x[colIt.index()];
+                for (int eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                    for (int pvIdx = 0; pvIdx < numEq; ++pvIdx)
+                        rRow[eqIdx] -= ExtendedScalar(block[eqIdx][pvIdx])*xCol[pvIdx];
+            }
+            for (int eqIdx = 0; eqIdx < numEq; ++eqIdx)
+                r[rowIdx][eqIdx] = static_cast<Scalar>(rRow[eqIdx]);
+        }
+    }
 };
 
 // the following is required to make the SuperLU adapter of dune-istl happy with
 // quadruple precision math on Dune 2.4. this is because the most which SuperLU can
-// handle is double precision (i.e., the linear systems of equations are always solved
-// with at most double precision if chosing SuperLU as the linear solver...)
+// handle is double precision. To still get solutions which are more accurate than
+// that, the double precision factorization is used for iterative refinement with
+// residuals that are computed in quadruple precision.
 #if HAVE_QUAD
 template <class TypeTag, class Matrix, class Vector>
 class SuperLUSolve_<__float128, TypeTag, Matrix, Vector>
@@ -153,20 +200,45 @@ public:
         using DoubleVector = Dune::BlockVector<DoubleEqVector>;
         using DoubleMatrix = Dune::BCRSMatrix<DoubleEqMatrix>;
 
-        // copy the inputs into the double precision data structures
-        DoubleVector bDouble(b);
-        DoubleVector xDouble(x);
+        // copy the matrix into the double precision data structure and factorize it
         DoubleMatrix ADouble(A);
+        int verbosity = Parameters::Get<Parameters::LinearSolverVerbosity>();
+        Dune::SuperLU<DoubleMatrix> solver(ADouble, verbosity > 0);
+
+        // the first step solves for the solution itself, all further ones solve for a
+        // correction of the solution using the residual in quadruple precision
+        const int refinementSteps = Parameters::Get<Parameters::LinearSolverRefinementSteps>();
+        Vector residual(b);
+        x = 0.0;
+        for (int stepIdx = 0; stepIdx <= refinementSteps; ++stepIdx) {
+            if (stepIdx > 0) {
+                residual = b;
+                A.mmv(x, residual);
+            }
 
-        bool res =
-            SuperLUSolve_<double, TypeTag, Matrix, Vector>::solve_(ADouble,
-                                                                   xDouble,
-                                                                   bDouble);
-
-        // copy the result back into the quadruple precision vector.
-        x = xDouble;
+            DoubleVector rDouble(residual.size());
+            DoubleVector dxDouble(residual.size());
+            for (unsigned i = 0; i < residual.size(); ++i)
+                for (unsigned j = 0; j < numEq; ++j)
+                    rDouble[i][j] = static_cast<double>(residual[i][j]);
+            dxDouble = 0.0;
+
+            Dune::InverseOperatorResult result;
+            solver.apply(dxDouble, rDouble, result);
+            if (!result.converged)
+                return false;
+
+            for (unsigned i = 0; i < x.size(); ++i)
+                for (unsigned j = 0; j < numEq; ++j)
+                    x[i][j] += dxDouble[i][j];
+        }
 
-        return res;
+        // make sure that the result only contains finite values.
+        __float128 tmp = 0;
+        for (unsigned i = 0; i < x.size(); ++i)
+            for (unsigned j = 0; j < numEq; ++j)
+                tmp += x[i][j];
+        return std::isfinite(static_cast<double>(tmp));
     }
 };
 #endif
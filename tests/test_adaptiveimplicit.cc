@@ -0,0 +1,242 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Checks the fluxes of the adaptive implicit formulation of the TPFA black-oil
+ *        residual against the fully implicit ones.
+ *
+ * At the beginning of a time step, the properties of the explicit upstream cells are
+ * those of the current solution, so the fluxes must agree with the fully implicit
+ * ones. Faces between two explicit cells must only have derivatives with regard to
+ * the pressure, because the linearizer skips all other derivatives of these faces.
+ */
+#include "config.h"
+
+#include <opm/models/io/dgfvanguard.hh>
+#include <opm/models/utils/start.hh>
+#include <opm/models/blackoil/blackoilmodel.hh>
+#include <opm/models/blackoil/blackoillocalresidualtpfa.hh>
+#include <opm/models/discretization/ecfv/ecfvdiscretization.hh>
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#include "problems/reservoirproblem.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace Opm {
+
+// The TPFA residual computes the phase pressure differences using the extensive
+// quantities of the simulator's transmissibility module, which are not available
+// here. This provides the same interface for a plain two-point pressure difference
+// with gravity.
+template <class TypeTag>
+class AdaptiveImplicitTestExtensiveQuantities : public BlackOilExtensiveQuantities<TypeTag>
+{
+    using Evaluation = GetPropType<TypeTag, Properties::Evaluation>;
+    using Scalar = GetPropType<TypeTag, Properties::Scalar>;
+
+public:
+    template <class IntensiveQuantities, class ModuleParams>
+    static void calculatePhasePressureDiff_(short& upIdx,
+                                            short& dnIdx,
+                                            Evaluation& pressureDifference,
+                                            const IntensiveQuantities& intQuantsIn,
+                                            const IntensiveQuantities& intQuantsEx,
+                                            unsigned phaseIdx,
+                                            short interiorDofIdx,
+                                            short exteriorDofIdx,
+                                            Scalar /*Vin*/,
+                                            Scalar /*Vex*/,
+                                            unsigned /*globalIndexIn*/,
+                                            unsigned /*globalIndexEx*/,
+                                            Scalar distZg,
+                                            Scalar /*thpres*/,
+                                            const ModuleParams& /*moduleParams*/)
+    {
+        const auto& fsIn = intQuantsIn.fluidState();
+        const auto& fsEx = intQuantsEx.fluidState();
+        const Evaluation rhoAvg = (fsIn.density(phaseIdx) + getValue(fsEx.density(phaseIdx)))/2;
+        pressureDifference = getValue(fsEx.pressure(phaseIdx)) - fsIn.pressure(phaseIdx)
+            + rhoAvg*distZg;
+
+        if (pressureDifference > 0.0) {
+            upIdx = exteriorDofIdx;
+            dnIdx = interiorDofIdx;
+        }
+        else {
+            upIdx = interiorDofIdx;
+            dnIdx = exteriorDofIdx;
+        }
+    }
+};
+
+} // namespace Opm
+
+namespace Opm::Properties {
+
+namespace TTag {
+
+struct ReservoirAdaptiveImplicitProblem
+{ using InheritsFrom = std::tuple<ReservoirBaseProblem, BlackOilModel>; };
+
+} // end namespace TTag
+
+template<class TypeTag>
+struct SpatialDiscretizationSplice<TypeTag, TTag::ReservoirAdaptiveImplicitProblem>
+{ using type = TTag::EcfvDiscretization; };
+
+template<class TypeTag>
+struct LocalLinearizerSplice<TypeTag, TTag::ReservoirAdaptiveImplicitProblem>
+{ using type = TTag::AutoDiffLocalLinearizer; };
+
+template<class TypeTag>
+struct ExtensiveQuantities<TypeTag, TTag::ReservoirAdaptiveImplicitProblem>
+{ using type = AdaptiveImplicitTestExtensiveQuantities<TypeTag>; };
+
+} // namespace Opm::Properties
+
+using TypeTag = Opm::Properties::TTag::ReservoirAdaptiveImplicitProblem;
+using Simulator = Opm::GetPropType<TypeTag, Opm::Properties::Simulator>;
+using GridView = Opm::GetPropType<TypeTag, Opm::Properties::GridView>;
+using Indices = Opm::GetPropType<TypeTag, Opm::Properties::Indices>;
+using RateVector = Opm::GetPropType<TypeTag, Opm::Properties::RateVector>;
+using LocalResidual = Opm::BlackOilLocalResidualTPFA<TypeTag>;
+constexpr unsigned numEq = Opm::getPropValue<TypeTag, Opm::Properties::NumEq>();
+using ResidualNBInfo = typename LocalResidual::ResidualNBInfo;
+
+int main(int argc, char** argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+
+    const std::vector<const char*> args = { "test_adaptiveimplicit",
+                                            "--end-time=8750000",
+                                            "--initial-time-step-size=100000",
+                                            "--enable-intensive-quantity-cache=true",
+                                            "--enable-vtk-output=false" };
+    Opm::setupParameters_<TypeTag>(static_cast<int>(args.size()),
+                                   args.data(),
+                                   /*registerParams=*/true,
+                                   /*allowUnused=*/false,
+                                   /*handleHelp=*/false);
+    Opm::GetPropType<TypeTag, Opm::Properties::ThreadManager>::init();
+
+    Simulator simulator(/*verbose=*/false);
+    simulator.model().applyInitialSolution();
+    simulator.model().invalidateAndUpdateIntensiveQuantities(/*timeIdx=*/0);
+
+    const auto& gridView = simulator.gridView();
+    const auto& elementMapper = simulator.model().elementMapper();
+    const double gravity = 9.80665;
+    const typename LocalResidual::ModuleParams moduleParams{};
+
+    double maxValue = 0.0;
+    double maxValueDiff = 0.0;
+    double maxNonPressureDerivative = 0.0;
+    std::size_t numFaces = 0;
+    for (const auto& element : elements(gridView)) {
+        const unsigned globI = elementMapper.index(element);
+        const auto* intQuantsIn = simulator.model().cachedIntensiveQuantities(globI, /*timeIdx=*/0);
+        for (const auto& intersection : intersections(gridView, element)) {
+            if (!intersection.neighbor())
+                continue;
+
+            const unsigned globJ = elementMapper.index(intersection.outside());
+            const auto* intQuantsEx = simulator.model().cachedIntensiveQuantities(globJ, /*timeIdx=*/0);
+            if (!intQuantsIn || !intQuantsEx) {
+                std::cerr << "The intensive quantities are not cached\n";
+                return EXIT_FAILURE;
+            }
+
+            const double zIn = element.geometry().center()[GridView::dimensionworld - 1];
+            const double zEx = intersection.outside().geometry().center()[GridView::dimensionworld - 1];
+            ResidualNBInfo implicitInfo{/*trans=*/1e-12, /*faceArea=*/intersection.geometry().volume(),
+                                        /*thpres=*/0.0, /*dZg=*/(zIn - zEx)*gravity,
+                                        Opm::FaceDir::DirEnum::Unknown,
+                                        /*Vin=*/0.0, /*Vex=*/0.0,
+                                        /*inAlpha=*/0.0, /*outAlpha=*/0.0,
+                                        /*diffusivity=*/0.0, /*dispersivity=*/0.0,
+                                        /*diffusion=*/{}, /*dispersion=*/{},
+                                        /*convectiveMixing=*/{}, /*adaptiveImplicit=*/{}};
+
+            RateVector implicitFlux;
+            RateVector darcy;
+            LocalResidual::computeFlux(implicitFlux, darcy, globI, globJ,
+                                       *intQuantsIn, *intQuantsEx, implicitInfo, moduleParams);
+
+            // all combinations of explicit cells
+            for (int explicitness = 1; explicitness < 4; ++explicitness) {
+                ResidualNBInfo explicitInfo = implicitInfo;
+                const bool explicitIn = explicitness & 1;
+                const bool explicitEx = explicitness & 2;
+                LocalResidual::updateAdaptiveImplicitInfo(explicitInfo, explicitIn, explicitEx,
+                                                          *intQuantsIn, *intQuantsEx);
+
+                RateVector explicitFlux;
+                LocalResidual::computeFlux(explicitFlux, darcy, globI, globJ,
+                                           *intQuantsIn, *intQuantsEx, explicitInfo, moduleParams);
+
+                const bool onlyPressure = LocalResidual::fluxOnlyDependsOnPressure(explicitInfo);
+                if (onlyPressure != (explicitIn && explicitEx)) {
+                    std::cerr << "Unexpected faces are treated as pressure dependent only\n";
+                    return EXIT_FAILURE;
+                }
+
+                for (unsigned eqIdx = 0; eqIdx < numEq; ++eqIdx) {
+                    maxValue = std::max(maxValue, std::abs(implicitFlux[eqIdx].value()));
+                    maxValueDiff = std::max(maxValueDiff,
+                                            std::abs(explicitFlux[eqIdx].value()
+                                                     - implicitFlux[eqIdx].value()));
+                    if (!onlyPressure)
+                        continue;
+                    for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx) {
+                        if (pvIdx == Indices::pressureSwitchIdx)
+                            continue;
+                        maxNonPressureDerivative =
+                            std::max(maxNonPressureDerivative,
+                                     std::abs(explicitFlux[eqIdx].derivative(pvIdx)));
+                    }
+                }
+            }
+            ++numFaces;
+        }
+    }
+
+    const bool ok = numFaces > 0
+        && maxValueDiff <= 1e-12*maxValue
+        && maxNonPressureDerivative == 0.0;
+
+    std::cout << numFaces << " faces, maximum flux: " << maxValue
+              << ", maximum difference to the fully implicit flux: " << maxValueDiff
+              << ", maximum non-pressure derivative of explicit faces: "
+              << maxNonPressureDerivative << "\n"
+              << (ok ? "The adaptive implicit fluxes agree with the fully implicit ones\n"
+                     : "The adaptive implicit fluxes differ from the fully implicit ones!\n");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
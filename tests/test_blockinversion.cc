@@ -0,0 +1,158 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Checks the batched inversion of matrix blocks including the fallback for
+ *        blocks which need pivoting and compares its speed with the inversion of the
+ *        blocks one by one.
+ */
+#include "config.h"
+
+#include <opm/simulators/linalg/matrixblock.hh>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+template <class Block>
+double maxDeviation(const std::vector<Block>& a, const std::vector<Block>& b)
+{
+    double result = 0.0;
+    for (std::size_t blockIdx = 0; blockIdx < a.size(); ++blockIdx)
+        for (int i = 0; i < Block::rows; ++i)
+            for (int j = 0; j < Block::cols; ++j)
+                result = std::max(result, std::abs(a[blockIdx][i][j] - b[blockIdx][i][j]));
+    return result;
+}
+
+template <int n>
+bool testBlockSize()
+{
+    using Block = Opm::MatrixBlock<double, n, n>;
+    constexpr std::size_t numBlocks = 100000;
+
+    // random blocks with a dominant diagonal, like the ones of the Jacobian
+    std::mt19937 generator(n);
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+    std::vector<Block> blocks(numBlocks);
+    for (auto& block : blocks)
+        for (int i = 0; i < n; ++i)
+            for (int j = 0; j < n; ++j)
+                block[i][j] = distribution(generator) + ((i == j) ? n : 0.0);
+
+    using Clock = std::chrono::steady_clock;
+    auto singleInverses = blocks;
+    auto start = Clock::now();
+    for (auto& block : singleInverses)
+        block.invert();
+    const double singleTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+    auto batchedInverses = blocks;
+    start = Clock::now();
+    Opm::invertBlocks(batchedInverses);
+    const double batchedTime = std::chrono::duration<double>(Clock::now() - start).count();
+
+    const double maxInverseError = maxDeviation(batchedInverses, singleInverses);
+
+    std::cout << n << "x" << n << " blocks: "
+              << singleTime/numBlocks*1e9 << " ns per single inversion, "
+              << batchedTime/numBlocks*1e9 << " ns per batched inversion\n";
+
+    constexpr double tolerance = 1e-12;
+    if (maxInverseError > tolerance) {
+        std::cerr << n << "x" << n << " blocks: maximum deviation of the inverses: "
+                  << maxInverseError << "\n";
+        return false;
+    }
+    return true;
+}
+
+// blocks which are regular but cannot be inverted accurately without pivoting must be
+// passed to the pivoting inversion, also if they share a batch with harmless blocks
+template <int n>
+bool testFallback()
+{
+    using Block = Opm::MatrixBlock<double, n, n>;
+
+    std::vector<Block> blocks;
+    for (int blockIdx = 0; blockIdx < 16; ++blockIdx) {
+        Block block(0.0);
+        for (int i = 0; i < n; ++i)
+            block[i][i] = 1.0;
+        blocks.push_back(block);
+    }
+
+    // a tiny but not negligible pivot: [[1e-10, 1], [1, 1]]
+    blocks[1][0][0] = 1e-10;
+    blocks[1][0][1] = 1.0;
+    blocks[1][1][0] = 1.0;
+
+    // a tiny pivot in the last but one column of an otherwise benign block
+    blocks[6][n - 2][n - 2] = 1e-9;
+    blocks[6][n - 2][n - 1] = 2.0;
+    blocks[6][n - 1][n - 2] = 3.0;
+
+    // a pivot which is small compared to the entries below it, but not tiny
+    blocks[9][0][0] = 1e-3;
+    blocks[9][0][1] = 1.0;
+    for (int i = 1; i < n; ++i)
+        blocks[9][i][0] = 1.0;
+
+    // a zero pivot
+    blocks[14][0][0] = 0.0;
+    blocks[14][0][n - 1] = 1.0;
+    blocks[14][n - 1][0] = 1.0;
+    blocks[14][n - 1][n - 1] = 0.0;
+
+    auto singleInverses = blocks;
+    for (auto& block : singleInverses)
+        block.invert();
+
+    auto batchedInverses = blocks;
+    Opm::invertBlocks(batchedInverses);
+
+    const double maxInverseError = maxDeviation(batchedInverses, singleInverses);
+    constexpr double tolerance = 1e-12;
+    if (maxInverseError > tolerance) {
+        std::cerr << n << "x" << n << " blocks which need pivoting: maximum deviation of "
+                  << "the inverses: " << maxInverseError << "\n";
+        return false;
+    }
+    return true;
+}
+
+int main()
+{
+    bool ok = testBlockSize<5>();
+    ok = testBlockSize<6>() && ok;
+    ok = testBlockSize<7>() && ok;
+    ok = testBlockSize<8>() && ok;
+    ok = testFallback<5>() && ok;
+    ok = testFallback<8>() && ok;
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
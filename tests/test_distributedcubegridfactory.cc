@@ -0,0 +1,116 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Checks that the recursive coordinate bisection of the distributed cube grid
+ *        factory assigns each cell to exactly one process.
+ */
+#include "config.h"
+
+#include <opm/models/io/distributedcubegridfactory.hh>
+
+#include <dune/grid/yaspgrid.hh>
+
+#include <array>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// check that the boxes of all processes cover the index box of the grid without
+// overlapping each other
+template <class Grid>
+bool checkSplit(const std::array<unsigned, Grid::dimension>& cellRes, int numRanks)
+{
+    constexpr int dim = Grid::dimension;
+    using Factory = Opm::DistributedCubeGridFactory<Grid>;
+
+    std::size_t numCells = 1;
+    for (int d = 0; d < dim; ++d)
+        numCells *= cellRes[d];
+
+    std::vector<int> owner(numCells, -1);
+    std::size_t numOverlapping = 0;
+    for (int rank = 0; rank < numRanks; ++rank) {
+        const auto [lower, upper] = Factory::localBox(cellRes, rank, numRanks);
+
+        std::size_t numBoxCells = 1;
+        for (int d = 0; d < dim; ++d) {
+            if (lower[d] > upper[d] || upper[d] > cellRes[d]) {
+                std::cerr << "rank " << rank << " of " << numRanks
+                          << " has an invalid box in direction " << d << "\n";
+                return false;
+            }
+            numBoxCells *= upper[d] - lower[d];
+        }
+
+        for (std::size_t localIdx = 0; localIdx < numBoxCells; ++localIdx) {
+            std::size_t cellIdx = 0;
+            std::size_t stride = 1;
+            std::size_t remainder = localIdx;
+            for (int d = 0; d < dim; ++d) {
+                const unsigned cellsInDir = upper[d] - lower[d];
+                cellIdx += (lower[d] + remainder % cellsInDir)*stride;
+                remainder /= cellsInDir;
+                stride *= cellRes[d];
+            }
+
+            if (owner[cellIdx] >= 0)
+                ++numOverlapping;
+            owner[cellIdx] = rank;
+        }
+    }
+
+    std::size_t numUncovered = 0;
+    for (const int rank : owner)
+        numUncovered += rank < 0;
+
+    if (numOverlapping > 0 || numUncovered > 0) {
+        std::cerr << dim << "D grid with " << numCells << " cells on " << numRanks
+                  << " processes: " << numOverlapping << " cells are assigned more "
+                  << "than once, " << numUncovered << " cells are not assigned\n";
+        return false;
+    }
+    return true;
+}
+
+int main()
+{
+    using Grid2 = Dune::YaspGrid<2>;
+    using Grid3 = Dune::YaspGrid<3>;
+
+    // the process counts include powers of two, odd and prime numbers as well as
+    // more processes than cells
+    bool ok = true;
+    for (int numRanks = 1; numRanks <= 40; ++numRanks) {
+        ok = checkSplit<Grid2>({7, 3}, numRanks) && ok;
+        ok = checkSplit<Grid2>({1, 16}, numRanks) && ok;
+        ok = checkSplit<Grid3>({5, 4, 3}, numRanks) && ok;
+        ok = checkSplit<Grid3>({2, 9, 1}, numRanks) && ok;
+    }
+
+    std::cout << (ok ? "All cells are assigned to exactly one process\n"
+                     : "The cells are not split correctly!\n");
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
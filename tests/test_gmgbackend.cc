@@ -0,0 +1,180 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Compares the time which the geometric multi-grid backend and the algebraic
+ *        multi-grid backend need to solve the linear systems of the lens problem.
+ */
+#include "config.h"
+
+#include <opm/models/utils/start.hh>
+#include <opm/models/utils/timer.hh>
+#include <opm/simulators/linalg/parallelamgbackend.hh>
+#include <opm/simulators/linalg/parallelgmgbackend.hh>
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#include "lens_immiscible_ecfv_ad.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace Opm::Properties {
+
+namespace TTag {
+
+struct LensGmgProblem
+{ using InheritsFrom = std::tuple<LensProblemEcfvAd>; };
+
+struct LensAmgProblem
+{ using InheritsFrom = std::tuple<LensProblemEcfvAd>; };
+
+} // end namespace TTag
+
+template<class TypeTag>
+struct LinearSolverSplice<TypeTag, TTag::LensGmgProblem>
+{ using type = TTag::ParallelGmgLinearSolver; };
+
+template<class TypeTag>
+struct LinearSolverSplice<TypeTag, TTag::LensAmgProblem>
+{ using type = TTag::ParallelAmgLinearSolver; };
+
+} // namespace Opm::Properties
+
+struct SolveResult
+{
+    std::vector<double> solution;
+    double solveTime;
+    std::size_t iterations;
+    bool converged;
+};
+
+// linearize the initial solution of the lens problem and solve the linear system
+// several times. since the matrix is set anew for each solve, the time includes the
+// setup of the preconditioner, which is the part where both multi-grid methods differ
+// most.
+template <class TypeTag>
+SolveResult solve(const char* name, int numSolves)
+{
+    using Simulator = Opm::GetPropType<TypeTag, Opm::Properties::Simulator>;
+    using GlobalEqVector = Opm::GetPropType<TypeTag, Opm::Properties::GlobalEqVector>;
+
+    // the grid is refined compared to the default, so that the hierarchies of both
+    // methods have a few levels
+    const std::vector<const char*> argv = { name,
+                                            "--cells-x=192",
+                                            "--cells-y=128",
+                                            "--linear-solver-tolerance=1e-5",
+                                            "--enable-vtk-output=false" };
+
+    Opm::Parameters::reset();
+    Opm::setupParameters_<TypeTag>(static_cast<int>(argv.size()),
+                                   argv.data(),
+                                   /*registerParams=*/true,
+                                   /*allowUnused=*/false,
+                                   /*handleHelp=*/false);
+    Opm::GetPropType<TypeTag, Opm::Properties::ThreadManager>::init();
+
+    Simulator simulator(/*verbose=*/false);
+    simulator.model().applyInitialSolution();
+    auto& linearizer = simulator.model().linearizer();
+    auto& linearSolver = simulator.model().newtonMethod().linearSolver();
+
+    linearizer.linearizeDomain();
+    linearSolver.prepare(linearizer.jacobian(), linearizer.residual());
+
+    GlobalEqVector x(linearizer.residual());
+    SolveResult result{{}, 0.0, 0, true};
+    Opm::Timer timer;
+    for (int i = 0; i < numSolves; ++i) {
+        timer.start();
+        linearSolver.setMatrix(linearizer.jacobian());
+        linearSolver.setResidual(linearizer.residual());
+        x = 0.0;
+        result.converged = linearSolver.solve(x) && result.converged;
+        timer.stop();
+        result.iterations += linearSolver.iterations();
+    }
+    result.solveTime = timer.realTimeElapsed();
+
+    for (const auto& block : x)
+        for (std::size_t j = 0; j < block.size(); ++j)
+            result.solution.push_back(block[j]);
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    const auto& mpiHelper = Dune::MPIHelper::instance(argc, argv);
+    const int numSolves = (argc > 1) ? std::atoi(argv[1]) : 5;
+
+    const auto amg = solve<Opm::Properties::TTag::LensAmgProblem>("test_gmgbackend", numSolves);
+    const auto gmg = solve<Opm::Properties::TTag::LensGmgProblem>("test_gmgbackend", numSolves);
+
+    // both backends solve the same linear system, but the solutions are compared with a
+    // tolerance because the linear solvers use single precision and only reduce the
+    // residual by the linear solver tolerance
+    double maxDiff = 0.0;
+    double maxValue = 0.0;
+    for (std::size_t i = 0; i < amg.solution.size(); ++i) {
+        maxDiff = std::max(maxDiff, std::abs(amg.solution[i] - gmg.solution[i]));
+        maxValue = std::max(maxValue, std::abs(amg.solution[i]));
+    }
+
+    const auto& comm = Dune::MPIHelper::getCommunication();
+    maxDiff = comm.max(maxDiff);
+    maxValue = comm.max(maxValue);
+    const double amgTime = comm.max(amg.solveTime);
+    const double gmgTime = comm.max(gmg.solveTime);
+
+    const bool converged = amg.converged && gmg.converged;
+    const bool identical = maxDiff <= 1e-3*maxValue;
+    // the geometric multi-grid does not need to aggregate the matrix, so it must not be
+    // considerably slower than the algebraic one. the bound is generous to cope with
+    // noisy timings on loaded machines.
+    const bool fastEnough = gmgTime <= 2.0*amgTime;
+
+    if (mpiHelper.rank() == 0) {
+        std::cout << numSolves << " solves of the linear system of the lens problem:\n"
+                  << "  algebraic multi-grid: " << amgTime << " s, "
+                  << amg.iterations << " iterations\n"
+                  << "  geometric multi-grid: " << gmgTime << " s, "
+                  << gmg.iterations << " iterations\n"
+                  << "  maximum difference of the solutions: " << maxDiff
+                  << " (maximum value: " << maxValue << ")\n";
+        if (!converged)
+            std::cout << "The linear solver did not converge!\n";
+        if (!identical)
+            std::cout << "Results differ!\n";
+        if (!fastEnough)
+            std::cout << "The geometric multi-grid is considerably slower than the "
+                      << "algebraic one!\n";
+    }
+
+    return (converged && identical && fastEnough) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
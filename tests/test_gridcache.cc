@@ -0,0 +1,149 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Checks that the DGF vanguard yields the same fractures if the grid is
+ *        read from the binary grid cache as if the DGF file is parsed.
+ */
+#include "config.h"
+
+#include <opm/models/utils/start.hh>
+#include <opm/simulators/linalg/parallelbicgstabbackend.hh>
+
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+
+#include "problems/fractureproblem.hh"
+
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+using TypeTag = Opm::Properties::TTag::FractureProblem;
+using Simulator = Opm::GetPropType<TypeTag, Opm::Properties::Simulator>;
+using Grid = Opm::GetPropType<TypeTag, Opm::Properties::Grid>;
+
+using Position = std::array<double, Grid::dimensionworld>;
+using FractureSet = std::set<std::pair<Position, Position>>;
+
+// the grid file is copied so that the binary grid file does not interfere with the
+// other tests which use the same DGF file
+const std::string gridFileName = "test_gridcache.dgf";
+
+// set up the simulator and return the fracture edges of the grid. The vertex
+// indices of a grid created from the binary file may differ from the ones of the
+// parsed grid, so the edges are identified by the positions of their vertices.
+FractureSet fractures(bool gridCache)
+{
+    const std::string gridFileArg = "--grid-file=" + gridFileName;
+    const std::string gridCacheArg =
+        std::string("--enable-grid-cache=") + (gridCache ? "true" : "false");
+    const std::vector<const char*> argv = { "test_gridcache",
+                                            gridFileArg.c_str(),
+                                            gridCacheArg.c_str(),
+                                            "--enable-vtk-output=false" };
+
+    Opm::Parameters::reset();
+    Opm::setupParameters_<TypeTag>(static_cast<int>(argv.size()),
+                                   argv.data(),
+                                   /*registerParams=*/true,
+                                   /*allowUnused=*/false,
+                                   /*handleHelp=*/false);
+    Opm::GetPropType<TypeTag, Opm::Properties::ThreadManager>::init();
+
+    Simulator simulator(/*verbose=*/false);
+    const auto& vanguard = simulator.vanguard();
+    const auto& fractureMapper = vanguard.fractureMapper();
+
+    using LevelGridView = typename Grid::LevelGridView;
+    const LevelGridView gridView = vanguard.grid().levelGridView(/*level=*/0);
+    Dune::MultipleCodimMultipleGeomTypeMapper<LevelGridView>
+        vertexMapper(gridView, Dune::mcmgVertexLayout());
+
+    FractureSet result;
+    for (const auto& element : elements(gridView)) {
+        const auto& geometry = element.geometry();
+        const unsigned numCorners = element.subEntities(Grid::dimension);
+        for (unsigned i = 0; i < numCorners; ++i) {
+            for (unsigned j = i + 1; j < numCorners; ++j) {
+                const auto vertexIdx1 = vertexMapper.subIndex(element, i, Grid::dimension);
+                const auto vertexIdx2 = vertexMapper.subIndex(element, j, Grid::dimension);
+                if (!fractureMapper.isFractureEdge(vertexIdx1, vertexIdx2))
+                    continue;
+
+                Position pos1;
+                Position pos2;
+                for (unsigned k = 0; k < Grid::dimensionworld; ++k) {
+                    pos1[k] = geometry.corner(i)[k];
+                    pos2[k] = geometry.corner(j)[k];
+                }
+                result.emplace(std::min(pos1, pos2), std::max(pos1, pos2));
+            }
+        }
+    }
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+
+    {
+        std::ifstream source("data/fracture.art.dgf", std::ios::binary);
+        std::ofstream target(gridFileName, std::ios::binary);
+        target << source.rdbuf();
+    }
+    std::remove((gridFileName + ".bin").c_str());
+
+    // the first run with the grid cache parses the DGF file and writes the binary
+    // file, the second one reads it
+    const FractureSet parsed = fractures(/*gridCache=*/false);
+    fractures(/*gridCache=*/true);
+    const FractureSet cached = fractures(/*gridCache=*/true);
+
+    std::cout << "parsed grid: " << parsed.size() << " fracture edges, "
+              << "cached grid: " << cached.size() << " fracture edges\n";
+
+    std::remove((gridFileName + ".bin").c_str());
+    std::remove(gridFileName.c_str());
+
+    if (parsed.empty()) {
+        std::cerr << "The grid does not contain any fractures\n";
+        return EXIT_FAILURE;
+    }
+    if (parsed != cached) {
+        std::cerr << "The fractures of the cached and the parsed grid differ!\n";
+        return EXIT_FAILURE;
+    }
+
+    std::cout << "The fractures of the cached and the parsed grid agree\n";
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,138 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Checks that Opm::GridHaloExchange produces the same results as the data
+ *        handles of gridcommhandles.hh and compares the time needed for both.
+ */
+#include "config.h"
+
+#include <opm/models/parallel/gridcommhandles.hh>
+#include <opm/models/parallel/gridhaloexchange.hh>
+#include <opm/models/utils/timer.hh>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/grid/common/mcmgmapper.hh>
+#include <dune/grid/yaspgrid.hh>
+
+#include <array>
+#include <bitset>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+using Grid = Dune::YaspGrid<2>;
+using GridView = Grid::LeafGridView;
+using ElementMapper = Dune::MultipleCodimMultipleGeomTypeMapper<GridView>;
+using Value = Dune::FieldVector<double, 3>;
+using Container = std::vector<Value>;
+
+// the value of an element only depends on its position, so it is the same on all
+// processes which know the element
+template <class Element>
+Value exactValue(const Element& element)
+{
+    const auto center = element.geometry().center();
+    return Value{center[0], center[1], center[0]*center[1]};
+}
+
+// the values of the interior elements are set, the ones of all others are zero
+Container initialValues(const GridView& gridView, const ElementMapper& mapper)
+{
+    Container values(mapper.size(), Value(0.0));
+    for (const auto& element : elements(gridView, Dune::Partitions::interior))
+        values[mapper.index(element)] = exactValue(element);
+    return values;
+}
+
+bool checkValues(const GridView& gridView, const ElementMapper& mapper, const Container& values)
+{
+    for (const auto& element : elements(gridView)) {
+        Value diff = values[mapper.index(element)];
+        diff -= exactValue(element);
+        if (diff.two_norm() > 1e-12)
+            return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    const auto& mpiHelper = Dune::MPIHelper::instance(argc, argv);
+    const int numCells = (argc > 1) ? std::atoi(argv[1]) : 200;
+    const int numExchanges = (argc > 2) ? std::atoi(argv[2]) : 100;
+
+    Grid grid(Dune::FieldVector<double, 2>(1.0),
+              std::array<int, 2>{{numCells, numCells}},
+              std::bitset<2>(),
+              /*overlap=*/1);
+    const GridView gridView = grid.leafGridView();
+    const ElementMapper mapper(gridView, Dune::mcmgElementLayout());
+
+    // exchange using the data handles of the grid
+    Container values = initialValues(gridView, mapper);
+    Opm::GridCommHandleGhostSync<Value, Container, ElementMapper, /*commCodim=*/0>
+        ghostSync(values, mapper);
+    Opm::Timer handleTimer;
+    handleTimer.start();
+    for (int i = 0; i < numExchanges; ++i)
+        gridView.communicate(ghostSync,
+                             Dune::InteriorBorder_All_Interface,
+                             Dune::ForwardCommunication);
+    handleTimer.stop();
+    bool ok = checkValues(gridView, mapper, values);
+
+    // exchange using the persistent communication pattern
+    values = initialValues(gridView, mapper);
+    Opm::GridHaloExchange<Value> haloExchange;
+    Opm::Timer setupTimer;
+    setupTimer.start();
+    haloExchange.init</*commCodim=*/0>(gridView, mapper, Dune::InteriorBorder_All_Interface);
+    setupTimer.stop();
+
+    Opm::Timer haloTimer;
+    haloTimer.start();
+    for (int i = 0; i < numExchanges; ++i)
+        haloExchange.copy(values);
+    haloTimer.stop();
+    ok = ok && checkValues(gridView, mapper, values);
+
+    // summing up into zero-initialized values must yield the same result
+    values = initialValues(gridView, mapper);
+    haloExchange.sum(values);
+    ok = ok && checkValues(gridView, mapper, values);
+
+    ok = gridView.comm().min(static_cast<int>(ok));
+    if (mpiHelper.rank() == 0) {
+        std::cout << "Halo exchange of " << numCells << "x" << numCells << " cells on "
+                  << mpiHelper.size() << " process(es), " << numExchanges << " exchanges:\n"
+                  << "  grid data handles:     " << handleTimer.realTimeElapsed() << " s\n"
+                  << "  persistent exchange:   " << haloTimer.realTimeElapsed() << " s"
+                  << " (setup: " << setupTimer.realTimeElapsed() << " s)\n"
+                  << (ok ? "Results are identical\n" : "Results differ!\n");
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,149 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Checks that the iterative refinement of the linear solver yields the solution
+ *        of the linear system in the precision of the model if the linear solver
+ *        uses a lower precision.
+ */
+#include "config.h"
+
+#if HAVE_QUAD
+#include <opm/material/common/quad.hpp>
+#endif
+
+#include <opm/models/utils/start.hh>
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#include "lens_immiscible_ecfv_ad.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace Opm::Properties {
+
+namespace TTag {
+struct LensRefinementProblem { using InheritsFrom = std::tuple<LensProblemEcfvAd>; };
+} // end namespace TTag
+
+// the model uses quadruple precision if it is available, while the linear solver
+// always uses double precision
+#if HAVE_QUAD
+template<class TypeTag>
+struct Scalar<TypeTag, TTag::LensRefinementProblem>
+{ using type = quad; };
+#endif
+
+template<class TypeTag>
+struct LinearSolverScalar<TypeTag, TTag::LensRefinementProblem>
+{ using type = double; };
+
+} // namespace Opm::Properties
+
+using TypeTag = Opm::Properties::TTag::LensRefinementProblem;
+using Scalar = Opm::GetPropType<TypeTag, Opm::Properties::Scalar>;
+using Simulator = Opm::GetPropType<TypeTag, Opm::Properties::Simulator>;
+using GlobalEqVector = Opm::GetPropType<TypeTag, Opm::Properties::GlobalEqVector>;
+
+// solve the linear system of the initial solution of the lens problem and return the
+// maximum norm of its residual relative to the one of the right hand side, both
+// computed in the precision of the model
+Scalar relativeResidual(int refinementSteps)
+{
+    const std::string refinementArg =
+        "--linear-solver-refinement-steps=" + std::to_string(refinementSteps);
+    // the absolute tolerance must not stop the solves for the corrections, whose right
+    // hand sides become tiny
+    const std::vector<const char*> argv = { "test_iterativerefinement",
+                                            refinementArg.c_str(),
+                                            "--linear-solver-tolerance=1e-10",
+                                            "--linear-solver-abs-tolerance=1e-300" };
+
+    Opm::Parameters::reset();
+    Opm::setupParameters_<TypeTag>(static_cast<int>(argv.size()),
+                                   argv.data(),
+                                   /*registerParams=*/true,
+                                   /*allowUnused=*/false,
+                                   /*handleHelp=*/false);
+    Opm::GetPropType<TypeTag, Opm::Properties::ThreadManager>::init();
+
+    Simulator simulator(/*verbose=*/false);
+    simulator.model().applyInitialSolution();
+    auto& linearizer = simulator.model().linearizer();
+    auto& linearSolver = simulator.model().newtonMethod().linearSolver();
+
+    linearizer.linearizeDomain();
+    linearSolver.prepare(linearizer.jacobian(), linearizer.residual());
+    linearSolver.setResidual(linearizer.residual());
+    linearSolver.setMatrix(linearizer.jacobian());
+
+    GlobalEqVector x(linearizer.residual().size());
+    x = 0.0;
+    if (!linearSolver.solve(x)) {
+        std::cerr << "The linear solver did not converge\n";
+        std::exit(EXIT_FAILURE);
+    }
+
+    // r = b - A*x
+    const auto& A = linearizer.jacobian().istlMatrix();
+    const auto& b = linearizer.residual();
+    GlobalEqVector r(b);
+    A.mmv(x, r);
+
+    Scalar maxResidual = 0.0;
+    Scalar maxRhs = 0.0;
+    for (std::size_t i = 0; i < r.size(); ++i) {
+        for (std::size_t j = 0; j < r[i].size(); ++j) {
+            maxResidual = std::max(maxResidual, Scalar(std::abs(r[i][j])));
+            maxRhs = std::max(maxRhs, Scalar(std::abs(b[i][j])));
+        }
+    }
+
+    return maxResidual/maxRhs;
+}
+
+int main(int argc, char** argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+
+    const Scalar unrefined = relativeResidual(/*refinementSteps=*/0);
+    const Scalar refined = relativeResidual(/*refinementSteps=*/5);
+
+    // without refinement, the accuracy is limited by the tolerance of the linear solver
+    // and by the precision of its copy of the linear system. with refinement, the
+    // residual must get well below the machine epsilon of the linear solver's scalar.
+    const bool ok = refined < 1e-18 && refined < 1e-6*unrefined;
+
+    std::cout << "relative residual without refinement: " << static_cast<double>(unrefined) << "\n"
+              << "relative residual with refinement:    " << static_cast<double>(refined) << "\n"
+              << (ok ? "Refinement reached the precision of the model\n"
+                     : "Refinement did not reach the precision of the model!\n");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
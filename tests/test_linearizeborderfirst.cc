@@ -0,0 +1,164 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Checks that linearizing the process border elements first yields the same
+ *        linear system as the synchronous linearization and compares the time needed
+ *        for both.
+ */
+#include "config.h"
+
+#include <opm/models/utils/start.hh>
+#include <opm/models/utils/timer.hh>
+#include <opm/models/parallel/mpiutil.hh>
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#include "lens_immiscible_ecfv_ad.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using TypeTag = Opm::Properties::TTag::LensProblemEcfvAd;
+using Simulator = Opm::GetPropType<TypeTag, Opm::Properties::Simulator>;
+using GlobalEqVector = Opm::GetPropType<TypeTag, Opm::Properties::GlobalEqVector>;
+
+struct LinearizationResult
+{
+    GlobalEqVector solution;
+    double linearizationTime;
+    bool linearizedBorderFirst;
+    bool converged;
+};
+
+// linearize the initial solution of the lens problem several times, pass the result
+// to the linear solver and solve it once
+LinearizationResult linearize(bool borderFirst, int numThreads, int numLinearizations)
+{
+    const std::string threadsArg = "--threads-per-process=" + std::to_string(numThreads);
+    const std::string borderFirstArg =
+        std::string("--linearize-border-first=") + (borderFirst ? "true" : "false");
+    const std::vector<const char*> argv = { "test_linearizeborderfirst",
+                                            threadsArg.c_str(),
+                                            borderFirstArg.c_str() };
+
+    Opm::Parameters::reset();
+    Opm::setupParameters_<TypeTag>(static_cast<int>(argv.size()),
+                                   argv.data(),
+                                   /*registerParams=*/true,
+                                   /*allowUnused=*/false,
+                                   /*handleHelp=*/false);
+    Opm::GetPropType<TypeTag, Opm::Properties::ThreadManager>::init();
+
+    Simulator simulator(/*verbose=*/false);
+    simulator.model().applyInitialSolution();
+    auto& linearizer = simulator.model().linearizer();
+    auto& linearSolver = simulator.model().newtonMethod().linearSolver();
+
+    // the communication pattern of the matrix is only known after the linear system
+    // has been prepared once
+    linearizer.linearizeDomain();
+    linearSolver.prepare(linearizer.jacobian(), linearizer.residual());
+
+    Opm::Timer timer;
+    bool linearizedBorderFirst = true;
+    for (int i = 0; i < numLinearizations; ++i) {
+        timer.start();
+        linearizer.linearizeDomain();
+        linearSolver.setMatrix(linearizer.jacobian());
+        timer.stop();
+        linearizedBorderFirst = linearizedBorderFirst && linearizer.linearizedBorderFirst();
+    }
+
+    linearSolver.setResidual(linearizer.residual());
+    LinearizationResult result{linearizer.residual(),
+                               timer.realTimeElapsed(),
+                               linearizedBorderFirst,
+                               /*converged=*/false};
+    result.solution = 0.0;
+    result.converged = linearSolver.solve(result.solution);
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    const bool funneledThreads = Opm::initMpiFunneledThreads(argc, argv);
+    const auto& mpiHelper = Dune::MPIHelper::instance(argc, argv);
+    const int numThreads = (argc > 1) ? std::atoi(argv[1]) : 2;
+    const int numLinearizations = (argc > 2) ? std::atoi(argv[2]) : 20;
+
+    const auto reference = linearize(/*borderFirst=*/false, numThreads, numLinearizations);
+    const auto borderFirst = linearize(/*borderFirst=*/true, numThreads, numLinearizations);
+
+    // without MPI_THREAD_FUNNELED, the border elements cannot be linearized first if
+    // multiple threads are used. There is nothing to compare in this case.
+    const auto& comm = Dune::MPIHelper::getCommunication();
+    const bool usedBorderFirst = comm.min(static_cast<int>(borderFirst.linearizedBorderFirst));
+    const bool usedSynchronous = comm.min(static_cast<int>(!reference.linearizedBorderFirst));
+    if (!usedBorderFirst && numThreads > 1 && !funneledThreads) {
+        if (mpiHelper.rank() == 0)
+            std::cout << "Skipping the test: the MPI library does not provide "
+                      << "MPI_THREAD_FUNNELED\n";
+        return EXIT_SUCCESS;
+    }
+
+    // the elements are linearized in a different order, but each one only writes
+    // its own matrix rows, so the systems must agree. the solutions are compared
+    // with a tolerance because the linear solver uses single precision.
+    double maxDiff = 0.0;
+    double maxValue = 0.0;
+    for (std::size_t i = 0; i < reference.solution.size(); ++i) {
+        for (std::size_t j = 0; j < reference.solution[i].size(); ++j) {
+            maxDiff = std::max(maxDiff, std::abs(reference.solution[i][j] - borderFirst.solution[i][j]));
+            maxValue = std::max(maxValue, std::abs(reference.solution[i][j]));
+        }
+    }
+
+    maxDiff = comm.max(maxDiff);
+    maxValue = comm.max(maxValue);
+    const bool identical = maxDiff <= 1e-5*maxValue;
+    const bool converged = reference.converged && borderFirst.converged;
+    const bool ok = usedBorderFirst && usedSynchronous && converged && identical;
+
+    if (mpiHelper.rank() == 0) {
+        std::cout << numLinearizations << " linearizations of the lens problem on "
+                  << mpiHelper.size() << " process(es) with " << numThreads
+                  << " thread(s) each:\n"
+                  << "  synchronous:   " << reference.linearizationTime << " s\n"
+                  << "  border first:  " << borderFirst.linearizationTime << " s\n"
+                  << "  maximum difference of the solutions: " << maxDiff
+                  << " (maximum value: " << maxValue << ")\n";
+        if (!usedBorderFirst || !usedSynchronous)
+            std::cout << "The linearizer did not use the requested linearization order!\n";
+        if (!converged)
+            std::cout << "The linear solver did not converge!\n";
+        std::cout << (identical ? "Results are identical\n" : "Results differ!\n");
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,154 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Compares the tabulated shear factor of the polymer module with the
+ *        Newton-Raphson solve it replaces.
+ */
+#include "config.h"
+
+#include <opm/models/blackoil/blackoilmodel.hh>
+#include <opm/models/discretization/ecfv/ecfvdiscretization.hh>
+
+#include <opm/material/densead/Evaluation.hpp>
+
+#include "problems/reservoirproblem.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+namespace Opm::Properties {
+
+namespace TTag {
+
+struct PolymerShearFactorTest
+{ using InheritsFrom = std::tuple<ReservoirBaseProblem, BlackOilModel>; };
+
+} // end namespace TTag
+
+template<class TypeTag>
+struct SpatialDiscretizationSplice<TypeTag, TTag::PolymerShearFactorTest>
+{ using type = TTag::EcfvDiscretization; };
+
+template<class TypeTag>
+struct EnablePolymer<TypeTag, TTag::PolymerShearFactorTest>
+{ static constexpr bool value = true; };
+
+} // namespace Opm::Properties
+
+int main()
+{
+    using TypeTag = Opm::Properties::TTag::PolymerShearFactorTest;
+    using PolymerModule = Opm::BlackOilPolymerModule<TypeTag>;
+    using Params = Opm::BlackOilPolymerParams<double>;
+    using Evaluation = Opm::DenseAd::Evaluation<double, 1>;
+
+    // PLYVISC and PLYSHLOG tables of a single PVT region. The shear multipliers
+    // are already converted to the reference conditions.
+    const std::vector<double> concentration = {0.0, 0.5, 1.0, 2.0, 3.0};
+    const std::vector<double> viscosityMultiplier = {1.0, 2.0, 4.0, 8.0, 15.0};
+    std::vector<double> logVelocity = {1e-7, 1e-6, 1e-5, 1e-4, 1e-3};
+    for (auto& v : logVelocity)
+        v = std::log(v);
+    const std::vector<double> shearMultiplier = {1.0, 0.9, 0.6, 0.3, 0.2};
+
+    Params params;
+    params.plyviscViscosityMultiplierTable_.emplace_back(concentration.size(),
+                                                         concentration,
+                                                         viscosityMultiplier,
+                                                         /*sortInputs=*/false);
+    params.plyshlogShearEffectRefLogVelocity_.push_back(logVelocity);
+    params.plyshlogShearEffectRefMultiplier_.push_back(shearMultiplier);
+
+    constexpr unsigned numRefinements = 10;
+    params.buildShearFactorSurface(/*pvtRegionIdx=*/0, numRefinements);
+    if (params.plyshlogShearFactorSurface_[0].empty()) {
+        std::cerr << "The shear factor surface of a monotonic table is empty\n";
+        return EXIT_FAILURE;
+    }
+    const std::vector<double> surfaceConcentration = params.plyshlogShearFactorSurface_[0].concentration;
+
+    // without a surface, computeShearFactor() falls back to the Newton-Raphson
+    // solve, which serves as the reference
+    auto referenceParams = params;
+    referenceParams.plyshlogShearFactorSurface_[0] = Params::ShearFactorSurface{};
+
+    auto evalShearFactors = [](const std::vector<double>& conc, const std::vector<double>& velocity)
+    {
+        std::vector<Evaluation> result;
+        for (double c : conc) {
+            for (double v : velocity) {
+                const Evaluation v0 = Evaluation::createVariable(v, 0);
+                result.push_back(PolymerModule::computeShearFactor(Evaluation(c), 0, v0));
+            }
+        }
+        return result;
+    };
+
+    std::vector<double> velocity;
+    for (int i = 0; i <= 100; ++i)
+        velocity.push_back(std::pow(10.0, -7.5 + 5.5*i/100.0));
+    std::vector<double> betweenNodes;
+    for (int i = 0; i < 97; ++i)
+        betweenNodes.push_back(0.01 + 2.98*i/96.0);
+
+    PolymerModule::setParams(std::move(referenceParams));
+    const auto referenceAtNodes = evalShearFactors(surfaceConcentration, velocity);
+    const auto referenceBetweenNodes = evalShearFactors(betweenNodes, velocity);
+
+    PolymerModule::setParams(std::move(params));
+    const auto tabulatedAtNodes = evalShearFactors(surfaceConcentration, velocity);
+    const auto tabulatedBetweenNodes = evalShearFactors(betweenNodes, velocity);
+
+    // at the concentration nodes, the surface reproduces the Newton root including
+    // its derivative with regard to the velocity
+    double maxNodeError = 0.0;
+    for (std::size_t i = 0; i < referenceAtNodes.size(); ++i) {
+        maxNodeError = std::max(maxNodeError, std::abs(tabulatedAtNodes[i].value()
+                                                       - referenceAtNodes[i].value()));
+        maxNodeError = std::max(maxNodeError, std::abs(tabulatedAtNodes[i].derivative(0)
+                                                       - referenceAtNodes[i].derivative(0))
+                                              *velocity[i % velocity.size()]);
+    }
+
+    // between the nodes, only the interpolation in the concentration contributes
+    double maxRelativeError = 0.0;
+    for (std::size_t i = 0; i < referenceBetweenNodes.size(); ++i)
+        maxRelativeError = std::max(maxRelativeError,
+                                    std::abs(tabulatedBetweenNodes[i].value()
+                                             - referenceBetweenNodes[i].value())
+                                    / referenceBetweenNodes[i].value());
+
+    std::cout << "maximum deviation at the concentration nodes: " << maxNodeError
+              << ", maximum relative deviation between the nodes: " << maxRelativeError << "\n";
+
+    if (maxNodeError > 1e-10 || maxRelativeError > 5e-3) {
+        std::cerr << "The tabulated shear factor deviates from the Newton-Raphson solution\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,198 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Checks that the RecycledGMResSolver needs fewer operator applications for a
+ *        sequence of similar linear systems than the restarted GMRES solver without
+ *        recycling.
+ */
+#include "config.h"
+
+#include <opm/simulators/linalg/recycledgmressolver.hh>
+
+#include <dune/common/fvector.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/preconditioner.hh>
+#include <dune/istl/scalarproducts.hh>
+#include <dune/istl/solver.hh>
+#include <dune/istl/solvercategory.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using Vector = Dune::BlockVector<Dune::FieldVector<double, 1>>;
+
+// a nonsymmetric tridiagonal operator with a few isolated eigenvalues close to zero.
+// restarted GMRES converges slowly for these, because every cycle has to find the
+// corresponding modes again.
+class TestOperator : public Dune::LinearOperator<Vector, Vector>
+{
+public:
+    TestOperator(std::size_t size, double smallDiagonal)
+        : size_(size)
+        , smallDiagonal_(smallDiagonal)
+    {}
+
+    void apply(const Vector& x, Vector& y) const override
+    {
+        for (std::size_t i = 0; i < size_; ++i) {
+            double value = diagonal_(i)*x[i];
+            if (i > 0)
+                value -= 0.6*x[i - 1];
+            if (i + 1 < size_)
+                value -= 0.3*x[i + 1];
+            y[i] = value;
+        }
+    }
+
+    void applyscaleadd(double alpha, const Vector& x, Vector& y) const override
+    {
+        Vector tmp(y.size());
+        apply(x, tmp);
+        y.axpy(alpha, tmp);
+    }
+
+    Dune::SolverCategory::Category category() const override
+    { return Dune::SolverCategory::sequential; }
+
+private:
+    double diagonal_(std::size_t i) const
+    { return (i % 80 == 3) ? smallDiagonal_*(1 + i) : 3.0 + std::sin(i); }
+
+    std::size_t size_;
+    double smallDiagonal_;
+};
+
+// scales the vector by the inverse of the mean diagonal entry
+class ScalingPreconditioner : public Dune::Preconditioner<Vector, Vector>
+{
+public:
+    void pre(Vector&, Vector&) override
+    {}
+
+    void apply(Vector& x, const Vector& b) override
+    {
+        x = b;
+        x *= 1.0/3.0;
+    }
+
+    void post(Vector&) override
+    {}
+
+    Dune::SolverCategory::Category category() const override
+    { return Dune::SolverCategory::sequential; }
+};
+
+// solves a sequence of slightly changing linear systems and returns the number of
+// operator applications of each solve
+std::vector<int> solveSequence(std::size_t recycleSize, bool& ok)
+{
+    constexpr std::size_t size = 400;
+    constexpr int numSolves = 5;
+    constexpr double reduction = 1e-8;
+
+    Opm::Linear::GMResRecycleSpace<Vector> recycleSpace;
+    Dune::SeqScalarProduct<Vector> scalarProduct;
+    ScalingPreconditioner preconditioner;
+
+    std::mt19937 generator(1);
+    std::uniform_real_distribution<double> distribution(-1.0, 1.0);
+
+    std::vector<int> operatorApplications;
+    for (int solveIdx = 0; solveIdx < numSolves; ++solveIdx) {
+        // the matrix changes a bit between the solves, like the Jacobian does between
+        // the iterations of the Newton-Raphson method
+        TestOperator op(size, 1e-3*(1 + 0.05*solveIdx));
+        Vector b(size);
+        for (auto& block : b)
+            block = distribution(generator);
+        const Vector bOrig(b);
+        Vector x(size);
+        x = 0.0;
+
+        Opm::Linear::RecycledGMResSolver<Vector> solver(op,
+                                                        scalarProduct,
+                                                        preconditioner,
+                                                        reduction,
+                                                        /*restart=*/20,
+                                                        /*maxIterations=*/5000,
+                                                        /*verbosity=*/0,
+                                                        recycleSize,
+                                                        recycleSpace);
+        Dune::InverseOperatorResult result;
+        solver.apply(x, b, result);
+
+        // check the true residual of the solution
+        Vector r(size);
+        op.apply(x, r);
+        r -= bOrig;
+        const double relResidual = scalarProduct.norm(r)/scalarProduct.norm(bOrig);
+        if (!result.converged || relResidual > 10*reduction) {
+            std::cout << "solve " << solveIdx << " with " << recycleSize
+                      << " recycled vectors failed: converged=" << result.converged
+                      << ", relative residual=" << relResidual << "\n";
+            ok = false;
+        }
+
+        operatorApplications.push_back(solver.operatorApplications());
+    }
+
+    return operatorApplications;
+}
+
+int main()
+{
+    bool ok = true;
+    const auto plainApplications = solveSequence(/*recycleSize=*/0, ok);
+    const auto recycledApplications = solveSequence(/*recycleSize=*/5, ok);
+
+    std::cout << "operator applications without recycling:";
+    for (int n : plainApplications)
+        std::cout << " " << n;
+    std::cout << "\noperator applications with 5 recycled vectors:";
+    for (int n : recycledApplications)
+        std::cout << " " << n;
+    std::cout << "\n";
+
+    // the slowly converging modes are already deflated after the first restart of the
+    // first solve, so every solve with recycling must need at most two thirds of the
+    // operator applications of any of the solves without. (The recycled vectors need
+    // to be multiplied by the operator at the beginning of each cycle, which is why the
+    // bound is weaker than the one for the number of iterations alone.)
+    const int minPlain = *std::min_element(plainApplications.begin(),
+                                           plainApplications.end());
+    const int maxRecycled = *std::max_element(recycledApplications.begin(),
+                                              recycledApplications.end());
+    if (3*maxRecycled > 2*minPlain) {
+        std::cout << "Recycling did not reduce the number of operator applications sufficiently!\n";
+        ok = false;
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
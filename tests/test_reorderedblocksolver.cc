@@ -0,0 +1,203 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Checks the strongly connected components, the levels and the solution of
+ *        the reordered block solver for an acyclic and a cyclic dependency graph.
+ */
+#include "config.h"
+
+#include <opm/simulators/linalg/matrixblock.hh>
+#include <opm/simulators/linalg/reorderedblocksolver.hh>
+
+#include <dune/common/fvector.hh>
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+using Block = Opm::MatrixBlock<double, 2, 2>;
+using Matrix = Dune::BCRSMatrix<Block>;
+using Vector = Dune::BlockVector<Dune::FieldVector<double, 2>>;
+using Solver = Opm::Linear::ReorderedBlockSolver<Matrix, Vector>;
+
+// assemble a matrix in which row i depends on the rows deps[i]. the diagonal blocks
+// dominate so that the Gauss-Seidel iterations of cyclic components converge.
+Matrix makeMatrix(const std::vector<std::vector<std::size_t>>& deps)
+{
+    const std::size_t numRows = deps.size();
+    Matrix matrix(numRows, numRows, Matrix::random);
+    for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx)
+        matrix.setrowsize(rowIdx, deps[rowIdx].size() + 1);
+    matrix.endrowsizes();
+    for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+        matrix.addindex(rowIdx, rowIdx);
+        for (const auto colIdx : deps[rowIdx])
+            matrix.addindex(rowIdx, colIdx);
+    }
+    matrix.endindices();
+
+    for (std::size_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+        Block& diag = matrix[rowIdx][rowIdx];
+        diag[0][0] = 4.0 + rowIdx;
+        diag[0][1] = 1.0;
+        diag[1][0] = 0.5;
+        diag[1][1] = 3.0;
+        for (const auto colIdx : deps[rowIdx]) {
+            Block& offDiag = matrix[rowIdx][colIdx];
+            offDiag[0][0] = -1.0;
+            offDiag[0][1] = 0.2;
+            offDiag[1][0] = 0.1;
+            offDiag[1][1] = -0.8;
+        }
+    }
+
+    return matrix;
+}
+
+// solve the system by Gaussian elimination with partial pivoting of the dense matrix
+Vector solveDirect(const Matrix& matrix, const Vector& b)
+{
+    const std::size_t n = 2*matrix.N();
+    std::vector<std::vector<double>> a(n, std::vector<double>(n + 1, 0.0));
+    for (auto row = matrix.begin(); row != matrix.end(); ++row) {
+        for (auto col = row->begin(); col != row->end(); ++col)
+            for (int i = 0; i < 2; ++i)
+                for (int j = 0; j < 2; ++j)
+                    a[2*row.index() + i][2*col.index() + j] = (*col)[i][j];
+        for (int i = 0; i < 2; ++i)
+            a[2*row.index() + i][n] = b[row.index()][i];
+    }
+
+    for (std::size_t k = 0; k < n; ++k) {
+        std::size_t pivot = k;
+        for (std::size_t i = k + 1; i < n; ++i)
+            if (std::abs(a[i][k]) > std::abs(a[pivot][k]))
+                pivot = i;
+        std::swap(a[k], a[pivot]);
+        for (std::size_t i = k + 1; i < n; ++i) {
+            const double factor = a[i][k]/a[k][k];
+            for (std::size_t j = k; j <= n; ++j)
+                a[i][j] -= factor*a[k][j];
+        }
+    }
+
+    std::vector<double> x(n);
+    for (std::size_t k = n; k-- > 0;) {
+        double value = a[k][n];
+        for (std::size_t j = k + 1; j < n; ++j)
+            value -= a[k][j]*x[j];
+        x[k] = value/a[k][k];
+    }
+
+    Vector result(matrix.N());
+    for (std::size_t rowIdx = 0; rowIdx < matrix.N(); ++rowIdx)
+        for (int i = 0; i < 2; ++i)
+            result[rowIdx][i] = x[2*rowIdx + i];
+    return result;
+}
+
+bool check(const std::string& name,
+           const std::vector<std::vector<std::size_t>>& deps,
+           std::size_t expectedComponents,
+           std::size_t expectedMaxComponentSize,
+           std::size_t expectedLevels)
+{
+    const Matrix matrix = makeMatrix(deps);
+    Vector b(matrix.N());
+    for (std::size_t rowIdx = 0; rowIdx < matrix.N(); ++rowIdx) {
+        b[rowIdx][0] = 1.0 + rowIdx;
+        b[rowIdx][1] = 2.0 - 0.5*rowIdx;
+    }
+
+    Solver solver(/*tolerance=*/1e-13, /*maxIterations=*/1000);
+    solver.setMatrix(matrix);
+    Vector x(matrix.N());
+    const bool converged = solver.solve(x, b);
+
+    const Vector reference = solveDirect(matrix, b);
+    double maxError = 0.0;
+    double maxValue = 0.0;
+    for (std::size_t rowIdx = 0; rowIdx < matrix.N(); ++rowIdx) {
+        for (int i = 0; i < 2; ++i) {
+            maxError = std::max(maxError, std::abs(x[rowIdx][i] - reference[rowIdx][i]));
+            maxValue = std::max(maxValue, std::abs(reference[rowIdx][i]));
+        }
+    }
+
+    std::cout << name << " graph: " << solver.numComponents() << " components, "
+              << solver.numLevels() << " levels, largest component: "
+              << solver.maxComponentSize() << " rows, maximum error: " << maxError << "\n";
+
+    bool ok = true;
+    if (!converged) {
+        std::cerr << name << " graph: the solver did not converge\n";
+        ok = false;
+    }
+    if (solver.numComponents() != expectedComponents ||
+        solver.maxComponentSize() != expectedMaxComponentSize ||
+        solver.numLevels() != expectedLevels)
+    {
+        std::cerr << name << " graph: expected " << expectedComponents << " components, "
+                  << expectedLevels << " levels and a largest component of "
+                  << expectedMaxComponentSize << " rows\n";
+        ok = false;
+    }
+    if (maxError > 1e-10*maxValue) {
+        std::cerr << name << " graph: the solution differs from the direct solve\n";
+        ok = false;
+    }
+    return ok;
+}
+
+int main()
+{
+    // two chains 2 -> 1 -> 0 and 5 -> 4 -> 3, where row 3 also depends on row 0. the
+    // rows are not numbered in the order in which they must be solved.
+    const std::vector<std::vector<std::size_t>> acyclic = {
+        {1}, {2}, {}, {4, 0}, {5}, {}
+    };
+
+    // 0 -> 1 -> {2, 3, 4} -> 5, where 2 -> 3 -> 4 -> 2 is a cycle
+    const std::vector<std::vector<std::size_t>> cyclic = {
+        {}, {0}, {1, 4}, {2}, {3}, {4}
+    };
+
+    bool ok = check("acyclic", acyclic,
+                    /*expectedComponents=*/6,
+                    /*expectedMaxComponentSize=*/1,
+                    /*expectedLevels=*/4);
+    ok = check("cyclic", cyclic,
+               /*expectedComponents=*/4,
+               /*expectedMaxComponentSize=*/3,
+               /*expectedLevels=*/4) && ok;
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
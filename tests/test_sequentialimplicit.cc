@@ -0,0 +1,144 @@
+// -*- mode: C++; tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 4 -*-
+// vi: set et ts=4 sw=4 sts=4:
+/*
+  This file is part of the Open Porous Media project (OPM).
+
+  OPM is free software: you can redistribute it and/or modify
+  it under the terms of the GNU General Public License as published by
+  the Free Software Foundation, either version 2 of the License, or
+  (at your option) any later version.
+
+  OPM is distributed in the hope that it will be useful,
+  but WITHOUT ANY WARRANTY; without even the implied warranty of
+  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+  GNU General Public License for more details.
+
+  You should have received a copy of the GNU General Public License
+  along with OPM.  If not, see <http://www.gnu.org/licenses/>.
+
+  Consult the COPYING file in the top-level source directory of this
+  module for the precise wording of the license and the list of
+  copyright holders.
+*/
+/*!
+ * \file
+ *
+ * \brief Checks that the sequential implicit solution strategy of the black-oil model
+ *        converges to the solution of the fully implicit one.
+ */
+#include "config.h"
+
+#include <opm/models/io/dgfvanguard.hh>
+#include <opm/models/utils/start.hh>
+#include <opm/models/blackoil/blackoilmodel.hh>
+#include <opm/models/discretization/ecfv/ecfvdiscretization.hh>
+#include <opm/simulators/linalg/parallelbicgstabbackend.hh>
+
+#include <dune/common/parallel/mpihelper.hh>
+
+#include "problems/reservoirproblem.hh"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace Opm::Properties {
+
+namespace TTag {
+
+struct ReservoirSequentialProblem
+{ using InheritsFrom = std::tuple<ReservoirBaseProblem, BlackOilModel>; };
+
+} // end namespace TTag
+
+template<class TypeTag>
+struct SpatialDiscretizationSplice<TypeTag, TTag::ReservoirSequentialProblem>
+{ using type = TTag::EcfvDiscretization; };
+
+template<class TypeTag>
+struct LocalLinearizerSplice<TypeTag, TTag::ReservoirSequentialProblem>
+{ using type = TTag::AutoDiffLocalLinearizer; };
+
+} // namespace Opm::Properties
+
+using TypeTag = Opm::Properties::TTag::ReservoirSequentialProblem;
+using Simulator = Opm::GetPropType<TypeTag, Opm::Properties::Simulator>;
+using SolutionVector = Opm::GetPropType<TypeTag, Opm::Properties::SolutionVector>;
+
+// simulate the first days of the reservoir problem and return the solution
+SolutionVector simulate(bool sequential)
+{
+    const std::string sequentialArg =
+        std::string("--sequential-implicit=") + (sequential ? "true" : "false");
+    // the time steps are fixed so that both strategies solve the same nonlinear
+    // systems
+    const std::vector<const char*> argv = { "test_sequentialimplicit",
+                                            sequentialArg.c_str(),
+                                            "--end-time=8750000",
+                                            "--initial-time-step-size=875000",
+                                            "--max-time-step-size=875000",
+                                            "--newton-tolerance=1e-10",
+                                            "--enable-vtk-output=false" };
+
+    Opm::Parameters::reset();
+    Opm::setupParameters_<TypeTag>(static_cast<int>(argv.size()),
+                                   argv.data(),
+                                   /*registerParams=*/true,
+                                   /*allowUnused=*/false,
+                                   /*handleHelp=*/false);
+    Opm::GetPropType<TypeTag, Opm::Properties::ThreadManager>::init();
+
+    Simulator simulator(/*verbose=*/false);
+    simulator.run();
+    return simulator.model().solution(/*timeIdx=*/0);
+}
+
+int main(int argc, char** argv)
+{
+    Dune::MPIHelper::instance(argc, argv);
+
+    const auto fullyImplicit = simulate(/*sequential=*/false);
+    const auto sequential = simulate(/*sequential=*/true);
+
+    // both strategies only differ in how the linear systems of the Newton method are
+    // solved, so they must converge to the same solution. the primary variables are
+    // compared relative to the largest value of each variable.
+    constexpr unsigned numEq = Opm::getPropValue<TypeTag, Opm::Properties::NumEq>();
+    std::vector<double> maxDiff(numEq, 0.0);
+    std::vector<double> maxValue(numEq, 0.0);
+    std::size_t numMeaningMismatches = 0;
+    for (std::size_t dofIdx = 0; dofIdx < fullyImplicit.size(); ++dofIdx) {
+        const auto& a = fullyImplicit[dofIdx];
+        const auto& b = sequential[dofIdx];
+        if (a.primaryVarsMeaningWater() != b.primaryVarsMeaningWater() ||
+            a.primaryVarsMeaningGas() != b.primaryVarsMeaningGas() ||
+            a.primaryVarsMeaningPressure() != b.primaryVarsMeaningPressure())
+        {
+            ++numMeaningMismatches;
+            continue;
+        }
+
+        for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx) {
+            maxDiff[pvIdx] = std::max(maxDiff[pvIdx], std::abs(double(a[pvIdx] - b[pvIdx])));
+            maxValue[pvIdx] = std::max(maxValue[pvIdx], std::abs(double(a[pvIdx])));
+        }
+    }
+
+    bool ok = numMeaningMismatches == 0;
+    for (unsigned pvIdx = 0; pvIdx < numEq; ++pvIdx) {
+        const double relDiff = maxDiff[pvIdx]/std::max(maxValue[pvIdx], 1e-10);
+        std::cout << "primary variable " << pvIdx << ": maximum difference " << maxDiff[pvIdx]
+                  << " (relative: " << relDiff << ")\n";
+        ok = ok && relDiff < 1e-5;
+    }
+
+    if (numMeaningMismatches > 0)
+        std::cout << numMeaningMismatches << " cells use different primary variables\n";
+    std::cout << (ok ? "The sequential and the fully implicit solutions agree\n"
+                     : "The sequential and the fully implicit solutions differ!\n");
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}